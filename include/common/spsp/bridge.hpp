@@ -9,24 +9,37 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
 #include <mutex>
+#include <string_view>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
+#include "spsp/executor.hpp"
+#include "spsp/flat_wildcard_trie.hpp"
+#include "spsp/frozen_wildcard_trie.hpp"
 #include "spsp/local_addr_mac.hpp"
 #include "spsp/logger.hpp"
 #include "spsp/node.hpp"
 #include "spsp/timer.hpp"
-#include "spsp/wildcard_trie.hpp"
 
 // Log tag
 #define SPSP_LOG_TAG "SPSP/Bridge"
 
 namespace SPSP::Nodes
 {
-    //! Subscribe lifetime for no expiration
-    static constexpr auto BRIDGE_SUB_NO_EXPIRE = std::chrono::milliseconds::max();
+    //! Subscribe deadline for no expiration
+    static constexpr auto BRIDGE_SUB_NO_EXPIRE = std::chrono::steady_clock::time_point::max();
+
+    //! Maximum number of unused topics unsubscribed from far layer at once
+    static constexpr size_t BRIDGE_UNSUB_BATCH = 32;
 
     /**
      * @brief Bridge configuration
@@ -47,8 +60,8 @@ namespace SPSP::Nodes
         struct SubDB
         {
             /**
-             * How often to decrement subscription lifetimes, remove expired
-             * entries and unsubscribe from unnecessary topics.
+             * How often to remove expired entries and unsubscribe from
+             * unnecessary topics (granularity of expiration).
              * Should be at least 5× less than `subLifetime`.
              *
              * It's usually not necessary to change this.
@@ -62,10 +75,77 @@ namespace SPSP::Nodes
              * It's usually not necessary to change this.
              */
             std::chrono::milliseconds subLifetime = std::chrono::minutes(15);
+
+            /**
+             * Number of independently locked shards of subscribe database.
+             * Topics are assigned to shards by hash of their first level,
+             * so changes in different topic families don't contend.
+             * Topics with wildcard first level are in extra shard.
+             */
+            size_t shards = 4;
+
+            /**
+             * Maximum number of subscriptions of single client
+             * (0 = unlimited). Further SUB_REQs to new topics are rejected.
+             */
+            size_t maxSubsPerClient = 0;
+
+            /**
+             * Renew all subscriptions of client on any message from it,
+             * not only on SUB_REQ to the particular topic.
+             */
+            bool renewOnActivity = false;
+
+            /**
+             * Drop all subscriptions of client when it sends PROBE_REQ
+             * (client probes after (re)start, so they are stale).
+             */
+            bool dropOnProbe = false;
+        };
+
+        /**
+         * Bridge-owned executor, used only when no executor is given
+         * to the bridge
+         */
+        struct Dispatch
+        {
+            size_t workers = 2;      //!< Number of threads delivering far messages to subscribers
+            size_t queueSize = 64;   //!< Maximum number of far messages waiting for worker
+
+            /**
+             * What to do with far message when queue is full.
+             * With `BLOCK`, subscriber callbacks must not wait for delivery
+             * of another far message.
+             */
+            OverflowPolicy overflow = OverflowPolicy::BLOCK;
         };
 
         Reporting reporting;
         SubDB subDB;
+        Dispatch dispatch;
+    };
+
+    /**
+     * @brief Bridge dispatch statistics
+     *
+     */
+    struct BridgeDispatchStats
+    {
+        WorkerPoolStats queue;                    //!< Statistics of executor queue
+        uint64_t deliveries = 0;                  //!< Number of deliveries to subscribers
+        std::chrono::microseconds latencyAvg{0};  //!< Average queueing delay in executor
+        std::chrono::microseconds latencyMax{0};  //!< Maximum queueing delay in executor
+    };
+
+    /**
+     * @brief Bridge subscribe database statistics
+     *
+     */
+    struct BridgeSubDBStats
+    {
+        size_t topics = 0;              //!< Number of topics (in all shards)
+        size_t expiries = 0;            //!< Number of scheduled expirations (in all shards)
+        uint64_t snapshotRebuilds = 0;  //!< Number of rebuilds of matching snapshots
     };
 
     /**
@@ -84,6 +164,17 @@ namespace SPSP::Nodes
     public:
         using LocalAddrT = typename TLocalLayer::LocalAddrT;
         using LocalMessageT = typename TLocalLayer::LocalMessageT;
+        using LocalMessageViewT = LocalMessageView<LocalAddrT>;
+
+        /**
+         * @brief Statistics of client
+         *
+         */
+        struct ClientStats
+        {
+            size_t subscriptions = 0;  //!< Number of subscriptions
+            size_t rejectedSubs = 0;   //!< Number of SUB_REQs rejected by quota
+        };
 
     protected:
         /**
@@ -95,16 +186,158 @@ namespace SPSP::Nodes
          */
         struct SubDBEntry
         {
-            std::chrono::milliseconds lifetime;  //!< Lifetime
-            SPSP::SubscribeCb cb = nullptr;      //!< Callback for incoming data
+            std::chrono::steady_clock::time_point deadline;   //!< Expiration deadline
+            SPSP::SubscribeCb cb = nullptr;                   //!< Callback for incoming data
+            std::chrono::steady_clock::time_point scheduled;  //!< Deadline of its expiration in timing wheel
         };
 
         using SubDBMapT = std::unordered_map<LocalAddrT, SubDBEntry>;
 
-        std::mutex m_mutex;               //!< Mutex to prevent race conditions
-        BridgeConfig m_conf;              //!< Configuration
-        WildcardTrie<SubDBMapT> m_subDB;  //!< Subscribe database
-        Timer m_subDBTimer;               //!< Sub DB timer
+        /**
+         * @brief Scheduled expiration of sub DB entry
+         *
+         * Each entry has single one. Renewal only extends deadline
+         * of the entry, the expiration is rescheduled when reached.
+         * Stale if the entry was removed meanwhile (its scheduled
+         * deadline differs).
+         */
+        struct SubExpiry
+        {
+            std::string topic;                               //!< Topic
+            LocalAddrT addr;                                 //!< Address
+            std::chrono::steady_clock::time_point deadline;  //!< Expiration deadline
+        };
+
+        using SubExpiryWheelT = std::vector<std::vector<SubExpiry>>;
+
+        /**
+         * @brief Subscriber in sub DB snapshot
+         *
+         */
+        struct SubSnapshotEntry
+        {
+            LocalAddrT addr;                  //!< Address (empty for this node)
+            SPSP::SubscribeCb cb = nullptr;   //!< Callback for incoming data
+        };
+
+        using SubSnapshotEntriesT = std::vector<SubSnapshotEntry>;
+
+        /**
+         * @brief Topic in sub DB snapshot
+         *
+         * Subscribers of the topic can be replaced (atomically) without
+         * rebuilding whole snapshot.
+         */
+        struct SubSnapshotTopic
+        {
+            std::shared_ptr<const SubSnapshotEntriesT> entries;  //!< Subscribers (atomic access only)
+        };
+
+        using SubSnapshotT = FrozenWildcardTrie<std::shared_ptr<SubSnapshotTopic>>;
+
+        /**
+         * @brief Far layer operation in flight
+         *
+         */
+        enum class FarOp
+        {
+            SUBSCRIBE,    //!< Subscribing
+            UNSUBSCRIBE,  //!< Unsubscribing
+        };
+
+        /**
+         * @brief Batch of far layer operations
+         *
+         * Results are processed at once, when the last operation completes.
+         */
+        struct FarBatch
+        {
+            std::vector<std::string> topics;  //!< Topics
+            std::vector<char> results;        //!< Results (not `bool`, elements are written concurrently)
+            std::atomic<size_t> remaining;    //!< Number of operations in flight
+        };
+
+        /**
+         * @brief Shard of subscribe database
+         *
+         * Writers lock `mutex`, readers use `snapshot` without locking.
+         * Writers update subscribers of existing topics in place. When
+         * set of topics changes, they rebuild `snapshot` after releasing
+         * `mutex`.
+         */
+        struct SubDBShard
+        {
+            std::mutex mutex;                   //!< Mutex to prevent race conditions (writers only)
+            FlatWildcardTrie<SubDBMapT> subDB;  //!< Subscribe database
+
+            /**
+             * Immutable snapshot of `subDB` for lock-free matching
+             * (atomic access only)
+             */
+            std::shared_ptr<const SubSnapshotT> snapshot = std::make_shared<const SubSnapshotT>();
+            std::unordered_map<std::string, std::shared_ptr<SubSnapshotTopic>> snapshotTopics;  //!< Topics of `subDB` (`snapshot` after rebuild)
+            std::atomic<bool> snapshotStale = false;        //!< Whether `snapshotTopics` changed since `snapshot` was built
+            std::mutex snapshotRebuildMutex;                //!< Mutex of `snapshot` rebuild (locked before `mutex`)
+            std::unordered_set<std::string> dirtyTopics;    //!< Topics with changed subscribers since last publish
+
+            /**
+             * Timing wheel of expirations (slot per tick, `expirySlot` is
+             * processed in next tick)
+             */
+            SubExpiryWheelT expiryWheel;
+            size_t expirySlot = 0;                          //!< Slot of next tick
+
+            std::unordered_set<std::string> unusedTopics;      //!< Topics without subscribers (to be unsubscribed)
+            std::unordered_set<std::string> unsubRetryTopics;  //!< Unused topics whose far unsubscribe failed
+            std::unordered_set<std::string> subRetryTopics;    //!< Topics whose far resubscribe failed
+
+            /**
+             * Topics with far layer operation in flight (never removed
+             * from `subDB` until it completes)
+             */
+            std::unordered_map<std::string, FarOp> farPending;
+
+            /**
+             * Local subscribes waiting for far layer subscribe in flight
+             * (called with its result without holding the lock)
+             */
+            std::unordered_map<std::string, std::vector<FarLayerDoneCb>> farWaiters;
+        };
+
+        using SubDBShardsT = std::vector<std::unique_ptr<SubDBShard>>;
+
+        BridgeConfig m_conf;                     //!< Configuration
+        SubDBShardsT m_subDBShards;              //!< Sub DB shards (last one for wildcard first level)
+
+        /**
+         * @brief Reverse index entry of client
+         *
+         */
+        struct ClientEntry
+        {
+            std::unordered_set<std::string> topics;  //!< Subscribed topics
+            size_t rejectedSubs = 0;                 //!< Number of SUB_REQs rejected by quota
+        };
+
+        std::mutex m_clientsMutex;               //!< Mutex of `m_clients` (locked after shard mutex)
+        std::unordered_map<LocalAddrT, ClientEntry> m_clients;  //!< Reverse index of sub DB (without this node)
+        TaskGroup m_farOps;                      //!< Far layer operations in flight (waited for after timer stops)
+        Timer m_subDBTimer;                      //!< Sub DB timer
+
+        /**
+         * @brief Far message waiting for delivery to its subscribers
+         *
+         */
+        struct DispatchTask
+        {
+            std::string topic;                                                //!< Topic
+            std::string payload;                                              //!< Payload (data)
+            std::vector<std::shared_ptr<const SubSnapshotEntriesT>> entries;  //!< Matched subscribers
+        };
+
+        std::atomic<uint64_t> m_dispatchDeliveries = 0;          //!< Deliveries counter
+        std::atomic<uint64_t> m_snapshotRebuilds = 0;            //!< Snapshot rebuilds counter
+        std::unique_ptr<ThreadPoolExecutor> m_dispatchExecutor;  //!< Bridge-owned executor (if none given)
 
     public:
         /**
@@ -113,14 +346,29 @@ namespace SPSP::Nodes
          * @param ll Local layer
          * @param fl Far layer
          * @param conf Configuration
+         * @param executor Executor of asynchronous tasks
+         *                 (`nullptr` for bridge-owned one, see `BridgeConfig::Dispatch`)
          */
-        Bridge(TLocalLayer* ll, TFarLayer* fl, BridgeConfig conf = {})
+        Bridge(TLocalLayer* ll, TFarLayer* fl, BridgeConfig conf = {},
+               IExecutor* executor = nullptr)
             : ILocalAndFarNode<TLocalLayer, TFarLayer>{ll, fl},
               m_conf{conf},
+              m_subDBShards{makeSubDBShards(conf.subDB)},
               m_subDBTimer{conf.subDB.interval,
                            std::bind(&Bridge<TLocalLayer, TFarLayer>::subDBTick,
                            this)}
         {
+            if (executor == nullptr) {
+                ThreadPoolExecutorConfig executorConf;
+                executorConf.workers = conf.dispatch.workers;
+                executorConf.queueSize = conf.dispatch.queueSize;
+                executorConf.overflow = conf.dispatch.overflow;
+
+                m_dispatchExecutor = std::make_unique<ThreadPoolExecutor>(executorConf);
+                executor = m_dispatchExecutor.get();
+            }
+            this->setExecutor(executor);
+
             SPSP_LOGI("Initialized");
         }
 
@@ -130,6 +378,8 @@ namespace SPSP::Nodes
          */
         ~Bridge()
         {
+            this->waitForTasks();
+
             SPSP_LOGI("Deinitialized");
         }
 
@@ -138,6 +388,10 @@ namespace SPSP::Nodes
          *
          * Acts as a callback for far layer receiver.
          *
+         * Doesn't lock, matches against current snapshots of shard of
+         * the topic and of the wildcard shard. Matched subscribers are
+         * delivered to as single task by executor.
+         *
          * @param topic Topic
          * @param payload Payload (data)
          * @return true Message delivery successful
@@ -145,34 +399,111 @@ namespace SPSP::Nodes
          */
         bool receiveFar(const std::string& topic, const std::string& payload)
         {
-            const std::scoped_lock lock(m_mutex);
-
             SPSP_LOGD("Received far msg: topic '%s', payload '%s'",
                       topic.c_str(), payload.c_str());
 
-            // Get matching entries
-            auto entries = m_subDB.find(topic);
+            DispatchTask task;
+
+            for (auto shard : { &this->subDBShard(topic), m_subDBShards.back().get() }) {
+                auto snapshot = std::atomic_load(&shard->snapshot);
 
-            for (auto& [entryTopic, entryMap] : entries) {
-                for (auto& [addr, entry] : entryMap) {
+                // Collect matching entries
+                snapshot->findEach(topic, [&task] (const auto& match) {
+                    auto entries = std::atomic_load(&match.value->entries);
+                    if (!entries->empty()) {
+                        task.entries.push_back(std::move(entries));
+                    }
+                });
+            }
+
+            if (task.entries.empty()) {
+                return true;
+            }
+
+            // Whole fan-out is single task
+            task.topic = topic;
+            task.payload = payload;
+
+            if (!this->execute([this, task = std::move(task)] { this->dispatch(task); })) {
+                SPSP_LOGW("Dispatch queue full, far msg to topic '%s' dropped",
+                          topic.c_str());
+                return false;
+            }
+
+            return true;
+        }
+
+        /**
+         * @brief Gets statistics of delivery of far messages
+         *
+         * @return Statistics (of executor, shared if it was given to bridge)
+         */
+        BridgeDispatchStats getDispatchStats()
+        {
+            auto executorStats = this->getExecutor().getStats();
+
+            BridgeDispatchStats stats;
+            stats.queue = executorStats.queue;
+            stats.deliveries = m_dispatchDeliveries;
+            stats.latencyAvg = executorStats.latencyAvg;
+            stats.latencyMax = executorStats.latencyMax;
+
+            return stats;
+        }
+
+        /**
+         * @brief Gets statistics of subscribe database
+         *
+         * @return Statistics
+         */
+        BridgeSubDBStats getSubDBStats()
+        {
+            BridgeSubDBStats stats;
+            stats.snapshotRebuilds = m_snapshotRebuilds;
+
+            for (auto& shard : m_subDBShards) {
+                const std::scoped_lock lock(shard->mutex);
+                stats.topics += shard->snapshotTopics.size();
+
+                for (auto& slot : shard->expiryWheel) {
+                    stats.expiries += slot.size();
+                }
+            }
+
+            return stats;
+        }
+
+    protected:
+        /**
+         * @brief Delivers far message to its subscribers
+         *
+         * Runs in executor.
+         *
+         * @param task Dispatch task
+         */
+        void dispatch(const DispatchTask& task)
+        {
+            for (auto& entries : task.entries) {
+                for (auto& [addr, cb] : *entries) {
                     if (addr == LocalAddrT{}) {
                         // This node's subscription - call callback
-                        SPSP_LOGD("Calling user callback for topic '%s' in new thread",
-                                  topic.c_str());
-                        std::thread t(entry.cb, topic, payload);
-                        t.detach();
+                        SPSP_LOGD("Calling user callback for topic '%s'",
+                                  task.topic.c_str());
+                        if (cb != nullptr) {
+                            cb(task.topic, task.payload);
+                        }
                     } else {
                         // Local layer subscription
-                        std::thread t(&Bridge<TLocalLayer, TFarLayer>::publishSubData,
-                                      this, addr, topic, payload);
-                        t.detach();
+                        this->publishSubData(addr, task.topic, task.payload);
                     }
+
+                    m_dispatchDeliveries++;
                 }
             }
-
-            return true;
         }
 
+    public:
+
         /**
          * @brief Publishes payload to topic
          *
@@ -204,6 +535,10 @@ namespace SPSP::Nodes
          * This is primary endpoint for subscribing locally on this node.
          * Directly forwards incoming data from far layer to given callback.
          *
+         * Waits for far layer to subscribe to new topic (without holding
+         * the lock). If subscribe of the topic is already in flight,
+         * waits for its result.
+         *
          * @param topic Topic
          * @param cb Callback function
          * @return true Subscribe successful
@@ -211,8 +546,6 @@ namespace SPSP::Nodes
          */
         bool subscribe(const std::string& topic, SubscribeCb cb)
         {
-            const std::scoped_lock lock(m_mutex);
-
             SPSP_LOGD("Subscribing locally to topic '%s'", topic.c_str());
 
             if (topic.empty()) {
@@ -220,39 +553,100 @@ namespace SPSP::Nodes
                 return false;
             }
 
-            auto& entryMap = m_subDB[topic];
+            auto& shard = this->subDBShard(topic);
+            bool newTopic;
+            bool waiting;
 
-            // Attempt to subscribe to new topic
-            if (entryMap.empty()) {
-                if (!this->getFarLayer()->subscribe(topic)) {
-                    return false;
+            auto promise = std::make_shared<std::promise<bool>>();
+            auto future = promise->get_future();
+
+            {
+                const std::scoped_lock lock(shard.mutex);
+
+                // Snapshot has the same topics
+                newTopic = !shard.snapshotTopics.count(topic);
+                if (newTopic) {
+                    shard.farPending[topic] = FarOp::SUBSCRIBE;
                 }
+
+                // Subscribers are dropped if subscribe in flight fails
+                auto pendingIt = shard.farPending.find(topic);
+                waiting = pendingIt != shard.farPending.end() &&
+                          pendingIt->second == FarOp::SUBSCRIBE;
+                if (waiting) {
+                    shard.farWaiters[topic].push_back([promise](bool success) {
+                        promise->set_value(success);
+                    });
+                }
+
+                shard.subDB[topic][LocalAddrT{}] = SubDBEntry{
+                    .deadline = BRIDGE_SUB_NO_EXPIRE,
+                    .cb = cb,
+                    .scheduled = {}  // Not scheduled, never expires
+                };
+
+                shard.dirtyTopics.insert(topic);
+                this->subSnapshotPublish(shard);
             }
 
-            entryMap[LocalAddrT{}] = SubDBEntry{
-                .lifetime = BRIDGE_SUB_NO_EXPIRE,
-                .cb = cb
-            };
+            this->subSnapshotRebuild(shard);
 
-            return true;
+            // Subscribe to new topic (outside the lock)
+            if (newTopic) {
+                this->farSubscribe(shard, topic);
+            }
+
+            if (!waiting) {
+                return true;
+            }
+
+            return future.get();
         }
 
         /**
          * @brief Resubscribes to all topics
          *
+         * Topics of all shards are subscribed in single batch.
+         * Only topics with subscribers and without far layer operation
+         * in flight are resubscribed (they are marked as pending).
          */
         void resubscribeAll()
         {
-            const std::scoped_lock lock(m_mutex);
+            using ShardsTopicsT = std::vector<std::pair<SubDBShard*, std::vector<std::string>>>;
 
-            m_subDB.forEach(
-                [this](const std::string& topic, const SubDBMapT& topicEntries) {
-                    if (!this->getFarLayer()->subscribe(topic)) {
-                        SPSP_LOGW("Resubscribe to topic %s failed",
-                                  topic.c_str());
+            auto shardsTopics = std::make_shared<ShardsTopicsT>();
+            std::vector<std::string> topics;
+
+            for (auto& shard : m_subDBShards) {
+                std::vector<std::string> shardTopics;
+
+                {
+                    const std::scoped_lock lock(shard->mutex);
+
+                    shard->subDB.forEach(
+                        [&shard, &shardTopics](const std::string& topic, const SubDBMapT& topicEntries) {
+                            if (!topicEntries.empty() && !shard->farPending.count(topic)) {
+                                shardTopics.push_back(topic);
+                            }
+                        }
+                    );
+
+                    for (auto& topic : shardTopics) {
+                        shard->farPending[topic] = FarOp::SUBSCRIBE;
                     }
                 }
-            );
+
+                topics.insert(topics.end(), shardTopics.begin(), shardTopics.end());
+                shardsTopics->emplace_back(shard.get(), std::move(shardTopics));
+            }
+
+            // Far layer is called outside the lock
+            this->getFarLayer()->subscribeManyAsync(topics,
+                [this, shardsTopics, guard = m_farOps.track()](bool success) {
+                    for (auto& [shard, shardTopics] : *shardsTopics) {
+                        this->farResubscribeDone(*shard, shardTopics, success);
+                    }
+                });
         }
 
         /**
@@ -273,22 +667,89 @@ namespace SPSP::Nodes
                 return false;
             }
 
+            auto& shard = this->subDBShard(topic);
+
             {
-                const std::scoped_lock lock(m_mutex);
-                if (!m_subDB[topic].erase(LocalAddrT{})) {
+                const std::scoped_lock lock(shard.mutex);
+
+                // Don't create missing topic (snapshot has the same topics)
+                if (!shard.snapshotTopics.count(topic) ||
+                    !this->subDBErase(shard, topic, LocalAddrT{})) {
                     // Entry doesn't exist
                     SPSP_LOGD("Can't unsubscribe from not-subscribed topic '%s'",
                               topic.c_str());
                     return false;
                 }
+
+                this->subSnapshotPublish(shard);
             }
 
-            // Remove unused topics
-            this->subDBRemoveUnusedTopics();
+            // Unsubscribe from far layer if unused (outside the lock)
+            this->subDBRemoveUnusedTopics(shard);
 
             return true;
         }
 
+        /**
+         * @brief Drops all subscriptions of client
+         *
+         * Useful when client is known to be dead.
+         * Takes time proportional to number of client's subscriptions.
+         *
+         * @param addr Client address
+         * @return true Client dropped
+         * @return false Client has no subscriptions
+         */
+        bool dropClient(const LocalAddrT& addr)
+        {
+            auto topics = this->clientTopicsByShard(addr, true);
+            if (topics.empty()) {
+                return false;
+            }
+
+            for (auto& [shard, shardTopics] : topics) {
+                {
+                    const std::scoped_lock lock(shard->mutex);
+
+                    for (auto& topic : shardTopics) {
+                        // Don't create missing topic (snapshot has the same topics)
+                        if (shard->snapshotTopics.count(topic)) {
+                            this->subDBErase(*shard, topic, addr);
+                        }
+                    }
+
+                    this->subSnapshotPublish(*shard);
+                }
+
+                // Unsubscribe from far layer if unused (outside the lock)
+                this->subDBRemoveUnusedTopics(*shard);
+            }
+
+            SPSP_LOGD("Dropped client %s", addr.str.c_str());
+            return true;
+        }
+
+        /**
+         * @brief Gets statistics of client
+         *
+         * @param addr Client address
+         * @return Client statistics
+         */
+        ClientStats clientStats(const LocalAddrT& addr)
+        {
+            const std::scoped_lock lock(m_clientsMutex);
+
+            auto it = m_clients.find(addr);
+            if (it == m_clients.end()) {
+                return {};
+            }
+
+            return ClientStats{
+                .subscriptions = it->second.topics.size(),
+                .rejectedSubs = it->second.rejectedSubs,
+            };
+        }
+
     protected:
         /**
          * @brief Processes PROBE_REQ message
@@ -298,13 +759,19 @@ namespace SPSP::Nodes
          * @return true Message delivery successful
          * @return false Message delivery failed
          */
-        bool processProbeReq(const LocalMessageT& req,
+        bool processProbeReq(const LocalMessageViewT& req,
                              int rssi = NODE_RSSI_UNKNOWN)
         {
-            LocalMessageT res = req;
+            LocalMessageT res = req.toMessage();
             res.type = LocalMessageType::PROBE_RES;
             res.payload = "";
 
+            if (m_conf.subDB.dropOnProbe) {
+                this->dropClient(req.addr);
+            } else {
+                this->clientActivity(req.addr);
+            }
+
             // Publish RSSI
             if (m_conf.reporting.rssiOnProbe) {
                 this->publishRssi(req.addr, rssi);
@@ -317,7 +784,7 @@ namespace SPSP::Nodes
                     NODE_REPORTING_PROBE_PAYLOAD_SUBTOPIC + "/" +
                     req.addr.str;
 
-                this->publish(probePayloadReportTopic, req.payload);
+                this->publish(probePayloadReportTopic, std::string{req.payload});
             }
 
             return this->sendLocal(res);
@@ -333,7 +800,7 @@ namespace SPSP::Nodes
          * @return true Message delivery successful
          * @return false Message delivery failed
          */
-        bool processProbeRes(const LocalMessageT& req,
+        bool processProbeRes(const LocalMessageViewT& req,
                              int rssi = NODE_RSSI_UNKNOWN) { return false; }
 
         /**
@@ -344,9 +811,11 @@ namespace SPSP::Nodes
          * @return true Message delivery successful
          * @return false Message delivery failed
          */
-        bool processPub(const LocalMessageT& req,
+        bool processPub(const LocalMessageViewT& req,
                         int rssi = NODE_RSSI_UNKNOWN)
         {
+            this->clientActivity(req.addr);
+
             // Publish RSSI
             if (m_conf.reporting.rssiOnPub) {
                 this->publishRssi(req.addr, rssi);
@@ -357,8 +826,9 @@ namespace SPSP::Nodes
                 return false;
             }
 
-            return this->getFarLayer()->publish(req.addr.str, req.topic,
-                                                req.payload);
+            return this->getFarLayer()->publish(req.addr.str,
+                                                std::string{req.topic},
+                                                std::string{req.payload});
         }
 
         /**
@@ -369,9 +839,11 @@ namespace SPSP::Nodes
          * @return true Message delivery successful
          * @return false Message delivery failed
          */
-        bool processSubReq(const LocalMessageT& req,
+        bool processSubReq(const LocalMessageViewT& req,
                            int rssi = NODE_RSSI_UNKNOWN)
         {
+            this->clientActivity(req.addr);
+
             // Publish RSSI
             if (m_conf.reporting.rssiOnSub) {
                 this->publishRssi(req.addr, rssi);
@@ -382,22 +854,54 @@ namespace SPSP::Nodes
                 return false;
             }
 
+            const std::string topic{req.topic};
+            auto& shard = this->subDBShard(topic);
+            bool newTopic;
+
             {
-                const std::scoped_lock lock(m_mutex);
+                const std::scoped_lock lock(shard.mutex);
+
+                // Snapshot has the same topics
+                newTopic = !shard.snapshotTopics.count(topic);
+                auto& entryMap = shard.subDB[topic];
+
+                // Check quota of client
+                bool newEntry = !entryMap.count(req.addr);
+                if (newEntry && !this->clientAddTopic(req.addr, topic)) {
+                    SPSP_LOGW("Client %s exceeded subscription quota, SUB_REQ to '%s' rejected",
+                              req.addr.str.c_str(), topic.c_str());
+                    if (newTopic) {
+                        this->subDBRemoveTopic(shard, topic);
+                    }
+                    return false;
+                }
 
-                auto& entryMap = m_subDB[req.topic];
+                // New topic is pending until far layer completes
+                if (newTopic) {
+                    shard.farPending[topic] = FarOp::SUBSCRIBE;
+                }
 
-                // Attempt to subscribe to new topic
-                if (entryMap.empty()) {
-                    if (!this->getFarLayer()->subscribe(req.topic)) {
-                        return false;
-                    }
+                auto now = std::chrono::steady_clock::now();
+                auto deadline = now + m_conf.subDB.subLifetime;
+                auto [entryIt, inserted] = entryMap.try_emplace(req.addr);
+                entryIt->second.deadline = deadline;
+
+                // Renewal (only deadline changed) doesn't change the snapshot
+                // nor the timing wheel
+                if (inserted) {
+                    entryIt->second.scheduled = deadline;
+                    this->subDBScheduleExpiry(shard, SubExpiry{ topic, req.addr, deadline }, now);
+
+                    shard.dirtyTopics.insert(topic);
+                    this->subSnapshotPublish(shard);
                 }
+            }
 
-                entryMap[req.addr] = SubDBEntry{
-                    .lifetime = m_conf.subDB.subLifetime,
-                    .cb = nullptr
-                };
+            this->subSnapshotRebuild(shard);
+
+            // Subscribe to new topic (outside the lock, without waiting)
+            if (newTopic) {
+                this->farSubscribe(shard, topic);
             }
 
             return true;
@@ -413,7 +917,7 @@ namespace SPSP::Nodes
          * @return true Message delivery successful
          * @return false Message delivery failed
          */
-        bool processSubData(const LocalMessageT& req,
+        bool processSubData(const LocalMessageViewT& req,
                             int rssi = NODE_RSSI_UNKNOWN) { return false; }
 
         /**
@@ -424,9 +928,11 @@ namespace SPSP::Nodes
          * @return true Message delivery successful
          * @return false Message delivery failed
          */
-        bool processUnsub(const LocalMessageT& req,
+        bool processUnsub(const LocalMessageViewT& req,
                           int rssi = NODE_RSSI_UNKNOWN)
         {
+            this->clientActivity(req.addr);
+
             // Publish RSSI
             if (m_conf.reporting.rssiOnUnsub) {
                 this->publishRssi(req.addr, rssi);
@@ -437,13 +943,21 @@ namespace SPSP::Nodes
                 return false;
             }
 
+            const std::string topic{req.topic};
+            auto& shard = this->subDBShard(topic);
+
             {
-                const std::scoped_lock lock(m_mutex);
-                m_subDB[req.topic].erase(req.addr);
+                const std::scoped_lock lock(shard.mutex);
+
+                // Don't create missing topic (snapshot has the same topics)
+                if (shard.snapshotTopics.count(topic) &&
+                    this->subDBErase(shard, topic, req.addr)) {
+                    this->subSnapshotPublish(shard);
+                }
             }
 
-            // Remove unused topics
-            this->subDBRemoveUnusedTopics();
+            // Unsubscribe from far layer if unused (outside the lock)
+            this->subDBRemoveUnusedTopics(shard);
 
             return true;
         }
@@ -458,15 +972,17 @@ namespace SPSP::Nodes
          * @return true Message delivery successful
          * @return false Message delivery failed
          */
-        bool processTimeReq(const LocalMessageT& req,
+        bool processTimeReq(const LocalMessageViewT& req,
                             int rssi = NODE_RSSI_UNKNOWN)
         {
+            this->clientActivity(req.addr);
+
             // Get current time (millisecond accuracy)
             auto now = std::chrono::system_clock::now().time_since_epoch();
             auto nowMilliseconds =
                 std::chrono::duration_cast<std::chrono::milliseconds>(now);
 
-            LocalMessageT res = req;
+            LocalMessageT res = req.toMessage();
             res.type = LocalMessageType::TIME_RES;
             res.payload = std::to_string(nowMilliseconds.count());
 
@@ -483,7 +999,7 @@ namespace SPSP::Nodes
          * @return true Message delivery successful
          * @return false Message delivery failed
          */
-        bool processTimeRes(const LocalMessageT& req,
+        bool processTimeRes(const LocalMessageViewT& req,
                             int rssi = NODE_RSSI_UNKNOWN) { return false; }
 
         /**
@@ -513,98 +1029,693 @@ namespace SPSP::Nodes
         /**
          * @brief Subscribe DB timer tick callback
          *
-         * Decrements subscribe database lifetimes.
+         * Removes expired entries (only these are touched).
          * Unsubscribes from unused topics.
          */
         void subDBTick()
         {
             SPSP_LOGD("SubDB: Tick running");
 
-            this->subDBDecrementLifetimes();
-            this->subDBRemoveExpiredEntries();
-            this->subDBRemoveUnusedTopics();
+            for (auto& shard : m_subDBShards) {
+                this->subDBRemoveExpiredEntries(*shard);
+                this->subDBRemoveUnusedTopics(*shard, true);
+                this->subDBRetrySubscribe(*shard);
+            }
 
             SPSP_LOGD("SubDB: Tick done");
         }
 
         /**
-         * @brief Decrements lifetimes of entries
+         * @brief Schedules expiration of entry to timing wheel
+         *
+         * Entry expires in first tick after its deadline.
+         * Must be called with locked mutex of the shard.
+         *
+         * @param shard Sub DB shard
+         * @param expiry Expiration
+         * @param now Current time
+         */
+        void subDBScheduleExpiry(SubDBShard& shard, SubExpiry expiry,
+                                 std::chrono::steady_clock::time_point now)
+        {
+            auto& wheel = shard.expiryWheel;
+            auto interval = std::max(m_conf.subDB.interval,
+                                     std::chrono::milliseconds(1));
+
+            // Next tick is slot `expirySlot` (offset 0), farther deadlines
+            // are rescheduled when reached
+            size_t offset = 0;
+            if (expiry.deadline > now) {
+                offset = (expiry.deadline - now + interval - std::chrono::nanoseconds(1))
+                         / interval - 1;
+                offset = std::min(offset, wheel.size() - 1);
+            }
+
+            wheel[(shard.expirySlot + offset) % wheel.size()].push_back(std::move(expiry));
+        }
+
+        /**
+         * @brief Removes expired entries
+         *
+         * Processes current slot of timing wheel.
          *
+         * @param shard Sub DB shard
          */
-        void subDBDecrementLifetimes()
+        void subDBRemoveExpiredEntries(SubDBShard& shard)
         {
-            const std::scoped_lock lock(m_mutex);
+            const std::scoped_lock lock(shard.mutex);
 
-            m_subDB.forEach([this] (const std::string& topic,
-                                    const SubDBMapT& entryMap) {
-                for (auto& [addr, entry] : entryMap) {
-                    // Don't decrement entries with infinite lifetime
-                    if (entry.lifetime != BRIDGE_SUB_NO_EXPIRE) {
-                        m_subDB[topic][addr].lifetime -= m_conf.subDB.interval;
+            auto now = std::chrono::steady_clock::now();
+
+            auto expiries = std::move(shard.expiryWheel[shard.expirySlot]);
+            shard.expiryWheel[shard.expirySlot].clear();
+            shard.expirySlot = (shard.expirySlot + 1) % shard.expiryWheel.size();
+
+            for (auto& expiry : expiries) {
+                // Don't create missing topic (snapshot has the same topics)
+                if (!shard.snapshotTopics.count(expiry.topic)) {
+                    continue;
+                }
+
+                auto& entryMap = shard.subDB[expiry.topic];
+                auto entryIt = entryMap.find(expiry.addr);
+                if (entryIt == entryMap.end() ||
+                    entryIt->second.scheduled != expiry.deadline) {
+                    // Stale (removed, possibly added again)
+                    continue;
+                }
+
+                auto& entry = entryIt->second;
+
+                if (entry.deadline <= now) {
+                    // Expired
+                    this->subDBErase(shard, expiry.topic, expiry.addr);
+                    SPSP_LOGD("SubDB: Removed addr %s from topic '%s'",
+                              expiry.addr.str.c_str(), expiry.topic.c_str());
+                } else {
+                    // Renewed meanwhile or tick came early
+                    expiry.deadline = entry.deadline;
+                    entry.scheduled = entry.deadline;
+                    this->subDBScheduleExpiry(shard, std::move(expiry), now);
+                }
+            }
+
+            this->subSnapshotPublish(shard);
+        }
+
+        /**
+         * @brief Removes entry from sub DB
+         *
+         * Marks topic as changed (and unused if it was the last entry)
+         * and updates reverse index.
+         * Must be called with locked mutex of the shard.
+         *
+         * @param shard Sub DB shard
+         * @param topic Topic (must exist in sub DB)
+         * @param addr Address
+         * @return true Entry removed
+         * @return false Entry doesn't exist
+         */
+        bool subDBErase(SubDBShard& shard, const std::string& topic,
+                        const LocalAddrT& addr)
+        {
+            auto& entryMap = shard.subDB[topic];
+
+            if (!entryMap.erase(addr)) {
+                return false;
+            }
+
+            this->clientRemoveTopic(addr, topic);
+
+            shard.dirtyTopics.insert(topic);
+            if (entryMap.empty()) {
+                shard.unusedTopics.insert(topic);
+            }
+
+            return true;
+        }
+
+        /**
+         * @brief Unsubscribes from unused topics
+         *
+         * Topics are taken from `unusedTopics` in batches and marked
+         * as pending. Far layer is called without holding the lock and
+         * without waiting, topics are removed when whole batch completes.
+         * Topics with far layer operation in flight are handled when
+         * it completes.
+         *
+         * @param shard Sub DB shard
+         * @param retry Whether to retry topics whose unsubscribe failed before
+         */
+        void subDBRemoveUnusedTopics(SubDBShard& shard, bool retry = false)
+        {
+            if (retry) {
+                const std::scoped_lock lock(shard.mutex);
+                shard.unusedTopics.merge(shard.unsubRetryTopics);
+            }
+
+            while (true) {
+                auto batch = std::make_shared<FarBatch>();
+
+                // Take batch of topics which are still unused
+                {
+                    const std::scoped_lock lock(shard.mutex);
+
+                    auto it = shard.unusedTopics.begin();
+                    while (it != shard.unusedTopics.end() &&
+                           batch->topics.size() < BRIDGE_UNSUB_BATCH) {
+                        auto topic = std::move(shard.unusedTopics.extract(it++).value());
+
+                        // Don't create missing topic (snapshot has the same topics)
+                        if (shard.snapshotTopics.count(topic) &&
+                            !shard.farPending.count(topic) &&
+                            shard.subDB[topic].empty()) {
+                            shard.farPending[topic] = FarOp::UNSUBSCRIBE;
+                            batch->topics.push_back(std::move(topic));
+                        }
                     }
                 }
-            });
+
+                if (batch->topics.empty()) {
+                    break;
+                }
+
+                batch->results.resize(batch->topics.size());
+                batch->remaining = batch->topics.size();
+
+                // Unsubscribe from them (may complete before returning)
+                for (size_t i = 0; i < batch->topics.size(); i++) {
+                    this->getFarLayer()->unsubscribeAsync(batch->topics[i],
+                        [this, &shard, batch, i, guard = m_farOps.track()](bool success) {
+                            batch->results[i] = success;
+                            if (--batch->remaining == 0) {
+                                this->farUnsubscribeDone(shard, *batch);
+                            }
+                        });
+                }
+            }
         }
 
         /**
-         * @brief Removes expired entries
+         * @brief Subscribes to topic in far layer without waiting
+         *
+         * Topic must be marked as pending subscribe. Must be called
+         * without holding the lock.
+         *
+         * @param shard Sub DB shard
+         * @param topic Topic
+         */
+        void farSubscribe(SubDBShard& shard, const std::string& topic)
+        {
+            this->getFarLayer()->subscribeAsync(topic,
+                [this, &shard, topic, guard = m_farOps.track()](bool success) {
+                    this->farSubscribeDone(shard, topic, success);
+                });
+        }
+
+        /**
+         * @brief Processes completion of far layer subscribe
+         *
+         * On failure, topic is removed with all its subscribers
+         * (clients subscribe again with renewal, local subscribes
+         * waiting for it fail).
+         * Topic unsubscribed in the meantime becomes unused.
+         *
+         * @param shard Sub DB shard
+         * @param topic Topic
+         * @param success Whether subscribe was successful
+         */
+        void farSubscribeDone(SubDBShard& shard, const std::string& topic,
+                              bool success)
+        {
+            std::vector<FarLayerDoneCb> waiters;
+            bool unused = false;
+
+            {
+                const std::scoped_lock lock(shard.mutex);
+
+                // Pending topic is still in sub DB
+                shard.farPending.erase(topic);
+                waiters = subDBTakeWaiters(shard, topic);
+                auto& entryMap = shard.subDB[topic];
+
+                if (!success) {
+                    SPSP_LOGW("SubDB: Subscribe to topic '%s' failed, %zu subscribers dropped",
+                              topic.c_str(), entryMap.size());
+
+                    for (auto& [addr, entry] : entryMap) {
+                        this->clientRemoveTopic(addr, topic);
+                    }
+
+                    this->subDBRemoveTopic(shard, topic);
+                    this->subSnapshotPublish(shard);
+                } else if (entryMap.empty()) {
+                    // Unsubscribed meanwhile
+                    shard.unusedTopics.insert(topic);
+                    unused = true;
+                }
+            }
+
+            this->subSnapshotRebuild(shard);
+
+            for (auto& waiter : waiters) {
+                waiter(success);
+            }
+
+            if (unused) {
+                this->subDBRemoveUnusedTopics(shard);
+            }
+        }
+
+        /**
+         * @brief Processes completion of far layer resubscribe
+         *
+         * On failure, topics are subscribed again (one by one) in next tick.
+         * Their subscribers are kept, so local subscribes waiting for it
+         * succeed.
+         * Topics unsubscribed in the meantime become unused.
          *
+         * @param shard Sub DB shard
+         * @param topics Resubscribed topics of the shard
+         * @param success Whether resubscribe was successful
          */
-        void subDBRemoveExpiredEntries()
+        void farResubscribeDone(SubDBShard& shard, const std::vector<std::string>& topics,
+                                bool success)
         {
-            using namespace std::chrono_literals;
+            if (!success && !topics.empty()) {
+                SPSP_LOGW("SubDB: Resubscribe to %zu topics failed. Will try again in next tick.",
+                          topics.size());
+            }
+
+            std::vector<FarLayerDoneCb> waiters;
 
-            const std::scoped_lock lock(m_mutex);
+            {
+                const std::scoped_lock lock(shard.mutex);
 
-            m_subDB.forEach([this] (const std::string& topic,
-                                    const SubDBMapT& entryMap) {
-                auto entryIt = entryMap.begin();
-                while (entryIt != entryMap.end()) {
-                    auto addr = entryIt->first;
+                for (auto& topic : topics) {
+                    // Pending topic is still in sub DB
+                    shard.farPending.erase(topic);
 
-                    if (entryIt->second.lifetime <= 0ms) {
-                        // Expired
-                        entryIt = m_subDB[topic].erase(entryIt);
-                        SPSP_LOGD("SubDB: Removed addr %s from topic '%s'",
-                                  addr.str.c_str(), topic.c_str());
+                    for (auto& waiter : subDBTakeWaiters(shard, topic)) {
+                        waiters.push_back(std::move(waiter));
+                    }
+
+                    if (shard.subDB[topic].empty()) {
+                        // Unsubscribed meanwhile
+                        shard.unusedTopics.insert(topic);
+                    } else if (!success) {
+                        shard.subRetryTopics.insert(topic);
+                    }
+                }
+            }
+
+            for (auto& waiter : waiters) {
+                waiter(true);
+            }
+
+            this->subDBRemoveUnusedTopics(shard);
+        }
+
+        /**
+         * @brief Takes local subscribes waiting for far layer subscribe
+         *
+         * Must be called with locked mutex of the shard.
+         *
+         * @param shard Sub DB shard
+         * @param topic Topic
+         * @return Waiting subscribes (to be called without holding the lock)
+         */
+        static std::vector<FarLayerDoneCb> subDBTakeWaiters(SubDBShard& shard,
+                                                            const std::string& topic)
+        {
+            auto it = shard.farWaiters.find(topic);
+            if (it == shard.farWaiters.end()) {
+                return {};
+            }
+
+            auto waiters = std::move(it->second);
+            shard.farWaiters.erase(it);
+            return waiters;
+        }
+
+        /**
+         * @brief Subscribes again to topics whose resubscribe failed
+         *
+         * Topics are subscribed one by one, so failure of one
+         * doesn't affect others.
+         *
+         * @param shard Sub DB shard
+         */
+        void subDBRetrySubscribe(SubDBShard& shard)
+        {
+            std::vector<std::string> topics;
+
+            {
+                const std::scoped_lock lock(shard.mutex);
+
+                for (auto& topic : shard.subRetryTopics) {
+                    // Don't create missing topic (snapshot has the same topics)
+                    if (shard.snapshotTopics.count(topic) &&
+                        !shard.farPending.count(topic) &&
+                        !shard.subDB[topic].empty()) {
+                        shard.farPending[topic] = FarOp::SUBSCRIBE;
+                        topics.push_back(topic);
+                    }
+                }
+
+                shard.subRetryTopics.clear();
+            }
+
+            for (auto& topic : topics) {
+                this->farSubscribe(shard, topic);
+            }
+        }
+
+        /**
+         * @brief Processes completion of batch of far layer unsubscribes
+         *
+         * Unsubscribed topics are removed. Topics subscribed again
+         * in the meantime are kept (and subscribed to far layer again).
+         *
+         * @param shard Sub DB shard
+         * @param batch Batch of unsubscribes
+         */
+        void farUnsubscribeDone(SubDBShard& shard, const FarBatch& batch)
+        {
+            std::vector<std::string> resubscribe;
+
+            {
+                const std::scoped_lock lock(shard.mutex);
+
+                for (size_t i = 0; i < batch.topics.size(); i++) {
+                    auto& topic = batch.topics[i];
+                    bool unsubscribed = batch.results[i];
+
+                    // Pending topic is still in sub DB
+                    shard.farPending.erase(topic);
+
+                    if (!shard.subDB[topic].empty()) {
+                        // Subscribed again meanwhile
+                        if (unsubscribed) {
+                            shard.farPending[topic] = FarOp::SUBSCRIBE;
+                            resubscribe.push_back(topic);
+                        }
+                    } else if (unsubscribed) {
+                        // Unsub successful, remove topic from sub DB
+                        this->subDBRemoveTopic(shard, topic);
+                        SPSP_LOGD("SubDB: Removed unused topic '%s'", topic.c_str());
                     } else {
-                        // Continue
-                        entryIt++;
+                        shard.unsubRetryTopics.insert(topic);
+                        SPSP_LOGW("SubDB: Topic '%s' can't be unsubscribed. Will try again in next tick.",
+                                  topic.c_str());
                     }
                 }
-            });
+
+                this->subSnapshotPublish(shard);
+            }
+
+            this->subSnapshotRebuild(shard);
+
+            for (auto& topic : resubscribe) {
+                this->farSubscribe(shard, topic);
+            }
+        }
+
+        /**
+         * @brief Makes snapshot of subscribers of topic
+         *
+         * @param entryMap Sub DB entries of topic
+         * @return Subscribers
+         */
+        static std::shared_ptr<const SubSnapshotEntriesT> subSnapshotEntries(
+            const SubDBMapT& entryMap)
+        {
+            auto entries = std::make_shared<SubSnapshotEntriesT>();
+            entries->reserve(entryMap.size());
+
+            for (auto& [addr, entry] : entryMap) {
+                entries->push_back(SubSnapshotEntry{ addr, entry.cb });
+            }
+
+            return entries;
+        }
+
+        /**
+         * @brief Publishes changes of sub DB to readers
+         *
+         * Writers batch their changes and call this once at the end.
+         * Subscribers of changed topics are replaced in place. New topics
+         * mark the snapshot stale (see `subSnapshotRebuild()`).
+         * Must be called with locked mutex of the shard.
+         *
+         * @param shard Sub DB shard
+         */
+        static void subSnapshotPublish(SubDBShard& shard)
+        {
+            for (auto& topic : shard.dirtyTopics) {
+                auto& snapshotTopic = shard.snapshotTopics[topic];
+                if (!snapshotTopic) {
+                    snapshotTopic = std::make_shared<SubSnapshotTopic>();
+                    shard.snapshotStale = true;
+                }
+
+                std::atomic_store(&snapshotTopic->entries,
+                                  subSnapshotEntries(shard.subDB[topic]));
+            }
+
+            shard.dirtyTopics.clear();
         }
 
         /**
-         * @brief Removes and unsubscribes from unused topics
+         * @brief Removes topic from sub DB
          *
+         * Marks the snapshot stale. Until it's rebuilt, readers match
+         * no subscribers of the topic.
+         * Must be called with locked mutex of the shard.
+         *
+         * @param shard Sub DB shard
+         * @param topic Topic
          */
-        void subDBRemoveUnusedTopics()
+        static void subDBRemoveTopic(SubDBShard& shard, const std::string& topic)
         {
-            const std::scoped_lock lock(m_mutex);
+            shard.subDB.remove(topic);
+            shard.dirtyTopics.erase(topic);
 
-            std::vector<std::string> unusedTopics;
+            auto it = shard.snapshotTopics.find(topic);
+            if (it == shard.snapshotTopics.end()) {
+                return;
+            }
+
+            std::atomic_store(&it->second->entries,
+                              std::shared_ptr<const SubSnapshotEntriesT>{
+                                  std::make_shared<const SubSnapshotEntriesT>()});
+            shard.snapshotTopics.erase(it);
+            shard.snapshotStale = true;
+        }
 
-            // Get unused topics
-            m_subDB.forEach([&unusedTopics] (const std::string& topic,
-                                             const SubDBMapT& entryMap) {
-                if (entryMap.empty()) {
-                    unusedTopics.push_back(topic);
+        /**
+         * @brief Rebuilds stale snapshot of sub DB
+         *
+         * Called by writers after releasing mutex of the shard (readers
+         * only load the snapshot). Only topics are copied under the mutex,
+         * the snapshot is built without blocking other writers.
+         * Writers waiting for rebuild in progress are covered by single
+         * next rebuild.
+         *
+         * @param shard Sub DB shard
+         */
+        void subSnapshotRebuild(SubDBShard& shard)
+        {
+            if (!shard.snapshotStale) {
+                return;
+            }
+
+            const std::scoped_lock rebuildLock(shard.snapshotRebuildMutex);
+
+            // Rebuilt meanwhile
+            if (!shard.snapshotStale.exchange(false)) {
+                return;
+            }
+
+            typename SubSnapshotT::ItemsT items;
+
+            {
+                const std::scoped_lock lock(shard.mutex);
+
+                items.reserve(shard.snapshotTopics.size());
+                for (auto& [topic, snapshotTopic] : shard.snapshotTopics) {
+                    items.push_back({ topic, snapshotTopic });
                 }
-            });
-
-            // Unsubscribe from them
-            for (auto& topic : unusedTopics) {
-                if (this->getFarLayer()->unsubscribe(topic)) {
-                    // Unsub successful, remove topic from sub DB
-                    m_subDB.remove(topic);
-                    SPSP_LOGD("SubDB: Removed unused topic '%s'", topic.c_str());
-                } else {
-                    SPSP_LOGW("SubDB: Topic '%s' can't be unsubscribed. Will try again in next tick.",
-                              topic.c_str());
+            }
+
+            std::atomic_store(&shard.snapshot,
+                              std::shared_ptr<const SubSnapshotT>{
+                                  std::make_shared<const SubSnapshotT>(items)});
+            m_snapshotRebuilds++;
+
+            SPSP_LOGD("SubDB: Snapshot rebuilt (%zu topics)", items.size());
+        }
+
+        /**
+         * @brief Adds topic to reverse index of client
+         *
+         * @param addr Client address
+         * @param topic Topic
+         * @return true Topic added
+         * @return false Quota of client exceeded
+         */
+        bool clientAddTopic(const LocalAddrT& addr, const std::string& topic)
+        {
+            const std::scoped_lock lock(m_clientsMutex);
+
+            auto& client = m_clients[addr];
+
+            if (m_conf.subDB.maxSubsPerClient != 0 &&
+                client.topics.size() >= m_conf.subDB.maxSubsPerClient) {
+                client.rejectedSubs++;
+                return false;
+            }
+
+            client.topics.insert(topic);
+            return true;
+        }
+
+        /**
+         * @brief Removes topic from reverse index of client
+         *
+         * @param addr Client address
+         * @param topic Topic
+         */
+        void clientRemoveTopic(const LocalAddrT& addr, const std::string& topic)
+        {
+            const std::scoped_lock lock(m_clientsMutex);
+
+            auto it = m_clients.find(addr);
+            if (it == m_clients.end()) {
+                return;
+            }
+
+            it->second.topics.erase(topic);
+            if (it->second.topics.empty() && it->second.rejectedSubs == 0) {
+                m_clients.erase(it);
+            }
+        }
+
+        /**
+         * @brief Gets topics of client grouped by sub DB shard
+         *
+         * @param addr Client address
+         * @param remove Whether to remove client from reverse index
+         * @return Topics by shard
+         */
+        std::unordered_map<SubDBShard*, std::vector<std::string>> clientTopicsByShard(
+            const LocalAddrT& addr, bool remove)
+        {
+            std::unordered_map<SubDBShard*, std::vector<std::string>> topics;
+
+            const std::scoped_lock lock(m_clientsMutex);
+
+            auto it = m_clients.find(addr);
+            if (it == m_clients.end()) {
+                return topics;
+            }
+
+            for (auto& topic : it->second.topics) {
+                topics[&this->subDBShard(topic)].push_back(topic);
+            }
+
+            if (remove) {
+                m_clients.erase(it);
+            }
+
+            return topics;
+        }
+
+        /**
+         * @brief Renews all subscriptions of client
+         *
+         * @param addr Client address
+         */
+        void renewClient(const LocalAddrT& addr)
+        {
+            auto topics = this->clientTopicsByShard(addr, false);
+
+            for (auto& [shard, shardTopics] : topics) {
+                const std::scoped_lock lock(shard->mutex);
+
+                auto now = std::chrono::steady_clock::now();
+                auto deadline = now + m_conf.subDB.subLifetime;
+
+                for (auto& topic : shardTopics) {
+                    // Don't create missing topic (snapshot has the same topics)
+                    if (!shard->snapshotTopics.count(topic)) {
+                        continue;
+                    }
+
+                    auto& entryMap = shard->subDB[topic];
+                    auto entryIt = entryMap.find(addr);
+                    if (entryIt != entryMap.end()) {
+                        // Expiration is rescheduled when reached
+                        entryIt->second.deadline = deadline;
+                    }
                 }
             }
         }
+
+        /**
+         * @brief Handles activity of client
+         *
+         * @param addr Client address
+         */
+        void clientActivity(const LocalAddrT& addr)
+        {
+            if (m_conf.subDB.renewOnActivity) {
+                this->renewClient(addr);
+            }
+        }
+
+        /**
+         * @brief Creates sub DB shards
+         *
+         * @param conf Sub DB configuration
+         * @return Shards
+         */
+        static SubDBShardsT makeSubDBShards(const BridgeConfig::SubDB& conf)
+        {
+            SubDBShardsT result;
+
+            // Slot for each tick of subscribe lifetime (and current one)
+            auto interval = std::max(conf.interval, std::chrono::milliseconds(1));
+            size_t wheelSlots = (conf.subLifetime + interval - std::chrono::milliseconds(1))
+                                / interval + 1;
+
+            // Plus one for topics with wildcard first level
+            for (size_t i = 0; i < std::max<size_t>(conf.shards, 1) + 1; i++) {
+                result.push_back(std::make_unique<SubDBShard>());
+                result.back()->expiryWheel.resize(wheelSlots);
+            }
+
+            return result;
+        }
+
+        /**
+         * @brief Gets sub DB shard of topic
+         *
+         * @param topic Topic
+         * @return Shard
+         */
+        SubDBShard& subDBShard(std::string_view topic)
+        {
+            auto firstLevel = topic.substr(0, topic.find('/'));
+
+            if (firstLevel == "+" || firstLevel == "#") {
+                return *m_subDBShards.back();
+            }
+
+            auto index = std::hash<std::string_view>{}(firstLevel)
+                         % (m_subDBShards.size() - 1);
+            return *m_subDBShards[index];
+        }
     };
 } // namespace SPSP::Nodes
 
@@ -0,0 +1,52 @@
+/**
+ * @file buffered_random.hpp
+ * @author Dávid Benko (davidbenko@davidbenko.dev)
+ * @brief Buffered cryptographically secure random generator
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+
+#include "spsp/random.hpp"
+#include "spsp/random_if.hpp"
+
+namespace SPSP
+{
+    /**
+     * @brief Buffered cryptographically secure random generator
+     *
+     * ChaCha20-based DRBG seeded from platform `Random`. Keystream is
+     * generated in chunks and key is replaced from each chunk before any
+     * output is returned (fast key erasure), so previous outputs can't be
+     * recovered from current state.
+     *
+     * State is per-thread (shared by all instances), so there's no locking.
+     * It's reseeded from platform `Random` after `RESEED_INTERVAL` bytes
+     * and after `fork()`.
+     *
+     * Intended for hot paths (i.e. packet nonces), where calling platform
+     * generator (syscall on Linux) for every few bytes is too expensive.
+     */
+    class BufferedRandom : public IRandom
+    {
+        Random m_seedSource;  //!< Platform generator used for (re)seeding
+
+    public:
+        //! Number of bytes generated before reseeding
+        static constexpr uint64_t RESEED_INTERVAL = 1 << 20;
+
+        /**
+         * @brief Generates `len` random bytes in `buf`
+         *
+         * @param buf Buffer
+         * @param len Length
+         * @throw RandomGeneratorError Random generator error if (re)seeding fails.
+         */
+        void bytes(void* buf, size_t len) const;
+    };
+} // namespace SPSP
@@ -14,6 +14,7 @@
 #include <future>
 #include <mutex>
 #include <unordered_map>
+#include <vector>
 #include <sys/time.h>  // Unix and ESP
 
 #include "spsp/logger.hpp"
@@ -98,18 +99,23 @@ namespace SPSP::Nodes
     public:
         using LocalAddrT = typename TLocalLayer::LocalAddrT;
         using LocalMessageT = typename TLocalLayer::LocalMessageT;
+        using LocalMessageViewT = LocalMessageView<LocalAddrT>;
 
         /**
          * @brief Constructs a new client node
          *
          * @param ll Local layer
          * @param conf Configuration
+         * @param executor Executor of asynchronous tasks (`nullptr` for default)
          */
-        Client(TLocalLayer* ll, ClientConfig conf = {})
+        Client(TLocalLayer* ll, ClientConfig conf = {},
+               IExecutor* executor = nullptr)
             : ILocalNode<TLocalLayer>{ll}, m_conf{conf}, m_subDB{},
               m_subDBTimer{conf.subDB.interval,
                            std::bind(&Client<TLocalLayer>::subDBTick, this)}
         {
+            this->setExecutor(executor);
+
             SPSP_LOGI("Initialized");
         }
 
@@ -119,6 +125,8 @@ namespace SPSP::Nodes
          */
         ~Client()
         {
+            this->waitForTasks();
+
             SPSP_LOGI("Deinitialized");
         }
 
@@ -315,7 +323,7 @@ namespace SPSP::Nodes
          * @return true Message delivery successful
          * @return false Message delivery failed
          */
-        bool processProbeReq(const LocalMessageT& req,
+        bool processProbeReq(const LocalMessageViewT& req,
                              int rssi = NODE_RSSI_UNKNOWN) { return false; }
 
         /**
@@ -329,7 +337,7 @@ namespace SPSP::Nodes
          * @return true Message delivery successful
          * @return false Message delivery failed
          */
-        bool processProbeRes(const LocalMessageT& req,
+        bool processProbeRes(const LocalMessageViewT& req,
                              int rssi = NODE_RSSI_UNKNOWN)
         {
             if (m_conf.reporting.rssiOnProbe) {
@@ -348,7 +356,7 @@ namespace SPSP::Nodes
          * @return true Message delivery successful
          * @return false Message delivery failed
          */
-        bool processPub(const LocalMessageT& req,
+        bool processPub(const LocalMessageViewT& req,
                         int rssi = NODE_RSSI_UNKNOWN) { return false; }
 
         /**
@@ -361,7 +369,7 @@ namespace SPSP::Nodes
          * @return true Message delivery successful
          * @return false Message delivery failed
          */
-        bool processSubReq(const LocalMessageT& req,
+        bool processSubReq(const LocalMessageViewT& req,
                            int rssi = NODE_RSSI_UNKNOWN) { return false; }
 
         /**
@@ -372,20 +380,26 @@ namespace SPSP::Nodes
          * @return true Message delivery successful
          * @return false Message delivery failed
          */
-        bool processSubData(const LocalMessageT& req,
+        bool processSubData(const LocalMessageViewT& req,
                             int rssi = NODE_RSSI_UNKNOWN)
         {
-            // Get matching entries
-            std::unordered_map<std::string, const SubDBEntry&> entries;
+            // User callbacks take ownership of data
+            const std::string topic{req.topic};
+            const std::string payload{req.payload};
+
+            // Get callbacks of matching entries (called without lock)
+            std::vector<SubscribeCb> cbs;
             {
                 const std::scoped_lock lock(m_mutex);
-                entries = m_subDB.find(req.topic);
+                m_subDB.findEach(topic, [&cbs](const auto& match) {
+                    cbs.push_back(match.value.cb);
+                });
             }
 
-            for (auto& [subTopic, entry] : entries) {
+            for (auto& cb : cbs) {
                 SPSP_LOGD("Calling user callback for topic '%s'",
-                          req.topic.c_str());
-                entry.cb(req.topic, req.payload);
+                          topic.c_str());
+                cb(topic, payload);
             }
 
             return true;
@@ -399,7 +413,7 @@ namespace SPSP::Nodes
          * @return true Message delivery successful
          * @return false Message delivery failed
          */
-        bool processUnsub(const LocalMessageT& req,
+        bool processUnsub(const LocalMessageViewT& req,
                           int rssi = NODE_RSSI_UNKNOWN) { return false; }
 
         /**
@@ -412,7 +426,7 @@ namespace SPSP::Nodes
          * @return true Message delivery successful
          * @return false Message delivery failed
          */
-        bool processTimeReq(const LocalMessageT& req,
+        bool processTimeReq(const LocalMessageViewT& req,
                             int rssi = NODE_RSSI_UNKNOWN) { return false; }
 
         /**
@@ -425,12 +439,13 @@ namespace SPSP::Nodes
          * @return true Message delivery successful
          * @return false Message delivery failed
          */
-        bool processTimeRes(const LocalMessageT& req,
+        bool processTimeRes(const LocalMessageViewT& req,
                             int rssi = NODE_RSSI_UNKNOWN)
         {
             const std::scoped_lock lock(m_mutex);
 
-            auto nowMilliseconds = stoull(req.payload);
+            const std::string payload{req.payload};
+            auto nowMilliseconds = stoull(payload);
 
             // No time sync ongoing now
             if (!m_timeSyncOngoing) {
@@ -440,7 +455,7 @@ namespace SPSP::Nodes
             // Timestamp must have at least 13 digits
             if (nowMilliseconds < 1e12) {
                 SPSP_LOGE("Time sync: invalid time received from bridge: '%s'",
-                          req.payload.c_str());
+                          payload.c_str());
                 m_timeSyncPromise.set_value(false);
                 return false;
             }
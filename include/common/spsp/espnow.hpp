@@ -9,16 +9,23 @@
 
 #pragma once
 
-#include <array>
 #include <climits>
-#include <future>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "spsp/espnow_adapter_if.hpp"
 #include "spsp/espnow_packet.hpp"
 #include "spsp/espnow_ser_des.hpp"
+#include "spsp/espnow_tx_frame.hpp"
 #include "spsp/espnow_types.hpp"
+#include "spsp/executor.hpp"
 #include "spsp/layers.hpp"
 #include "spsp/local_addr_mac.hpp"
 #include "spsp/wifi_espnow_if.hpp"
@@ -27,15 +34,6 @@ namespace SPSP::LocalLayers::ESPNOW
 {
     static constexpr int SIGNAL_MIN = INT_MIN;  //!< Worst signal value
 
-    /**
-     * @brief Maximum number of simultaneous peers
-     *
-     * Peers are added and removed during each message sending, so this really
-     * only limits number of concurrent "deliveries". Concurrent "deliveries"
-     * over this limit will have to wait in queue.
-     */
-    static constexpr uint8_t MAX_PEER_NUM = 15;
-
     /**
      * @brief RTC memory enabled bridge connection info
      *
@@ -47,6 +45,24 @@ namespace SPSP::LocalLayers::ESPNOW
         uint8_t ch;       //!< Wireless channel
     };
 
+    /**
+     * @brief Completion callback of asynchronous send
+     *
+     * @param delivered Whether message has been delivered successfully
+     */
+    using SendCb = std::function<void(bool delivered)>;
+
+    /**
+     * @brief Statistics of registered peer cache
+     *
+     */
+    struct PeerCacheStats
+    {
+        uint64_t hits = 0;       //!< Sends to already registered peer
+        uint64_t misses = 0;     //!< Sends requiring peer registration
+        uint64_t evictions = 0;  //!< Peers unregistered to make room for others
+    };
+
     /**
      * @brief ESP-NOW local layer
      *
@@ -56,6 +72,7 @@ namespace SPSP::LocalLayers::ESPNOW
     public:
         using LocalAddrT = SPSP::LocalLayers::ESPNOW::LocalAddrT;
         using LocalMessageT = SPSP::LocalLayers::ESPNOW::LocalMessageT;
+        using LocalMessageViewT = SPSP::LocalLayers::ESPNOW::LocalMessageViewT;
     
     protected:
         /**
@@ -98,6 +115,17 @@ namespace SPSP::LocalLayers::ESPNOW
             BridgeConnInfoRTC toRTC();
         };
 
+        /**
+         * @brief Message waiting for (or being in) delivery
+         *
+         */
+        struct PendingSend
+        {
+            LocalAddrT dst;                  //!< Destination address
+            std::unique_ptr<TxFrame> frame;  //!< Serialized packet
+            SendCb cb;                       //!< Completion callback
+        };
+
         std::mutex m_mutex;                        //!< Mutex to prevent race conditions
         const Config m_conf;                       //!< Configuration
         WiFi::IESPNOW& m_wifi;                     //!< WiFi instance
@@ -105,27 +133,48 @@ namespace SPSP::LocalLayers::ESPNOW
         SerDes m_serdes;                           //!< Packet serializer/deserializer
         BridgeConnInfoInternal m_bestBridge = {};  //!< Bridge with best signal
         std::mutex m_bestBridgeMutex;              //!< Mutex for modifying m_bestBridge* attributes
+        /**
+         * @brief Ordered queue of messages to one peer
+         *
+         */
+        struct PeerQueue
+        {
+            std::deque<PendingSend> packets;  //!< Packets (the first one may be in flight)
+            bool inFlight = false;            //!< Whether the first packet is being delivered
+        };
+
+        std::mutex m_sendMutex;                    //!< Mutex for `m_sendQueues` and related
+        std::recursive_mutex m_adapterMutex;       //!< Serializes peer registration and sending (and protects peer cache)
+        size_t m_maxInFlight;                      //!< Maximum number of peers in flight
+        size_t m_inFlight = 0;                     //!< Number of peers in flight
 
         /**
-         * @brief Container for promises of being-sent messages
+         * @brief Queues of being-sent messages keyed by exact peer address
          *
-         * `send()` blocks until status of delivery is available (and no other
-         * message is being sent to the same node).
-         * Assign each peer a "bucket". When sending a message to other peer
-         * from the same bucket, wait for it to finish. Additional support for
-         * this mechanism is provided by `m_sendingMutexes`.
+         * Only the first message of each peer is being delivered, the rest
+         * waits for it's send callback. At most `m_maxInFlight` peers are
+         * in flight, others wait in `m_waitingPeers`.
          */
-        std::array<std::promise<bool>, MAX_PEER_NUM> m_sendingPromises;
+        std::unordered_map<LocalAddrT, PeerQueue> m_sendQueues;
+        std::deque<LocalAddrT> m_waitingPeers;     //!< Peers waiting for free in-flight slot
 
         /**
-         * @brief Container for mutex of being-sent messages
+         * @brief Registered peers ordered from the most recently used
          *
-         * We need only one thread waiting for message status per bucket in
-         * `m_sendingPromises`.
-         * Efectively allows maximum of `MAX_PEER_NUM` messages being sent
-         * at the same time.
+         * Peers stay registered in adapter after sending and are
+         * unregistered only when adapter's peer list is full.
          */
-        std::array<std::mutex, MAX_PEER_NUM> m_sendingMutexes;
+        std::list<LocalAddrT> m_peerCache;
+
+        //! Index of `m_peerCache` entries
+        std::unordered_map<LocalAddrT, std::list<LocalAddrT>::iterator> m_peerCacheIndex;
+        PeerCacheStats m_peerCacheStats = {};      //!< Peer cache statistics
+
+        std::mutex m_framePoolMutex;                           //!< Mutex for `m_framePool`
+        std::vector<std::unique_ptr<TxFrame>> m_framePool;     //!< Frames available for reuse
+
+        IExecutor* m_executor;                                 //!< Executor of receive handlers
+        TaskGroup m_tasks;                                     //!< Pending receive handlers
     
     public:
         /**
@@ -136,8 +185,11 @@ namespace SPSP::LocalLayers::ESPNOW
          * @param adapter ESP-NOW low-level adapter
          * @param wifi WiFi instance
          * @param conf Configuration
+         * @param executor Executor of receive handlers
+         *                 (`nullptr` for default one)
          */
-        ESPNOW(IAdapter& adapter, WiFi::IESPNOW& wifi, const Config& conf);
+        ESPNOW(IAdapter& adapter, WiFi::IESPNOW& wifi, const Config& conf,
+               IExecutor* executor = nullptr);
 
         /**
          * @brief Destroys ESP-NOW layer object
@@ -151,6 +203,7 @@ namespace SPSP::LocalLayers::ESPNOW
          * In the message, empty address means send to the bridge peer.
          *
          * Note: this will block until delivery status is confirmed!
+         * Wrapper around `sendAsync()`.
          *
          * @param msg Message
          * @return true Delivery successful
@@ -158,6 +211,23 @@ namespace SPSP::LocalLayers::ESPNOW
          */
         bool send(const LocalMessageT& msg);
 
+        /**
+         * @brief Sends the message to given node without waiting for delivery
+         *
+         * In the message, empty address means send to the bridge peer.
+         *
+         * Messages to the same peer are delivered one by one in order of
+         * calls. Callback is called exactly once when delivery status is
+         * known (possibly even before this method returns). It's called
+         * from adapter's context, so it mustn't block.
+         *
+         * @param msg Message
+         * @param cb Completion callback (may be `nullptr`)
+         * @return true Message has been queued (callback will be called)
+         * @return false Message can't be sent (callback won't be called)
+         */
+        bool sendAsync(const LocalMessageT& msg, SendCb cb);
+
         /**
          * @brief Connects to the bridge
          *
@@ -182,54 +252,135 @@ namespace SPSP::LocalLayers::ESPNOW
         bool connectToBridge(BridgeConnInfoRTC* rtndBr = nullptr,
                              BridgeConnInfoRTC* connBr = nullptr);
 
+        /**
+         * @brief Gets statistics of registered peer cache
+         *
+         * @return Statistics
+         */
+        PeerCacheStats getPeerCacheStats();
+
     protected:
         /**
          * @brief Receive message handler
          *
          * Separate from `recvCb` to allow simpler testing.
          *
-         * @param msg Message
+         * @param msg Message (valid only during the call)
          * @param rssi Received signal strength indicator (in dBm)
          */
-        void receive(const LocalMessageT& msg, int rssi);
+        void receive(const LocalMessageViewT& msg, int rssi);
 
         /**
          * @brief Sends raw packet to the underlaying library
          *
-         * Also registers and unregisters the peer temporarily.
+         * Also registers the peer (if it isn't already).
+         *
+         * @param dst Destination address
+         * @param frame Frame (must be valid until send callback)
+         * @throw AdapterError when adapter fails to send the packet
+         */
+        void sendRaw(const LocalAddrT& dst, TxFrame& frame);
+
+        /**
+         * @brief Registers peer in adapter using peer cache
+         *
+         * When adapter's peer list is full, the least recently used peer
+         * without packet in flight is unregistered.
          *
-         * This is not multi-thread safe.
+         * @param peer Peer address
+         * @throw AdapterError when peer can't be registered
+         */
+        void registerPeer(const LocalAddrT& peer);
+
+        /**
+         * @brief Queues raw packet for delivery
+         *
+         * @param dst Destination address
+         * @param frame Frame
+         * @param cb Completion callback (may be `nullptr`)
+         */
+        void sendRawAsync(const LocalAddrT& dst, std::unique_ptr<TxFrame> frame,
+                          SendCb cb);
+
+        /**
+         * @brief Sends raw packet and waits for delivery status
          *
          * @param dst Destination address
-         * @param data Raw data
+         * @param frame Frame
+         * @return true Delivery successful
+         * @return false Delivery failed
+         */
+        bool sendRawBlocking(const LocalAddrT& dst, std::unique_ptr<TxFrame> frame);
+
+        /**
+         * @brief Gets frame for serialization
+         *
+         * Reuses previously released frame if possible.
+         *
+         * @return Frame
+         */
+        std::unique_ptr<TxFrame> acquireFrame();
+
+        /**
+         * @brief Returns frame for reuse
+         *
+         * @param frame Frame (may be `nullptr`)
+         */
+        void releaseFrame(std::unique_ptr<TxFrame> frame);
+
+        /**
+         * @brief Passes the first queued packet of peer to the adapter
+         *
+         * Packets refused by adapter are completed as undelivered.
+         *
+         * @param peer Peer address (must be in flight)
+         */
+        void sendRawNext(LocalAddrT peer);
+
+        /**
+         * @brief Removes in-flight packet of peer from queue
+         *
+         * Moves the in-flight slot to the next packet of the same peer
+         * or to the first waiting peer.
+         *
+         * @param peer Peer address
+         * @param done Storage for removed packet
+         * @return Peer whose first packet should be sent next (if any)
          */
-        void sendRaw(const LocalAddrT& dst, const std::string& data);
+        std::optional<LocalAddrT> popInFlight(const LocalAddrT& peer,
+                                              PendingSend& done);
 
         /**
          * @brief Receive callback for underlaying ESP-NOW adapter
          *
+         * Runs in adapter's thread, or in executor with copy of adapter's
+         * data (if adapter calls it from driver's context).
+         * Packet is decrypted in-place and passed to node without copying.
+         *
          * @param src Source address
-         * @param data Raw data
+         * @param data Raw data (modified!)
+         * @param len Length of raw data
          * @param rssi Received signal strength indicator (in dBm)
          */
-        void recvCb(const LocalAddrT src, std::string data, int rssi);
+        void recvCb(const LocalAddrT& src, uint8_t* data, size_t len, int rssi);
 
         /**
-         * @brief Send callback for underlaying ESP-NOW adapter
+         * @brief Batch receive callback for underlaying ESP-NOW adapter
          *
-         * @param dst Destination address
-         * @param delivered Whether packet has been delivered successfully
+         * Runs in adapter's thread. All packets are deserialized
+         * (and decrypted in-place) together and then passed to node.
+         *
+         * @param items Received packets (data are modified!)
+         * @param count Number of packets
          */
-        void sendCb(const LocalAddrT dst, bool delivered);
+        void recvBatchCb(const AdapterRecvItem* items, size_t count);
 
         /**
-         * @brief Calculates bucket id from `LocalAddrT` object
-         *
-         * Used for `m_sendingPromises` and `m_sendingMutexes` arrays.
+         * @brief Send callback for underlaying ESP-NOW adapter
          *
-         * @param addr Address of the peer
-         * @return Bucket id
+         * @param dst Destination address
+         * @param delivered Whether packet has been delivered successfully
          */
-        uint8_t getBucketIdFromLocalAddr(const LocalAddrT& addr) const;
+        void sendCb(const LocalAddrT dst, bool delivered);
     };
 } // namespace SPSP::LocalLayers::ESPNOW
@@ -12,6 +12,7 @@
 #include <functional>
 #include <string>
 
+#include "spsp/espnow_tx_frame.hpp"
 #include "spsp/espnow_types.hpp"
 #include "spsp/exception.hpp"
 
@@ -27,9 +28,25 @@ namespace SPSP::LocalLayers::ESPNOW
     };
 
     // Callback types
-    using AdapterRecvCb = std::function<void(const LocalAddrT src, std::string data, int rssi)>;
+    //! Receive callback (`data` may be modified in-place, valid only during the call)
+    using AdapterRecvCb = std::function<void(const LocalAddrT& src, uint8_t* data, size_t len, int rssi)>;
     using AdapterSendCb = std::function<void(const LocalAddrT dst, bool delivered)>;
 
+    /**
+     * @brief Received packet passed to batch receive callback
+     *
+     */
+    struct AdapterRecvItem
+    {
+        LocalAddrT src;          //!< Source address
+        uint8_t* data;           //!< Raw data (may be modified in-place, valid only during the call)
+        size_t len;              //!< Length of raw data
+        int rssi;                //!< Received signal strength indicator (in dBm)
+    };
+
+    //! Batch receive callback
+    using AdapterRecvBatchCb = std::function<void(const AdapterRecvItem* items, size_t count)>;
+
     /**
      * @brief Interface for platform-dependent ESP-NOW adapter
      *
@@ -41,15 +58,47 @@ namespace SPSP::LocalLayers::ESPNOW
         /**
          * @brief Sets receive callback
          *
-         * Callback should be called in new thread.
+         * If `recvFromDriverContext()`, data are copied and passed
+         * to layer's executor (without blocking). Otherwise, callback
+         * processes them directly.
          *
          * @param cb Callback
          */
         virtual void setRecvCb(AdapterRecvCb cb) = 0;
 
+        /**
+         * @brief Checks whether receive callback is called from driver's context
+         *
+         * Adapter delivering from its own workers should return `false`,
+         * so received data aren't copied and passed to another thread.
+         *
+         * @return true Callback is called from driver's context (must not block)
+         * @return false Callback is called from adapter's own thread
+         */
+        virtual bool recvFromDriverContext() const noexcept
+        {
+            return true;
+        }
+
+        /**
+         * @brief Sets batch receive callback
+         *
+         * Adapter receiving many packets at once (e.g. in one block
+         * of receive ring) should pass them together to this callback
+         * instead of receive callback. Never called from driver's context.
+         * Default implementation ignores it (adapter doesn't batch).
+         *
+         * @param cb Callback
+         */
+        virtual void setRecvBatchCb(AdapterRecvBatchCb cb) {}
+
         /**
          * @brief Sets send callback
          *
+         * Callback must not be called from driver's context (it sends
+         * next queued packet) nor from layer's executor (which may be
+         * waiting for it).
+         *
          * @param cb Callback
          */
         virtual void setSendCb(AdapterSendCb cb) = 0;
@@ -57,10 +106,13 @@ namespace SPSP::LocalLayers::ESPNOW
         /**
          * @brief Sends local message
          *
+         * Frame must stay valid until send callback for it is called.
+         * Adapter may write it's headers into frame's headroom.
+         *
          * @param dst Destination address
-         * @param data Raw data to be sent
+         * @param frame Frame with packet to be sent
          */
-        virtual void send(const LocalAddrT& dst, const std::string& data) = 0;
+        virtual void send(const LocalAddrT& dst, TxFrame& frame) = 0;
 
         /**
          * @brief Adds peer to peer list
@@ -75,5 +127,14 @@ namespace SPSP::LocalLayers::ESPNOW
          * @param peer Peer address
          */
         virtual void removePeer(const LocalAddrT& peer) = 0;
+
+        /**
+         * @brief Gets maximum number of simultaneously registered peers
+         *
+         * Limits number of peers with message being delivered at the same time.
+         *
+         * @return Maximum number of peers
+         */
+        virtual size_t getMaxPeerNum() const noexcept = 0;
     };
 } // namespace SPSP::LocalLayers::ESPNOW
@@ -9,12 +9,26 @@
 
 #pragma once
 
+#include <array>
+
+#include "spsp/buffered_random.hpp"
 #include "spsp/espnow_types.hpp"
 #include "spsp/espnow_packet.hpp"
-#include "spsp/random.hpp"
 
 namespace SPSP::LocalLayers::ESPNOW
 {
+    /**
+     * @brief Packet for batch deserialization
+     *
+     */
+    struct DeserializeBatchItem
+    {
+        uint8_t* data;          //!< Raw data input (modified!)
+        size_t dataLen;         //!< Length of data
+        LocalMessageViewT msg;  //!< Message view output (address is set by caller)
+        bool valid = false;     //!< Output: whether deserialization succeeded
+    };
+
     /**
      * @brief Serializer and deserializer of ESP-NOW packets
      *
@@ -22,17 +36,51 @@ namespace SPSP::LocalLayers::ESPNOW
      */
     class SerDes
     {
-        const Config& m_conf;  //!< Configuration reference
-        Random m_rand;         //!< Random generator
+        //! Number of packets decrypted together by `deserializeBatch()`
+        static constexpr size_t DESERIALIZE_BATCH_CHUNK = 16;
+
+        //! Maximum number of keys (SSIDs)
+        static constexpr size_t MAX_KEYS = 4;
+
+        /**
+         * @brief Precomputed key half of ChaCha20 state for one SSID
+         *
+         */
+        struct KeyEntry
+        {
+            uint32_t ssid;       //!< SSID the key belongs to
+            uint32_t words[16];  //!< ChaCha20 state with constants and key (nonce is set per packet)
+        };
+
+        BufferedRandom m_rand;                  //!< Nonce generator
+        std::array<KeyEntry, MAX_KEYS> m_keys;  //!< Keys (the first one is from config)
+        size_t m_keysCount = 0;                 //!< Number of used `m_keys`
 
     public:
         /**
          * @brief Construct a new serializer/deserializer
          *
+         * Key state for `conf.ssid` is precomputed from `conf.password`,
+         * so later changes of them aren't reflected.
+         *
          * @param conf Configuration
          */
         SerDes(const Config& conf) noexcept;
 
+        /**
+         * @brief Sets key for packets with given SSID
+         *
+         * Packets are serialized with SSID from config, but deserialized
+         * with any SSID having a key.
+         * Not thread-safe - set all keys before (de)serializing.
+         *
+         * @param ssid Numeric SSID
+         * @param password Password (32 bytes, shorter is padded with zeros)
+         * @return true Key has been set
+         * @return false Key table is full
+         */
+        bool setKey(uint32_t ssid, const std::string& password) noexcept;
+
         /**
          * @brief Serializes local message to raw data
          *
@@ -43,6 +91,19 @@ namespace SPSP::LocalLayers::ESPNOW
          */
         void serialize(const LocalMessageT& msg, std::string& data) const noexcept;
 
+        /**
+         * @brief Serializes local message directly to buffer
+         *
+         * Doesn't allocate.
+         *
+         * @param msg Message input
+         * @param buf Output buffer
+         * @param bufLen Length of output buffer
+         * @return Packet length (0 if buffer is too small)
+         */
+        size_t serialize(const LocalMessageT& msg, uint8_t* buf,
+                         size_t bufLen) const noexcept;
+
         /**
          * @brief Deserializes raw data to local message
          *
@@ -55,6 +116,36 @@ namespace SPSP::LocalLayers::ESPNOW
         bool deserialize(const LocalAddrT& src, std::string& data,
                          LocalMessageT& msg) const noexcept;
 
+        /**
+         * @brief Deserializes raw data to local message view
+         *
+         * Doesn't allocate. Data are decrypted in-place and topic and payload
+         * of `msg` point into them, so `data` must outlive `msg`.
+         * Address of `msg` is left untouched.
+         *
+         * @param data Raw data input (modified!)
+         * @param dataLen Length of data
+         * @param msg Message view output
+         * @return true Deserialization successful
+         * @return false Deserialization failed
+         */
+        bool deserialize(uint8_t* data, size_t dataLen,
+                         LocalMessageViewT& msg) const noexcept;
+
+        /**
+         * @brief Deserializes many packets at once
+         *
+         * Same as calling `deserialize()` on each item, but all packets are
+         * decrypted together, which is considerably faster on platforms with
+         * vectorized ChaCha20.
+         *
+         * @param items Packets (`msg` and `valid` are filled)
+         * @param count Number of packets
+         * @return Number of successfully deserialized packets
+         */
+        size_t deserializeBatch(DeserializeBatchItem* items,
+                                size_t count) const noexcept;
+
         /**
          * @brief Calculates total packet length
          *
@@ -66,31 +157,33 @@ namespace SPSP::LocalLayers::ESPNOW
         static size_t getPacketLength(const LocalMessageT& msg) noexcept;
 
     protected:
-        /**
-         * @brief Checksums the given raw data (bytes)
-         *
-         * Optionally subtracts existing checksum.
-         *
-         * @param data Data to encrypt/decrypt
-         * @param dataLen Length of data
-         * @param existingChecksum Existing checksum (to subtract)
-         * @return Correct checksum
-         */
-        static uint8_t checksumRaw(uint8_t* data, size_t dataLen,
-                                   uint8_t existingChecksum = 0) noexcept;
-
         /**
          * @brief Encryption provider for raw data (bytes)
          *
          * Wraps ChaCha20 encryption.
          * This function is used for both encryption and decryption.
-         * Data are encrypted/decrypted in-place.
+         * Data are encrypted/decrypted in-place and checksummed in the same
+         * pass.
          *
+         * @param key Key
          * @param data Data to encrypt/decrypt
          * @param dataLen Length of data
          * @param nonce Encryption nonce
+         * @param decrypt Whether data are being decrypted (checksums output)
+         *                or encrypted (checksums input)
+         * @return Additive checksum of plaintext
          */
-        void encryptRaw(uint8_t* data, size_t dataLen, const uint8_t* nonce) const noexcept;
+        static uint8_t cryptRaw(const KeyEntry& key, uint8_t* data,
+                                size_t dataLen, const uint8_t* nonce,
+                                bool decrypt) noexcept;
+
+        /**
+         * @brief Finds key for SSID
+         *
+         * @param ssid Numeric SSID
+         * @return Key (`nullptr` if not found)
+         */
+        const KeyEntry* findKey(uint32_t ssid) const noexcept;
 
         /**
          * @brief Validates packet's header
@@ -102,13 +195,23 @@ namespace SPSP::LocalLayers::ESPNOW
         bool validatePacketHeader(const Packet* p) const noexcept;
 
         /**
-         * @brief Decrypts and validates packet's payload
+         * @brief Validates packet's decrypted payload
          *
-         * @param data Raw packet data
-         * @param dataLen Length of data
+         * @param p Packet (decrypted)
+         * @param dataLen Length of raw packet data (including header)
+         * @param plaintextSum Sum of decrypted bytes (excluding header)
          * @return true Payload is valid
          * @return false Payload is invalid
          */
-        bool decryptAndValidatePacketPayload(uint8_t* data, size_t dataLen) const noexcept;
+        bool validatePacketPayload(const Packet* p, size_t dataLen,
+                                   uint8_t plaintextSum) const noexcept;
+
+        /**
+         * @brief Points message view into packet's decrypted payload
+         *
+         * @param p Packet (decrypted and validated)
+         * @param msg Message view output
+         */
+        static void viewPacket(const Packet* p, LocalMessageViewT& msg) noexcept;
     };
 } // namespace SPSP::LocalLayers::ESPNOW
@@ -0,0 +1,62 @@
+/**
+ * @file espnow_tx_frame.hpp
+ * @author Dávid Benko (davidbenko@davidbenko.dev)
+ * @brief Buffer of ESP-NOW packet being transmitted
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "spsp/espnow_packet.hpp"
+
+namespace SPSP::LocalLayers::ESPNOW
+{
+    /**
+     * @brief Space reserved in front of packet for lower layer headers
+     *
+     * Allows adapters to prepend their headers (i.e. radiotap and 802.11)
+     * in place, without copying the packet.
+     */
+    static constexpr size_t TX_FRAME_HEADROOM = 64;
+
+    /**
+     * @brief Buffer of ESP-NOW packet being transmitted
+     *
+     * Packet is serialized directly into this buffer after headroom.
+     */
+    struct TxFrame
+    {
+        alignas(8) uint8_t buf[TX_FRAME_HEADROOM + MAX_PACKET_LENGTH];  //!< Headroom and packet
+        size_t len = 0;                                                 //!< Packet length
+
+        /**
+         * @brief Gets pointer to packet
+         *
+         * @return Packet (`MAX_PACKET_LENGTH` bytes available)
+         */
+        uint8_t* packet() noexcept { return buf + TX_FRAME_HEADROOM; }
+
+        /**
+         * @brief Gets pointer to packet
+         *
+         * @return Packet (`MAX_PACKET_LENGTH` bytes available)
+         */
+        const uint8_t* packet() const noexcept { return buf + TX_FRAME_HEADROOM; }
+
+        /**
+         * @brief Gets packet as view
+         *
+         * @return Packet view
+         */
+        std::string_view view() const noexcept
+        {
+            return {reinterpret_cast<const char*>(this->packet()), len};
+        }
+    };
+} // namespace SPSP::LocalLayers::ESPNOW
@@ -18,6 +18,16 @@ namespace SPSP::LocalLayers::ESPNOW
 {
     using LocalAddrT = SPSP::LocalAddrMAC;
     using LocalMessageT = SPSP::LocalMessage<SPSP::LocalAddrMAC>;
+    using LocalMessageViewT = SPSP::LocalMessageView<SPSP::LocalAddrMAC>;
+
+    /**
+     * @brief Maximum number of simultaneous peers on ESP platform
+     *
+     * Size of LRU cache of peers registered in ESP-NOW driver (least
+     * recently used peer is removed when new one is needed).
+     * Upper bound of `Config::maxInFlightPeers`.
+     */
+    static constexpr uint8_t MAX_PEER_NUM = 15;
 
     /**
      * @brief ESP-NOW configuration
@@ -35,5 +45,9 @@ namespace SPSP::LocalLayers::ESPNOW
         //! (gets reported to MQTT if `config.reporting.probePayload = true` on bridge)
         //! You probably want to put compile date or firmware version here.
         std::string probePayload = "";
+
+        //! Maximum number of peers with message being delivered at the same time
+        //! (0 = adapter's limit, lower of the two is used)
+        size_t maxInFlightPeers = 0;
     };
 } // namespace SPSP::LocalLayers::ESPNOW
@@ -0,0 +1,318 @@
+/**
+ * @file executor.hpp
+ * @author Dávid Benko (davidbenko@davidbenko.dev)
+ * @brief Executors of asynchronous tasks
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "spsp/worker_pool.hpp"
+
+namespace SPSP
+{
+    /**
+     * @brief Executor statistics
+     *
+     */
+    struct ExecutorStats
+    {
+        WorkerPoolStats queue;                    //!< Statistics of task queue
+        uint64_t executed = 0;                    //!< Number of executed tasks
+        std::chrono::microseconds latencyAvg{0};  //!< Average time from submission to start
+        std::chrono::microseconds latencyMax{0};  //!< Maximum time from submission to start
+    };
+
+    /**
+     * @brief Executor interface
+     *
+     * Runs tasks submitted by nodes, layers and adapters, which must not
+     * be run in caller's context (because caller holds a lock, runs
+     * in driver's task, etc.).
+     */
+    class IExecutor
+    {
+    public:
+        using TaskT = std::function<void()>;
+
+        virtual ~IExecutor() {}
+
+        /**
+         * @brief Submits task for execution
+         *
+         * @param task Task
+         * @return true Task has been accepted
+         * @return false Task has been dropped
+         */
+        virtual bool execute(TaskT task) = 0;
+
+        /**
+         * @brief Submits task for execution without ever blocking
+         *
+         * Meant for callers which must not be blocked (driver's context).
+         *
+         * @param task Task
+         * @return true Task has been accepted
+         * @return false Task has been rejected (executor is busy)
+         */
+        virtual bool tryExecute(TaskT task) = 0;
+
+        /**
+         * @brief Gets current statistics
+         *
+         * @return Statistics
+         */
+        virtual ExecutorStats getStats() = 0;
+    };
+
+    /**
+     * @brief Thread pool executor configuration
+     *
+     * Everything here is optional.
+     */
+    struct ThreadPoolExecutorConfig
+    {
+        size_t workers = 4;      //!< Number of worker threads
+        size_t queueSize = 256;  //!< Maximum number of tasks waiting for worker
+
+        /**
+         * What to do with task when queue is full.
+         * With `BLOCK`, task submitted from worker of the same executor
+         * is run by the submitter (so workers can't deadlock on themselves).
+         */
+        OverflowPolicy overflow = OverflowPolicy::BLOCK;
+
+        /**
+         * CPUs to pin workers to (assigned round-robin).
+         * Empty doesn't pin. Supported on Linux only.
+         */
+        std::vector<int> cpus = {};
+    };
+
+    /**
+     * @brief Executor running tasks in fixed-size pool of threads
+     *
+     */
+    class ThreadPoolExecutor : public IExecutor
+    {
+        /**
+         * @brief Queued task
+         *
+         */
+        struct Task
+        {
+            TaskT fn;                                        //!< Function
+            std::chrono::steady_clock::time_point submitted; //!< Time of submission
+        };
+
+        std::atomic<uint64_t> m_executed = 0;    //!< Executed tasks counter
+        std::atomic<uint64_t> m_latencySum = 0;  //!< Sum of latencies (in us)
+        std::atomic<uint64_t> m_latencyMax = 0;  //!< Maximum latency (in us)
+        WorkerPool<Task> m_pool;                 //!< Workers (destroyed first)
+
+    public:
+        /**
+         * @brief Constructs a new thread pool executor and starts workers
+         *
+         * @param conf Configuration
+         */
+        ThreadPoolExecutor(const ThreadPoolExecutorConfig& conf = {});
+
+        /**
+         * @brief Submits task for execution
+         *
+         * If the queue is full, overflow policy is applied.
+         *
+         * @param task Task
+         * @return true Task has been accepted
+         * @return false Task has been dropped
+         */
+        bool execute(TaskT task);
+
+        /**
+         * @brief Submits task for execution without ever blocking
+         *
+         * If the queue is full, `BLOCK` policy rejects the task,
+         * other policies are applied as usual.
+         *
+         * @param task Task
+         * @return true Task has been accepted
+         * @return false Task has been rejected or dropped
+         */
+        bool tryExecute(TaskT task);
+
+        /**
+         * @brief Gets current statistics
+         *
+         * @return Statistics (queue depth and queueing delay)
+         */
+        ExecutorStats getStats();
+
+    protected:
+        /**
+         * @brief Runs task (in worker thread)
+         *
+         * @param task Task
+         */
+        void run(Task& task);
+    };
+
+    /**
+     * @brief Executor running tasks immediately in caller's context
+     *
+     * Deterministic, meant for tests. Must not be used with adapters
+     * calling their callbacks from driver's context or with lock held.
+     */
+    class InlineExecutor : public IExecutor
+    {
+        std::atomic<uint64_t> m_executed = 0;  //!< Executed tasks counter
+
+    public:
+        /**
+         * @brief Runs task
+         *
+         * @param task Task
+         * @return true Always
+         */
+        bool execute(TaskT task)
+        {
+            task();
+            m_executed++;
+            return true;
+        }
+
+        /**
+         * @brief Runs task
+         *
+         * @param task Task
+         * @return true Always
+         */
+        bool tryExecute(TaskT task)
+        {
+            return this->execute(std::move(task));
+        }
+
+        /**
+         * @brief Gets current statistics
+         *
+         * @return Statistics (only `executed`)
+         */
+        ExecutorStats getStats()
+        {
+            ExecutorStats stats;
+            stats.queue.processed = m_executed;
+            stats.executed = m_executed;
+            return stats;
+        }
+    };
+
+    /**
+     * @brief Gets process-wide default executor
+     *
+     * Used by everything, which isn't given executor explicitly.
+     *
+     * @return Default executor
+     */
+    IExecutor& defaultExecutor();
+
+    /**
+     * @brief Group of tasks submitted by single owner
+     *
+     * Allows owner to wait for completion of its tasks before destroying
+     * anything they use. Task counts as finished also when it's dropped
+     * by the executor. Operations completed by others (e.g. callbacks
+     * of far layer) can be tracked too.
+     */
+    class TaskGroup
+    {
+        std::mutex m_mutex;            //!< Mutex protecting `m_pending`
+        std::condition_variable m_cv;  //!< Signalled when task finishes
+        size_t m_pending = 0;          //!< Number of unfinished tasks
+
+    public:
+        /**
+         * @brief Waits for tasks and destroys the group
+         *
+         */
+        ~TaskGroup()
+        {
+            this->wait();
+        }
+
+        /**
+         * @brief Submits task to executor
+         *
+         * @param executor Executor
+         * @param task Task
+         * @return true Task has been accepted
+         * @return false Task has been dropped
+         */
+        bool execute(IExecutor& executor, IExecutor::TaskT task)
+        {
+            // Finished when last copy of the task is destroyed
+            return executor.execute([guard = this->track(), task = std::move(task)] {
+                task();
+            });
+        }
+
+        /**
+         * @brief Submits task to executor without ever blocking
+         *
+         * @param executor Executor
+         * @param task Task
+         * @return true Task has been accepted
+         * @return false Task has been rejected or dropped
+         */
+        bool tryExecute(IExecutor& executor, IExecutor::TaskT task)
+        {
+            return executor.tryExecute([guard = this->track(), task = std::move(task)] {
+                task();
+            });
+        }
+
+        /**
+         * @brief Tracks operation running outside of executor
+         *
+         * Operation is finished when last copy of returned guard
+         * is destroyed.
+         *
+         * @return Guard
+         */
+        std::shared_ptr<void> track()
+        {
+            {
+                const std::scoped_lock lock(m_mutex);
+                m_pending++;
+            }
+
+            // Notified with lock held, as group may be destroyed right after
+            return std::shared_ptr<void>{nullptr, [this](void*) {
+                const std::scoped_lock lock(m_mutex);
+                m_pending--;
+                m_cv.notify_all();
+            }};
+        }
+
+        /**
+         * @brief Waits until all submitted tasks finish
+         *
+         * Must not be called from within the task of this group.
+         */
+        void wait()
+        {
+            std::unique_lock lock(m_mutex);
+            m_cv.wait(lock, [this] { return m_pending == 0; });
+        }
+    };
+} // namespace SPSP
@@ -0,0 +1,835 @@
+/**
+ * @file flat_wildcard_trie.hpp
+ * @author Dávid Benko (davidbenko@davidbenko.dev)
+ * @brief Arena-backed trie implementation with wildcard support
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "spsp/inline_stack.hpp"
+
+namespace SPSP
+{
+    /**
+     * @brief String-based trie with wildcard support and flat node storage
+     *
+     * Same interface and matching semantics as `WildcardTrie`, but
+     * made for large number of keys:
+     *
+     * - Nodes are stored in contiguous arena and referenced by index.
+     * - Each distinct level string is stored only once in token table,
+     *   nodes refer to it by token ID. Unused tokens are reclaimed.
+     * - Nodes with few children keep them in sorted inline array, larger
+     *   ones in sorted vector. No per-child heap allocation.
+     * - Lookups don't allocate level strings (levels of `find()`
+     *   key not present in token table can match only wildcards).
+     *
+     * References to values stay valid until the key is removed.
+     *
+     * @tparam TValue Type of value (must be default-constructible)
+     */
+    template <typename TValue>
+    class FlatWildcardTrie
+    {
+        using IndexT = uint32_t;
+        using TokenT = uint32_t;
+
+        static constexpr IndexT NONE = UINT32_MAX;  //!< Invalid index/token
+        static constexpr IndexT ROOT = 0;           //!< Index of root node
+        static constexpr size_t INLINE_CHILDS = 4;  //!< Max number of inline children
+
+        /**
+         * @brief Edge to child node
+         *
+         */
+        struct Edge
+        {
+            TokenT token;  //!< Level token
+            IndexT node;   //!< Child node index
+
+            bool operator<(const Edge& other) const noexcept
+            {
+                return token < other.token;
+            }
+        };
+
+        /**
+         * @brief Internal node of wildcard trie
+         *
+         * Children are sorted by token. Either inline (`childsCount` of
+         * `inlineChilds`) or, if there are more of them, in `m_bigChilds`
+         * at index `bigChilds`.
+         */
+        struct Node
+        {
+            Edge inlineChilds[INLINE_CHILDS];  //!< Inline children
+            IndexT bigChilds = NONE;           //!< Index of big children vector
+            IndexT value = NONE;               //!< Index of value (`NONE` if not leaf)
+            uint32_t childsCount = 0;          //!< Number of inline children
+        };
+
+        using BFSQueueT = std::queue<std::pair<std::string, IndexT>>;
+
+        //! Marks topic position past the last level
+        static constexpr size_t FIND_END = std::string_view::npos;
+
+        //! Depth of `findEach()` search without heap allocation
+        static constexpr size_t FIND_INLINE_DEPTH = 16;
+
+        /**
+         * @brief Next kind of child to visit in `findEach()`
+         *
+         */
+        enum FindStep : uint8_t
+        {
+            FIND_EXACT = 0,        //!< Child with same level
+            FIND_SINGLE_WILD = 1,  //!< Single-level wildcard child
+            FIND_MULTI_WILD = 2,   //!< Multi-level wildcard child
+            FIND_DONE = 3,         //!< Nothing to visit
+        };
+
+        /**
+         * @brief Node on `findEach()` search path
+         *
+         */
+        struct FindFrame
+        {
+            IndexT node = NONE;         //!< Node index
+            TokenT edge = NONE;         //!< Level token of `node`
+            TokenT levelToken = NONE;   //!< Token of topic level matched against children
+            size_t nextPos = FIND_END;  //!< Topic position of level after it
+            FindStep next = FIND_DONE;  //!< Next kind of child to visit
+        };
+
+        using FindStackT = InlineStack<FindFrame, FIND_INLINE_DEPTH>;
+
+        const std::string m_lSep;                              //!< Level separator
+        const std::string m_lSingleWild;                       //!< Single-level wildcard token
+        const std::string m_lMultiWild;                        //!< Multi-level wildcard token
+
+        std::vector<Node> m_nodes;                             //!< Node arena (root at `ROOT`)
+        std::vector<IndexT> m_freeNodes;                       //!< Unused node indices
+        std::vector<std::vector<Edge>> m_bigChilds;            //!< Children of nodes with many of them
+        std::vector<IndexT> m_freeBigChilds;                   //!< Unused `m_bigChilds` indices
+        std::deque<TValue> m_values;                           //!< Values (deque keeps references)
+        std::vector<IndexT> m_freeValues;                      //!< Unused value indices
+
+        std::deque<std::string> m_tokens;                      //!< Level strings by token
+        std::vector<uint32_t> m_tokenRefs;                     //!< Number of edges using token
+        std::unordered_map<std::string_view, TokenT> m_tokenIds;  //!< Token by level string
+        std::vector<TokenT> m_freeTokens;                      //!< Unused tokens
+
+        TokenT m_singleWildToken;                              //!< Token of single-level wildcard
+        TokenT m_multiWildToken;                               //!< Token of multi-level wildcard
+
+        uint64_t m_generation = 0;                             //!< Incremented when set of keys changes
+
+    public:
+        /**
+         * @brief Constructs a new object
+         *
+         * @param levelSeparator Level separator
+         * @param singleLevelWildcard Single-level wildcard token
+         * @param multiLevelWildcard Multi-level wildcard token
+         */
+        FlatWildcardTrie(const std::string& levelSeparator = "/",
+                         const std::string& singleLevelWildcard = "+",
+                         const std::string& multiLevelWildcard = "#")
+            : m_lSep{levelSeparator}, m_lSingleWild{singleLevelWildcard},
+              m_lMultiWild{multiLevelWildcard}
+        {
+            m_nodes.emplace_back();
+
+            // Wildcards are always interned (never released)
+            m_singleWildToken = this->internToken(m_lSingleWild);
+            m_multiWildToken = this->internToken(m_lMultiWild);
+        }
+
+        /**
+         * @brief Gets/inserts current value of `key`
+         *
+         * @param key Key
+         * @return Current value reference
+         */
+        TValue& operator[](const std::string& key)
+        {
+            IndexT cur = ROOT;
+            auto levels = this->splitToLevels(key);
+
+            // Get or create child on each level
+            for (size_t i = 0; i < levels.size(); i++) {
+                TokenT token = this->findToken(levels[i]);
+                IndexT child = token == NONE ? NONE
+                                             : this->findChild(cur, token);
+
+                // Create new child
+                if (child == NONE) {
+                    token = this->internToken(levels[i]);
+                    child = this->allocNode();
+                    this->addChild(cur, token, child);
+                }
+
+                // Move to next level
+                cur = child;
+            }
+
+            if (m_nodes[cur].value == NONE) {
+                m_nodes[cur].value = this->allocValue();
+                m_generation++;
+            }
+
+            return m_values[m_nodes[cur].value];
+        }
+
+        /**
+         * @brief Inserts (or updates) `key`-`value` pair
+         *
+         * @param key Key
+         * @param value Value
+         */
+        void insert(const std::string& key, const TValue& value)
+        {
+            (*this)[key] = value;
+        }
+
+        /**
+         * @brief Removes `key` from trie
+         *
+         * @param key Key
+         * @return true Node removed successfully
+         * @return false Node doesn't exist
+         */
+        bool remove(const std::string& key)
+        {
+            IndexT cur = ROOT;
+            auto levels = this->splitToLevels(key);
+
+            std::vector<std::pair<IndexT, TokenT>> nodeStack;
+
+            // Get node if exists
+            for (auto& level : levels) {
+                TokenT token = this->findToken(level);
+                IndexT child = token == NONE ? NONE
+                                             : this->findChild(cur, token);
+                if (child == NONE) {
+                    return false;
+                }
+
+                nodeStack.push_back({ cur, token });
+                cur = child;
+            }
+
+            // Can't remove non-leaf node
+            if (m_nodes[cur].value == NONE) {
+                return false;
+            }
+
+            this->freeValue(m_nodes[cur].value);
+            m_nodes[cur].value = NONE;
+            m_generation++;
+
+            if (this->childsCount(cur) == 0) {
+                // Delete all redundant ancestors
+                // There is `int` instead of `size_t`, because we need signed type.
+                for (int i = nodeStack.size() - 1; i >= 0; i--) {
+                    auto [node, token] = nodeStack[i];
+                    if (m_nodes[node].value != NONE ||
+                        this->childsCount(node) > 1 || node == ROOT) {
+                        this->removeChild(node, token);
+
+                        // Free detached chain (each has at most one child)
+                        for (size_t j = i + 1; j < nodeStack.size(); j++) {
+                            this->freeNode(nodeStack[j].first);
+                        }
+                        this->freeNode(cur);
+
+                        // Previous ancestors are no longer redundant
+                        break;
+                    }
+                }
+            }
+
+            return true;
+        }
+
+        using FindReturnT = std::unordered_map<std::string, const TValue&>;
+
+        /**
+         * @brief Item matched by `findEach()`
+         *
+         * Key of the item is built only when requested.
+         * Valid only during visitor call.
+         */
+        class Match
+        {
+            friend class FlatWildcardTrie;
+
+            const FlatWildcardTrie& m_trie;  //!< Trie
+            const FindStackT& m_stack;       //!< Search path
+            TokenT m_lastLevel;              //!< Level token after search path (`NONE` if none)
+
+            Match(const FlatWildcardTrie& trie, const FindStackT& stack,
+                  TokenT lastLevel, const TValue& value)
+                : m_trie{trie}, m_stack{stack}, m_lastLevel{lastLevel},
+                  value{value}
+            {}
+
+        public:
+            const TValue& value;  //!< Value
+
+            /**
+             * @brief Builds key of the item
+             *
+             * @return Key
+             */
+            std::string key() const
+            {
+                std::string key;
+
+                // Root has no level
+                for (size_t i = 1; i < m_stack.size(); i++) {
+                    if (i > 1) key += m_trie.m_lSep;
+                    key += m_trie.m_tokens[m_stack[i].edge];
+                }
+
+                if (m_lastLevel != NONE) {
+                    if (m_stack.size() > 1) key += m_trie.m_lSep;
+                    key += m_trie.m_tokens[m_lastLevel];
+                }
+
+                return key;
+            }
+        };
+
+        /**
+         * @brief Calls visitor for each item matching `topic`
+         *
+         * Depth-first search. Topic is tokenized lazily and search path
+         * is kept on fixed-capacity stack, so there's no heap allocation
+         * unless there are more than `FIND_INLINE_DEPTH` levels.
+         *
+         * Visitor takes `const Match&`. If it returns `bool`, `false`
+         * stops the search.
+         *
+         * @tparam F Visitor type
+         * @param topic Topic
+         * @param visitor Visitor
+         * @return true Search finished
+         * @return false Search was stopped by visitor
+         */
+        template <typename F>
+        bool findEach(std::string_view topic, F&& visitor) const
+        {
+            FindStackT stack;
+
+            auto visit = [&](IndexT valueIdx, TokenT lastLevel) {
+                Match match{*this, stack, lastLevel, m_values[valueIdx]};
+
+                if constexpr (std::is_void_v<std::invoke_result_t<F&, const Match&>>) {
+                    visitor(match);
+                    return true;
+                } else {
+                    return static_cast<bool>(visitor(match));
+                }
+            };
+
+            // Pushes node at topic position `pos`
+            auto push = [&](IndexT node, TokenT edge, size_t pos) {
+                FindFrame frame;
+                frame.node = node;
+                frame.edge = edge;
+
+                if (pos == FIND_END) {
+                    // All levels consumed
+                    stack.push(frame);
+                    return m_nodes[node].value == NONE ||
+                           visit(m_nodes[node].value, NONE);
+                }
+
+                // Levels unknown to token table can match only wildcards
+                size_t sepPos = topic.find(m_lSep, pos);
+                if (sepPos == std::string_view::npos) {
+                    frame.levelToken = this->findToken(topic.substr(pos));
+                } else {
+                    frame.levelToken = this->findToken(topic.substr(pos, sepPos - pos));
+                    frame.nextPos = sepPos + m_lSep.length();
+                }
+                frame.next = FIND_EXACT;
+
+                stack.push(frame);
+                return true;
+            };
+
+            if (!push(ROOT, NONE, 0)) {
+                return false;
+            }
+
+            while (!stack.empty()) {
+                // Push may invalidate the reference
+                FindFrame frame = stack.top();
+
+                if (frame.next == FIND_DONE) {
+                    stack.pop();
+                    continue;
+                }
+
+                stack.top().next = static_cast<FindStep>(frame.next + 1);
+
+                TokenT token = frame.levelToken;
+                IndexT child;
+
+                switch (frame.next) {
+                case FIND_EXACT:
+                    // Key matches
+                    if (token != NONE &&
+                        (child = this->findChild(frame.node, token)) != NONE &&
+                        !push(child, token, frame.nextPos)) {
+                        return false;
+                    }
+                    break;
+                case FIND_SINGLE_WILD:
+                    // Single-level wildcard
+                    if (token != m_singleWildToken &&
+                        (child = this->findChild(frame.node, m_singleWildToken)) != NONE &&
+                        !push(child, m_singleWildToken, frame.nextPos)) {
+                        return false;
+                    }
+                    break;
+                case FIND_MULTI_WILD:
+                    // Multi-level wildcard
+                    if (token != m_multiWildToken &&
+                        (child = this->findChild(frame.node, m_multiWildToken)) != NONE &&
+                        m_nodes[child].value != NONE &&
+                        !visit(m_nodes[child].value, m_multiWildToken)) {
+                        return false;
+                    }
+                    break;
+                default:
+                    break;
+                }
+            }
+
+            return true;
+        }
+
+        /**
+         * @brief Finds `key` in trie
+         *
+         * @param key Key
+         * @return Vector of values from matching keys (empty if not found)
+         */
+        const FindReturnT find(const std::string& key) const
+        {
+            FindReturnT values;
+
+            this->findEach(key, [&values](const Match& match) {
+                values.insert({ match.key(), match.value });
+            });
+
+            return values;
+        }
+
+        /**
+         * @brief Checks whether any item matches `topic`
+         *
+         * Stops on first match.
+         *
+         * @param topic Topic
+         * @return true There's a matching item
+         * @return false There's no matching item
+         */
+        bool matchesAny(std::string_view topic) const
+        {
+            return !this->findEach(topic, [](const Match&) { return false; });
+        }
+
+        /**
+         * @brief Counts items matching `topic`
+         *
+         * @param topic Topic
+         * @return Number of matching items
+         */
+        size_t countMatches(std::string_view topic) const
+        {
+            size_t count = 0;
+            this->findEach(topic, [&count](const Match&) { count++; });
+            return count;
+        }
+
+        /**
+         * @brief Iterates through each item in trie and calls callback
+         *        on each one
+         *
+         * Callback may modify values of existing keys (using `operator[]`).
+         *
+         * @param f Function to call
+         */
+        void forEach(std::function<void(const std::string& key, const TValue& value)> f)
+        {
+            // Queue for to-be-processed nodes
+            BFSQueueT nodeQueue;
+            nodeQueue.push({ "", ROOT });
+
+            while (!nodeQueue.empty()) {
+                auto& [nodeKey, nodeIdx] = nodeQueue.front();
+
+                // Call function
+                if (m_nodes[nodeIdx].value != NONE) {
+                    f(nodeKey, m_values[m_nodes[nodeIdx].value]);
+                }
+
+                // Enqueue children
+                const Edge* childs = this->childs(nodeIdx);
+                size_t count = this->childsCount(nodeIdx);
+                for (size_t i = 0; i < count; i++) {
+                    nodeQueue.push({ this->childKey(nodeKey, nodeIdx, childs[i].token),
+                                     childs[i].node });
+                }
+
+                nodeQueue.pop();
+            }
+        }
+
+        /**
+         * @brief Empty predicate
+         *
+         * @return true Trie is empty
+         * @return false Trie is not empty
+         */
+        bool empty() const
+        {
+            return this->childsCount(ROOT) == 0;
+        }
+
+        /**
+         * @brief Gets generation of set of keys
+         *
+         * Changes whenever a key is added or removed (not when value
+         * changes). Allows caching data derived from keys, i.e.
+         * `FrozenWildcardTrie` with pointers to values.
+         *
+         * @return Generation
+         */
+        uint64_t generation() const
+        {
+            return m_generation;
+        }
+
+    protected:
+        /**
+         * @brief Splits `key` to levels
+         *
+         * There's no validation of `key`.
+         *
+         * @param key Key
+         * @return Vector of levels (views into `key`)
+         */
+        std::vector<std::string_view> splitToLevels(const std::string& key) const
+        {
+            std::string_view keyView = key;
+            size_t curPos = 0, nextPos;
+            std::vector<std::string_view> levels;
+
+            while ((nextPos = keyView.find(m_lSep, curPos)) != std::string_view::npos) {
+                levels.push_back(keyView.substr(curPos, nextPos - curPos));
+                curPos = nextPos + m_lSep.length();
+            }
+
+            // Add the rest
+            levels.push_back(keyView.substr(curPos));
+
+            return levels;
+        }
+
+    private:
+        /**
+         * @brief Builds key of child
+         *
+         * @param nodeKey Key of parent
+         * @param nodeIdx Index of parent
+         * @param token Level token of child
+         * @return Child key
+         */
+        std::string childKey(const std::string& nodeKey, IndexT nodeIdx,
+                             TokenT token) const
+        {
+            const std::string& level = m_tokens[token];
+            return nodeIdx == ROOT ? level : nodeKey + m_lSep + level;
+        }
+
+        /**
+         * @brief Finds token of level string
+         *
+         * @param level Level string
+         * @return Token or `NONE` if not present
+         */
+        TokenT findToken(std::string_view level) const
+        {
+            auto it = m_tokenIds.find(level);
+            return it == m_tokenIds.end() ? NONE : it->second;
+        }
+
+        /**
+         * @brief Gets token of level string, adds it if not present
+         *
+         * Increments reference count of the token.
+         *
+         * @param level Level string
+         * @return Token
+         */
+        TokenT internToken(std::string_view level)
+        {
+            TokenT token = this->findToken(level);
+
+            if (token == NONE) {
+                if (!m_freeTokens.empty()) {
+                    token = m_freeTokens.back();
+                    m_freeTokens.pop_back();
+                    m_tokens[token] = level;
+                } else {
+                    token = m_tokens.size();
+                    m_tokens.emplace_back(level);
+                    m_tokenRefs.push_back(0);
+                }
+
+                // Key views string in `m_tokens` (deque doesn't move it)
+                m_tokenIds[m_tokens[token]] = token;
+            }
+
+            m_tokenRefs[token]++;
+            return token;
+        }
+
+        /**
+         * @brief Decrements reference count of token, releases it if unused
+         *
+         * @param token Token
+         */
+        void releaseToken(TokenT token)
+        {
+            if (--m_tokenRefs[token] > 0) {
+                return;
+            }
+
+            m_tokenIds.erase(m_tokens[token]);
+            m_tokens[token].clear();
+            m_tokens[token].shrink_to_fit();
+            m_freeTokens.push_back(token);
+        }
+
+        /**
+         * @brief Allocates empty node
+         *
+         * @return Node index
+         */
+        IndexT allocNode()
+        {
+            if (!m_freeNodes.empty()) {
+                IndexT idx = m_freeNodes.back();
+                m_freeNodes.pop_back();
+                m_nodes[idx] = Node{};
+                return idx;
+            }
+
+            m_nodes.emplace_back();
+            return m_nodes.size() - 1;
+        }
+
+        /**
+         * @brief Frees node (must have no value and at most one child)
+         *
+         * Children are not freed, but token of the edge is released.
+         *
+         * @param idx Node index
+         */
+        void freeNode(IndexT idx)
+        {
+            if (this->childsCount(idx) > 0) {
+                this->releaseToken(this->childs(idx)[0].token);
+            }
+
+            if (m_nodes[idx].bigChilds != NONE) {
+                this->freeBigChilds(m_nodes[idx].bigChilds);
+            }
+
+            m_nodes[idx] = Node{};
+            m_freeNodes.push_back(idx);
+        }
+
+        /**
+         * @brief Allocates default-constructed value
+         *
+         * @return Value index
+         */
+        IndexT allocValue()
+        {
+            if (!m_freeValues.empty()) {
+                IndexT idx = m_freeValues.back();
+                m_freeValues.pop_back();
+                return idx;
+            }
+
+            m_values.emplace_back();
+            return m_values.size() - 1;
+        }
+
+        /**
+         * @brief Frees value (resets it to default)
+         *
+         * @param idx Value index
+         */
+        void freeValue(IndexT idx)
+        {
+            m_values[idx] = TValue{};
+            m_freeValues.push_back(idx);
+        }
+
+        /**
+         * @brief Frees big children vector
+         *
+         * @param idx Index in `m_bigChilds`
+         */
+        void freeBigChilds(IndexT idx)
+        {
+            m_bigChilds[idx].clear();
+            m_bigChilds[idx].shrink_to_fit();
+            m_freeBigChilds.push_back(idx);
+        }
+
+        /**
+         * @brief Gets sorted children of node
+         *
+         * @param idx Node index
+         * @return Pointer to first child edge
+         */
+        const Edge* childs(IndexT idx) const
+        {
+            const Node& node = m_nodes[idx];
+            return node.bigChilds == NONE ? node.inlineChilds
+                                          : m_bigChilds[node.bigChilds].data();
+        }
+
+        /**
+         * @brief Gets number of children of node
+         *
+         * @param idx Node index
+         * @return Number of children
+         */
+        size_t childsCount(IndexT idx) const
+        {
+            const Node& node = m_nodes[idx];
+            return node.bigChilds == NONE ? node.childsCount
+                                          : m_bigChilds[node.bigChilds].size();
+        }
+
+        /**
+         * @brief Finds child of node by token
+         *
+         * @param idx Node index
+         * @param token Level token
+         * @return Child node index or `NONE` if not present
+         */
+        IndexT findChild(IndexT idx, TokenT token) const
+        {
+            const Edge* first = this->childs(idx);
+            const Edge* last = first + this->childsCount(idx);
+
+            auto it = std::lower_bound(first, last, Edge{ token, NONE });
+            return it != last && it->token == token ? it->node : NONE;
+        }
+
+        /**
+         * @brief Adds child to node (must not be present)
+         *
+         * Moves children from inline array to big children vector when
+         * inline array is full.
+         *
+         * @param idx Node index
+         * @param token Level token
+         * @param child Child node index
+         */
+        void addChild(IndexT idx, TokenT token, IndexT child)
+        {
+            const Edge edge{ token, child };
+            Node& node = m_nodes[idx];
+
+            if (node.bigChilds == NONE && node.childsCount < INLINE_CHILDS) {
+                Edge* first = node.inlineChilds;
+                Edge* last = first + node.childsCount;
+                Edge* pos = std::upper_bound(first, last, edge);
+                std::move_backward(pos, last, last + 1);
+                *pos = edge;
+                node.childsCount++;
+                return;
+            }
+
+            if (node.bigChilds == NONE) {
+                IndexT big;
+                if (!m_freeBigChilds.empty()) {
+                    big = m_freeBigChilds.back();
+                    m_freeBigChilds.pop_back();
+                } else {
+                    big = m_bigChilds.size();
+                    m_bigChilds.emplace_back();
+                }
+
+                m_bigChilds[big].assign(node.inlineChilds,
+                                        node.inlineChilds + node.childsCount);
+                node.bigChilds = big;
+                node.childsCount = 0;
+            }
+
+            auto& vec = m_bigChilds[node.bigChilds];
+            vec.insert(std::upper_bound(vec.begin(), vec.end(), edge), edge);
+        }
+
+        /**
+         * @brief Removes child of node and releases its token
+         *
+         * Moves children back to inline array when they fit there.
+         * Child node itself is not freed.
+         *
+         * @param idx Node index
+         * @param token Level token
+         */
+        void removeChild(IndexT idx, TokenT token)
+        {
+            Node& node = m_nodes[idx];
+
+            if (node.bigChilds == NONE) {
+                Edge* first = node.inlineChilds;
+                Edge* last = first + node.childsCount;
+                Edge* pos = std::lower_bound(first, last, Edge{ token, NONE });
+                std::move(pos + 1, last, pos);
+                node.childsCount--;
+            } else {
+                auto& vec = m_bigChilds[node.bigChilds];
+                vec.erase(std::lower_bound(vec.begin(), vec.end(),
+                                           Edge{ token, NONE }));
+
+                if (vec.size() <= INLINE_CHILDS) {
+                    std::copy(vec.begin(), vec.end(), node.inlineChilds);
+                    node.childsCount = vec.size();
+                    this->freeBigChilds(node.bigChilds);
+                    node.bigChilds = NONE;
+                }
+            }
+
+            this->releaseToken(token);
+        }
+    };
+} // namespace SPSP
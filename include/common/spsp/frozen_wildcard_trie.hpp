@@ -0,0 +1,624 @@
+/**
+ * @file frozen_wildcard_trie.hpp
+ * @author Dávid Benko (davidbenko@davidbenko.dev)
+ * @brief Immutable wildcard matcher compiled from trie items
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "spsp/inline_stack.hpp"
+
+namespace SPSP
+{
+    /**
+     * @brief Immutable ("frozen") form of wildcard trie
+     *
+     * Same matching semantics as `WildcardTrie::findEach()`, but built
+     * once from all items and optimized for matching:
+     *
+     * - States are stored in single array.
+     * - All exact-level transitions are in single open-addressing hash
+     *   table indexed by (state, level), so each topic level costs one
+     *   hash lookup regardless of number of children.
+     * - Wildcard transitions are precomputed in each state.
+     * - Level strings are stored in single buffer.
+     * - Items with exact (wildcard-free) keys are only in separate hash
+     *   table of whole keys, so they cost single lookup and states
+     *   contain only wildcard keys.
+     *
+     * Match cost depends on topic depth and number of wildcard branches
+     * that actually match, not on number of items.
+     *
+     * It can't be modified. When items change, new one is built
+     * (copy-on-write) - it's intended for data that is matched much more
+     * often than changed.
+     *
+     * @tparam TValue Type of value
+     */
+    template <typename TValue>
+    class FrozenWildcardTrie
+    {
+        using IndexT = uint32_t;
+
+        static constexpr IndexT NONE = UINT32_MAX;  //!< Invalid index
+        static constexpr IndexT ROOT = 0;           //!< Index of root state
+
+        //! Marks topic position past the last level
+        static constexpr size_t FIND_END = std::string_view::npos;
+
+        //! Depth of `findEach()` search without heap allocation
+        static constexpr size_t FIND_INLINE_DEPTH = 16;
+
+        /**
+         * @brief State of matcher (trie node)
+         *
+         */
+        struct State
+        {
+            IndexT singleWild = NONE;  //!< State after single-level wildcard
+            IndexT multiWild = NONE;   //!< State after multi-level wildcard
+            IndexT value = NONE;       //!< Index of value (`NONE` if not leaf)
+        };
+
+        /**
+         * @brief Exact-level transition
+         *
+         */
+        struct Edge
+        {
+            uint64_t hash;      //!< Hash of (`parent`, level)
+            IndexT parent;      //!< Source state
+            IndexT child;       //!< Target state
+            uint32_t levelPos;  //!< Position of level in `m_levels`
+            uint32_t levelLen;  //!< Length of level
+        };
+
+        /**
+         * @brief Next kind of transition to follow in `findEach()`
+         *
+         */
+        enum FindStep : uint8_t
+        {
+            FIND_EXACT = 0,        //!< Transition with same level
+            FIND_SINGLE_WILD = 1,  //!< Single-level wildcard transition
+            FIND_MULTI_WILD = 2,   //!< Multi-level wildcard transition
+            FIND_DONE = 3,         //!< Nothing to follow
+        };
+
+        /**
+         * @brief State on `findEach()` search path
+         *
+         */
+        struct FindFrame
+        {
+            IndexT state = NONE;        //!< State
+            std::string_view level;     //!< Topic level to follow
+            size_t nextPos = FIND_END;  //!< Topic position of level after `level`
+            FindStep next = FIND_DONE;  //!< Next kind of transition to follow
+        };
+
+        using FindStackT = InlineStack<FindFrame, FIND_INLINE_DEPTH>;
+
+        std::string m_lSep;                //!< Level separator
+        std::string m_lSingleWild;         //!< Single-level wildcard token
+        std::string m_lMultiWild;          //!< Multi-level wildcard token
+
+        std::vector<State> m_states;       //!< States (root at `ROOT`)
+        std::vector<Edge> m_edges;         //!< Exact-level transitions
+        std::vector<IndexT> m_edgeTable;   //!< Hash table of `m_edges` indices
+        std::vector<IndexT> m_exactTable;  //!< Hash table of exact keys' value indices
+        std::string m_levels;              //!< Level strings of all edges
+        std::vector<TValue> m_values;      //!< Values
+        std::vector<std::string> m_keys;   //!< Keys of values
+        size_t m_exactCount = 0;           //!< Number of items with exact key
+
+    public:
+        using FindReturnT = std::unordered_map<std::string, const TValue&>;
+        using ItemsT = std::vector<std::pair<std::string, TValue>>;
+
+        /**
+         * @brief Item matched by `findEach()`
+         *
+         */
+        class Match
+        {
+            friend class FrozenWildcardTrie;
+
+            const std::string& m_key;  //!< Key
+
+            Match(const std::string& key, const TValue& value)
+                : m_key{key}, value{value}
+            {}
+
+        public:
+            const TValue& value;  //!< Value
+
+            /**
+             * @brief Gets key of the item
+             *
+             * @return Key
+             */
+            const std::string& key() const
+            {
+                return m_key;
+            }
+        };
+
+        /**
+         * @brief Constructs a new empty object
+         *
+         * @param levelSeparator Level separator
+         * @param singleLevelWildcard Single-level wildcard token
+         * @param multiLevelWildcard Multi-level wildcard token
+         */
+        FrozenWildcardTrie(const std::string& levelSeparator = "/",
+                           const std::string& singleLevelWildcard = "+",
+                           const std::string& multiLevelWildcard = "#")
+            : FrozenWildcardTrie{ItemsT{}, levelSeparator,
+                                 singleLevelWildcard, multiLevelWildcard}
+        {}
+
+        /**
+         * @brief Constructs a new object from items
+         *
+         * If key is present multiple times, the last value is used.
+         *
+         * @param items Key-value pairs
+         * @param levelSeparator Level separator
+         * @param singleLevelWildcard Single-level wildcard token
+         * @param multiLevelWildcard Multi-level wildcard token
+         */
+        FrozenWildcardTrie(const ItemsT& items,
+                           const std::string& levelSeparator = "/",
+                           const std::string& singleLevelWildcard = "+",
+                           const std::string& multiLevelWildcard = "#")
+            : m_lSep{levelSeparator}, m_lSingleWild{singleLevelWildcard},
+              m_lMultiWild{multiLevelWildcard}
+        {
+            m_states.emplace_back();
+            m_edgeTable.assign(16, NONE);
+            m_exactTable.assign(16, NONE);
+
+            for (auto& [key, value] : items) {
+                if (this->hasWildcard(key)) {
+                    this->add(key, value);
+                } else {
+                    this->addExact(key, value);
+                }
+            }
+
+            m_states.shrink_to_fit();
+            m_edges.shrink_to_fit();
+            m_levels.shrink_to_fit();
+            m_values.shrink_to_fit();
+            m_keys.shrink_to_fit();
+        }
+
+        /**
+         * @brief Calls visitor for each item matching `topic`
+         *
+         * Same as `WildcardTrie::findEach()`.
+         *
+         * @tparam F Visitor type
+         * @param topic Topic
+         * @param visitor Visitor
+         * @return true Search finished
+         * @return false Search was stopped by visitor
+         */
+        template <typename F>
+        bool findEach(std::string_view topic, F&& visitor) const
+        {
+            FindStackT stack;
+
+            auto visit = [&](IndexT valueIdx) {
+                Match match{m_keys[valueIdx], m_values[valueIdx]};
+
+                if constexpr (std::is_void_v<std::invoke_result_t<F&, const Match&>>) {
+                    visitor(match);
+                    return true;
+                } else {
+                    return static_cast<bool>(visitor(match));
+                }
+            };
+
+            // Pushes state at topic position `pos`
+            auto push = [&](IndexT state, size_t pos) {
+                if (pos == FIND_END) {
+                    // All levels consumed
+                    return m_states[state].value == NONE ||
+                           visit(m_states[state].value);
+                }
+
+                FindFrame frame;
+                frame.state = state;
+
+                size_t sepPos = topic.find(m_lSep, pos);
+                if (sepPos == std::string_view::npos) {
+                    frame.level = topic.substr(pos);
+                } else {
+                    frame.level = topic.substr(pos, sepPos - pos);
+                    frame.nextPos = sepPos + m_lSep.length();
+                }
+                frame.next = FIND_EXACT;
+
+                stack.push(frame);
+                return true;
+            };
+
+            // Exact key
+            IndexT exactIdx = this->findExact(topic);
+            if (exactIdx != NONE && !visit(exactIdx)) {
+                return false;
+            }
+
+            if (m_edges.empty()) {
+                return true;
+            }
+
+            if (!push(ROOT, 0)) {
+                return false;
+            }
+
+            while (!stack.empty()) {
+                // Push may invalidate the reference
+                FindFrame frame = stack.top();
+
+                if (frame.next == FIND_DONE) {
+                    stack.pop();
+                    continue;
+                }
+
+                stack.top().next = static_cast<FindStep>(frame.next + 1);
+
+                const State& state = m_states[frame.state];
+                IndexT child;
+
+                switch (frame.next) {
+                case FIND_EXACT:
+                    // Key matches
+                    if ((child = this->findEdge(frame.state, frame.level)) != NONE &&
+                        !push(child, frame.nextPos)) {
+                        return false;
+                    }
+                    break;
+                case FIND_SINGLE_WILD:
+                    // Single-level wildcard
+                    if (state.singleWild != NONE && frame.level != m_lSingleWild &&
+                        !push(state.singleWild, frame.nextPos)) {
+                        return false;
+                    }
+                    break;
+                case FIND_MULTI_WILD:
+                    // Multi-level wildcard
+                    if (state.multiWild != NONE && frame.level != m_lMultiWild &&
+                        m_states[state.multiWild].value != NONE &&
+                        !visit(m_states[state.multiWild].value)) {
+                        return false;
+                    }
+                    break;
+                default:
+                    break;
+                }
+            }
+
+            return true;
+        }
+
+        /**
+         * @brief Finds `key` in trie
+         *
+         * @param key Key
+         * @return Vector of values from matching keys (empty if not found)
+         */
+        const FindReturnT find(const std::string& key) const
+        {
+            FindReturnT values;
+
+            this->findEach(key, [&values](const Match& match) {
+                values.insert({ match.key(), match.value });
+            });
+
+            return values;
+        }
+
+        /**
+         * @brief Checks whether any item matches `topic`
+         *
+         * Stops on first match.
+         *
+         * @param topic Topic
+         * @return true There's a matching item
+         * @return false There's no matching item
+         */
+        bool matchesAny(std::string_view topic) const
+        {
+            return !this->findEach(topic, [](const Match&) { return false; });
+        }
+
+        /**
+         * @brief Counts items matching `topic`
+         *
+         * @param topic Topic
+         * @return Number of matching items
+         */
+        size_t countMatches(std::string_view topic) const
+        {
+            size_t count = 0;
+            this->findEach(topic, [&count](const Match&) { count++; });
+            return count;
+        }
+
+        /**
+         * @brief Gets number of items
+         *
+         * @return Number of items
+         */
+        size_t size() const
+        {
+            return m_values.size();
+        }
+
+        /**
+         * @brief Empty predicate
+         *
+         * @return true Trie is empty
+         * @return false Trie is not empty
+         */
+        bool empty() const
+        {
+            return m_values.empty();
+        }
+
+    private:
+        /**
+         * @brief Hashes exact-level transition or exact key
+         *
+         * FNV-1a of string seeded with parent state.
+         *
+         * @param parent Source state (`NONE` for exact key)
+         * @param level Level or exact key
+         * @return Hash
+         */
+        static uint64_t hashString(IndexT parent, std::string_view level)
+        {
+            uint64_t hash = 14695981039346656037ULL ^ parent;
+            for (char c : level) {
+                hash ^= static_cast<uint8_t>(c);
+                hash *= 1099511628211ULL;
+            }
+            return hash;
+        }
+
+        /**
+         * @brief Gets level string of transition
+         *
+         * @param edge Transition
+         * @return Level
+         */
+        std::string_view edgeLevel(const Edge& edge) const
+        {
+            return std::string_view{m_levels}.substr(edge.levelPos, edge.levelLen);
+        }
+
+        /**
+         * @brief Finds exact-level transition
+         *
+         * @param parent Source state
+         * @param level Level
+         * @return Target state or `NONE` if not present
+         */
+        IndexT findEdge(IndexT parent, std::string_view level) const
+        {
+            uint64_t hash = hashString(parent, level);
+            size_t mask = m_edgeTable.size() - 1;
+
+            for (size_t i = hash & mask; ; i = (i + 1) & mask) {
+                IndexT edgeIdx = m_edgeTable[i];
+                if (edgeIdx == NONE) {
+                    return NONE;
+                }
+
+                const Edge& edge = m_edges[edgeIdx];
+                if (edge.hash == hash && edge.parent == parent &&
+                    this->edgeLevel(edge) == level) {
+                    return edge.child;
+                }
+            }
+        }
+
+        /**
+         * @brief Inserts edge index into hash table
+         *
+         * @param edgeIdx Index in `m_edges`
+         */
+        void tableInsert(IndexT edgeIdx)
+        {
+            size_t mask = m_edgeTable.size() - 1;
+            size_t i = m_edges[edgeIdx].hash & mask;
+
+            while (m_edgeTable[i] != NONE) {
+                i = (i + 1) & mask;
+            }
+            m_edgeTable[i] = edgeIdx;
+        }
+
+        /**
+         * @brief Adds exact-level transition to new state
+         *
+         * @param parent Source state
+         * @param level Level
+         * @return New state
+         */
+        IndexT addEdge(IndexT parent, std::string_view level)
+        {
+            IndexT child = m_states.size();
+            m_states.emplace_back();
+
+            m_edges.push_back(Edge{ hashString(parent, level), parent, child,
+                                    static_cast<uint32_t>(m_levels.size()),
+                                    static_cast<uint32_t>(level.size()) });
+            m_levels += level;
+
+            // Keep load factor at most 1/2
+            if (m_edges.size() * 2 > m_edgeTable.size()) {
+                m_edgeTable.assign(m_edgeTable.size() * 2, NONE);
+                for (IndexT i = 0; i < m_edges.size(); i++) {
+                    this->tableInsert(i);
+                }
+            } else {
+                this->tableInsert(m_edges.size() - 1);
+            }
+
+            // Precompute wildcard transitions
+            if (level == m_lSingleWild) {
+                m_states[parent].singleWild = child;
+            } else if (level == m_lMultiWild) {
+                m_states[parent].multiWild = child;
+            }
+
+            return child;
+        }
+
+        /**
+         * @brief Checks whether any level of `key` is wildcard
+         *
+         * @param key Key
+         * @return true Key has wildcard level
+         * @return false Key is exact
+         */
+        bool hasWildcard(std::string_view key) const
+        {
+            size_t curPos = 0, nextPos;
+
+            while (true) {
+                nextPos = key.find(m_lSep, curPos);
+                auto level = key.substr(curPos, nextPos == std::string_view::npos
+                                                ? std::string_view::npos
+                                                : nextPos - curPos);
+
+                if (level == m_lSingleWild || level == m_lMultiWild) {
+                    return true;
+                }
+
+                if (nextPos == std::string_view::npos) {
+                    return false;
+                }
+                curPos = nextPos + m_lSep.length();
+            }
+        }
+
+        /**
+         * @brief Finds item with exact key
+         *
+         * @param key Key
+         * @return Value index or `NONE` if not present
+         */
+        IndexT findExact(std::string_view key) const
+        {
+            size_t mask = m_exactTable.size() - 1;
+
+            for (size_t i = hashString(NONE, key) & mask; ; i = (i + 1) & mask) {
+                IndexT valueIdx = m_exactTable[i];
+                if (valueIdx == NONE || m_keys[valueIdx] == key) {
+                    return valueIdx;
+                }
+            }
+        }
+
+        /**
+         * @brief Inserts value index of exact key into hash table
+         *
+         * @param valueIdx Value index
+         */
+        void exactTableInsert(IndexT valueIdx)
+        {
+            size_t mask = m_exactTable.size() - 1;
+            size_t i = hashString(NONE, m_keys[valueIdx]) & mask;
+
+            while (m_exactTable[i] != NONE) {
+                i = (i + 1) & mask;
+            }
+            m_exactTable[i] = valueIdx;
+        }
+
+        /**
+         * @brief Adds item with exact key
+         *
+         * @param key Key
+         * @param value Value
+         */
+        void addExact(const std::string& key, const TValue& value)
+        {
+            IndexT valueIdx = this->findExact(key);
+            if (valueIdx != NONE) {
+                m_values[valueIdx] = value;
+                return;
+            }
+
+            m_values.push_back(value);
+            m_keys.push_back(key);
+            m_exactCount++;
+
+            // Keep load factor at most 1/2
+            if (m_exactCount * 2 > m_exactTable.size()) {
+                auto oldTable = std::move(m_exactTable);
+                m_exactTable.assign(oldTable.size() * 2, NONE);
+                for (IndexT oldIdx : oldTable) {
+                    if (oldIdx != NONE) {
+                        this->exactTableInsert(oldIdx);
+                    }
+                }
+                this->exactTableInsert(m_keys.size() - 1);
+            } else {
+                this->exactTableInsert(m_keys.size() - 1);
+            }
+        }
+
+        /**
+         * @brief Adds item with wildcard key
+         *
+         * @param key Key
+         * @param value Value
+         */
+        void add(const std::string& key, const TValue& value)
+        {
+            std::string_view keyView = key;
+            IndexT cur = ROOT;
+            size_t curPos = 0;
+
+            while (true) {
+                size_t nextPos = keyView.find(m_lSep, curPos);
+                auto level = keyView.substr(curPos, nextPos == std::string_view::npos
+                                                    ? std::string_view::npos
+                                                    : nextPos - curPos);
+
+                IndexT child = this->findEdge(cur, level);
+                cur = child != NONE ? child : this->addEdge(cur, level);
+
+                if (nextPos == std::string_view::npos) {
+                    break;
+                }
+                curPos = nextPos + m_lSep.length();
+            }
+
+            if (m_states[cur].value == NONE) {
+                m_states[cur].value = m_values.size();
+                m_values.push_back(value);
+                m_keys.push_back(key);
+            } else {
+                m_values[m_states[cur].value] = value;
+            }
+        }
+    };
+} // namespace SPSP
@@ -0,0 +1,118 @@
+/**
+ * @file inline_stack.hpp
+ * @author Dávid Benko (davidbenko@davidbenko.dev)
+ * @brief Stack with inline storage
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace SPSP
+{
+    /**
+     * @brief Stack with fixed-capacity inline storage
+     *
+     * First `N` items are stored inside the object, so there's no heap
+     * allocation unless the stack grows deeper. Items above that
+     * are stored in heap vector.
+     *
+     * @tparam T Type of item (must be default-constructible)
+     * @tparam N Inline capacity
+     */
+    template <typename T, size_t N>
+    class InlineStack
+    {
+        std::array<T, N> m_inline;  //!< First `N` items
+        std::vector<T> m_overflow;  //!< Items above `N`
+        size_t m_size = 0;          //!< Number of items
+
+    public:
+        /**
+         * @brief Pushes item on top
+         *
+         * References to items above `N` may be invalidated.
+         *
+         * @param item Item
+         */
+        void push(const T& item)
+        {
+            if (m_size < N) {
+                m_inline[m_size] = item;
+            } else {
+                m_overflow.push_back(item);
+            }
+            m_size++;
+        }
+
+        /**
+         * @brief Removes top item
+         *
+         */
+        void pop()
+        {
+            m_size--;
+            if (m_size >= N) {
+                m_overflow.pop_back();
+            }
+        }
+
+        /**
+         * @brief Gets top item
+         *
+         * @return Top item
+         */
+        T& top()
+        {
+            return (*this)[m_size - 1];
+        }
+
+        /**
+         * @brief Gets item at `index` (0 is bottom)
+         *
+         * @param index Index
+         * @return Item
+         */
+        T& operator[](size_t index)
+        {
+            return index < N ? m_inline[index] : m_overflow[index - N];
+        }
+
+        /**
+         * @brief Gets item at `index` (0 is bottom)
+         *
+         * @param index Index
+         * @return Item
+         */
+        const T& operator[](size_t index) const
+        {
+            return index < N ? m_inline[index] : m_overflow[index - N];
+        }
+
+        /**
+         * @brief Gets number of items
+         *
+         * @return Number of items
+         */
+        size_t size() const
+        {
+            return m_size;
+        }
+
+        /**
+         * @brief Empty predicate
+         *
+         * @return true Stack is empty
+         * @return false Stack is not empty
+         */
+        bool empty() const
+        {
+            return m_size == 0;
+        }
+    };
+} // namespace SPSP
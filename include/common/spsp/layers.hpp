@@ -9,6 +9,12 @@
 
 #pragma once
 
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "spsp/local_message.hpp"
 
 namespace SPSP
@@ -17,6 +23,46 @@ namespace SPSP
     template <typename TLocalLayer> class ILocalNode;
     template <typename TFarLayer> class IFarNode;
 
+    /**
+     * @brief Completion callback of asynchronous far layer operation
+     *
+     * @param success Whether operation was successful
+     */
+    using FarLayerDoneCb = std::function<void(bool success)>;
+
+    /**
+     * @brief Runs asynchronous operation on each topic and joins results
+     *
+     * Operations are started at once (without waiting for each other).
+     *
+     * @tparam F Operation type (`void(const std::string& topic, FarLayerDoneCb cb)`)
+     * @param topics Topics
+     * @param op Operation
+     * @param cb Called when all operations complete (successful if all were)
+     */
+    template <typename F>
+    void joinAsync(const std::vector<std::string>& topics, F op, FarLayerDoneCb cb)
+    {
+        if (topics.empty()) {
+            cb(true);
+            return;
+        }
+
+        auto remaining = std::make_shared<std::atomic<size_t>>(topics.size());
+        auto success = std::make_shared<std::atomic<bool>>(true);
+
+        for (auto& topic : topics) {
+            op(topic, [cb, remaining, success](bool opSuccess) {
+                if (!opSuccess) {
+                    *success = false;
+                }
+                if (--*remaining == 0) {
+                    cb(*success);
+                }
+            });
+        }
+    }
+
     /**
      * @brief Interface for local layer
      *
@@ -141,6 +187,24 @@ namespace SPSP
          */
         virtual bool subscribe(const std::string& topic) = 0;
 
+        /**
+         * @brief Subscribes to given topic without waiting for result
+         *
+         * Should be used by `INode` only!
+         *
+         * Callback is called exactly once, when subscription is confirmed
+         * or refused. It may be called from any context, even before
+         * this returns, so caller must not hold any lock callback needs.
+         * Default implementation blocks in `subscribe()`.
+         *
+         * @param topic Topic
+         * @param cb Completion callback
+         */
+        virtual void subscribeAsync(const std::string& topic, FarLayerDoneCb cb)
+        {
+            cb(this->subscribe(topic));
+        }
+
          /**
          * @brief Unsubscribes from given topic
          *
@@ -151,5 +215,60 @@ namespace SPSP
          * @return false Unsubscribe failed
          */
         virtual bool unsubscribe(const std::string& topic) = 0;
+
+        /**
+         * @brief Unsubscribes from given topic without waiting for result
+         *
+         * Should be used by `INode` only!
+         *
+         * Same rules as for `subscribeAsync()` apply.
+         * Default implementation blocks in `unsubscribe()`.
+         *
+         * @param topic Topic
+         * @param cb Completion callback
+         */
+        virtual void unsubscribeAsync(const std::string& topic, FarLayerDoneCb cb)
+        {
+            cb(this->unsubscribe(topic));
+        }
+
+        /**
+         * @brief Subscribes to many topics without waiting for result
+         *
+         * Should be used by `INode` only!
+         *
+         * Same rules as for `subscribeAsync()` apply. Callback is called
+         * once for all topics (successful if all subscribes were).
+         * Default implementation calls `subscribeAsync()` on each topic.
+         *
+         * @param topics Topics
+         * @param cb Completion callback
+         */
+        virtual void subscribeManyAsync(const std::vector<std::string>& topics,
+                                        FarLayerDoneCb cb)
+        {
+            joinAsync(topics, [this](const std::string& topic, FarLayerDoneCb topicCb) {
+                this->subscribeAsync(topic, topicCb);
+            }, cb);
+        }
+
+        /**
+         * @brief Unsubscribes from many topics without waiting for result
+         *
+         * Should be used by `INode` only!
+         *
+         * Same rules as for `subscribeManyAsync()` apply.
+         * Default implementation calls `unsubscribeAsync()` on each topic.
+         *
+         * @param topics Topics
+         * @param cb Completion callback
+         */
+        virtual void unsubscribeManyAsync(const std::vector<std::string>& topics,
+                                          FarLayerDoneCb cb)
+        {
+            joinAsync(topics, [this](const std::string& topic, FarLayerDoneCb topicCb) {
+                this->unsubscribeAsync(topic, topicCb);
+            }, cb);
+        }
     };
 } // namespace SPSP
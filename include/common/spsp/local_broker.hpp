@@ -12,6 +12,7 @@
 #include <mutex>
 #include <string>
 
+#include "spsp/executor.hpp"
 #include "spsp/layers.hpp"
 #include "spsp/node.hpp"
 #include "spsp/wildcard_trie.hpp"
@@ -28,14 +29,19 @@ namespace SPSP::FarLayers::LocalBroker
         std::mutex m_mutex;
         SPSP::WildcardTrie<bool> m_subs;  //!< Subscriptions
         std::string m_topicPrefix;        //!< Topic prefix for publishing
+        IExecutor* m_executor;            //!< Executor of deliveries to node
+        TaskGroup m_tasks;                //!< Pending deliveries
 
     public:
         /**
          * @brief Constructs a new local broker object
          *
          * @param topicPrefix Topic prefix for publishing
+         * @param executor Executor of deliveries to node
+         *                 (`nullptr` for default one)
          */
-        LocalBroker(const std::string topicPrefix = "spsp");
+        LocalBroker(const std::string topicPrefix = "spsp",
+                    IExecutor* executor = nullptr);
 
         /**
          * @brief Destroys local broker layer object
@@ -10,6 +10,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 
 #include "spsp/local_addr.hpp"
 
@@ -99,6 +100,81 @@ namespace SPSP
                 && payload == other.payload;
         }
     };
+
+    /**
+     * @brief Non-owning local message representation
+     *
+     * Topic and payload reference data owned by somebody else (i.e. receive
+     * buffer of local layer), so view is valid only as long as the data.
+     * Use `toMessage()` to get owning copy when data need to be retained.
+     *
+     * @tparam TLocalAddr Type of local address
+     */
+    template <typename TLocalAddr>
+    struct LocalMessageView
+    {
+        using LocalAddrT = TLocalAddr;
+        using LocalMessageT = LocalMessage<TLocalAddr>;
+
+        LocalMessageType type = LocalMessageType::NONE;  //!< Type of message
+        const TLocalAddr& addr;                          //!< Source/destination address
+        std::string_view topic = {};                     //!< Topic of message
+        std::string_view payload = {};                   //!< Payload of message
+
+        /**
+         * @brief Constructs a new empty view
+         *
+         * @param addr Source/destination address
+         */
+        explicit LocalMessageView(const TLocalAddr& addr) : addr{addr} {}
+
+        /**
+         * @brief Constructs a new view of message
+         *
+         * @param msg Message (must outlive the view)
+         */
+        LocalMessageView(const LocalMessageT& msg)
+            : type{msg.type}, addr{msg.addr}, topic{msg.topic},
+              payload{msg.payload} {}
+
+        /**
+         * @brief Creates owning copy of viewed message
+         *
+         * @return Message
+         */
+        LocalMessageT toMessage() const
+        {
+            return LocalMessageT{
+                .type = type,
+                .addr = addr,
+                .topic = std::string{topic},
+                .payload = std::string{payload},
+            };
+        }
+
+        /**
+         * @brief Converts `LocalMessageView` to printable string
+         *
+         * Primarily for logging purposes
+         *
+         * @return String representation of contained data
+         */
+        std::string toString() const
+        {
+            return std::string{localMessageTypeToStr(type)} + " " +
+                (addr.str.length() > 0 ? addr.str : "(no addr)") + " " +
+                (topic.length() > 0    ? std::string{topic} : "(no topic)") + " " +
+                "(" + std::to_string(payload.length()) + " B payload)";
+        }
+
+        bool operator==(const LocalMessageView& other) const
+        {
+            return type == other.type
+                && addr == other.addr
+                && topic == other.topic
+                && payload == other.payload;
+        }
+    };
 } // namespace SPSP
 
 // Define hasher function
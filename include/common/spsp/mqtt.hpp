@@ -9,8 +9,13 @@
 
 #pragma once
 
+#include <atomic>
 #include <future>
+#include <memory>
+#include <string>
+#include <vector>
 
+#include "spsp/executor.hpp"
 #include "spsp/layers.hpp"
 #include "spsp/mqtt_adapter_if.hpp"
 #include "spsp/mqtt_types.hpp"
@@ -24,10 +29,26 @@ namespace SPSP::FarLayers::MQTT
      */
     class MQTT : public IFarLayer
     {
+        /**
+         * @brief State of batched (un)subscribe split into chunks
+         *
+         */
+        struct Pipeline
+        {
+            std::vector<std::vector<std::string>> chunks;  //!< Topics of each request
+            bool subscribe;                                //!< Subscribe (or unsubscribe)
+            AdapterDoneCb cb;                              //!< Completion callback
+            std::atomic<size_t> next = 0;                  //!< Index of next chunk to send
+            std::atomic<size_t> remaining = 0;             //!< Number of unfinished chunks
+            std::atomic<bool> success = true;              //!< Whether all chunks succeeded
+        };
+
         Config m_conf;                           //!< Configuration
         bool m_initializing = true;              //!< Whether we are currently in initializing phase
         std::promise<void> m_connectingPromise;  //!< Promise to block until successful connection is made
         IAdapter& m_adapter;                     //!< Platform-specific MQTT adapter
+        IExecutor* m_executor;                   //!< Executor of deliveries to node
+        TaskGroup m_tasks;                       //!< Pending deliveries and completions
 
     public:
         /**
@@ -37,10 +58,12 @@ namespace SPSP::FarLayers::MQTT
          *
          * @param adapter MQTT low-level adapter
          * @param conf Configuration
+         * @param executor Executor of deliveries to node
+         *                 (`nullptr` for default one)
          * @throw AdapterError when adapter can't be constructed
          * @throw ConnectionError when connection can't be established
          */
-        MQTT(IAdapter& adapter, const Config& conf);
+        MQTT(IAdapter& adapter, const Config& conf, IExecutor* executor = nullptr);
 
         /**
          * @brief Destroys MQTT layer object
@@ -71,6 +94,18 @@ namespace SPSP::FarLayers::MQTT
          */
         bool subscribe(const std::string& topic);
 
+        /**
+         * @brief Subscribes to given topic without waiting for result
+         *
+         * Should be used by `INode` only!
+         *
+         * Callback runs in executor.
+         *
+         * @param topic Topic
+         * @param cb Completion callback
+         */
+        void subscribeAsync(const std::string& topic, FarLayerDoneCb cb);
+
         /**
          * @brief Unsubscribes from given topic
          *
@@ -82,6 +117,46 @@ namespace SPSP::FarLayers::MQTT
          */
         bool unsubscribe(const std::string& topic);
 
+        /**
+         * @brief Unsubscribes from given topic without waiting for result
+         *
+         * Should be used by `INode` only!
+         *
+         * Callback runs in executor.
+         *
+         * @param topic Topic
+         * @param cb Completion callback
+         */
+        void unsubscribeAsync(const std::string& topic, FarLayerDoneCb cb);
+
+        /**
+         * @brief Subscribes to many topics without waiting for result
+         *
+         * Should be used by `INode` only!
+         *
+         * Topics are sent in requests of at most `Config::Batch::topics`
+         * topics with at most `Config::Batch::inFlight` requests in flight.
+         * Callback runs in executor.
+         *
+         * @param topics Topics
+         * @param cb Completion callback
+         */
+        void subscribeManyAsync(const std::vector<std::string>& topics,
+                                FarLayerDoneCb cb);
+
+        /**
+         * @brief Unsubscribes from many topics without waiting for result
+         *
+         * Should be used by `INode` only!
+         *
+         * Same rules as for `subscribeManyAsync()` apply.
+         *
+         * @param topics Topics
+         * @param cb Completion callback
+         */
+        void unsubscribeManyAsync(const std::vector<std::string>& topics,
+                                  FarLayerDoneCb cb);
+
     protected:
         /**
          * @brief Signalizes successful initial connection to broker
@@ -89,9 +164,39 @@ namespace SPSP::FarLayers::MQTT
          */
         void connectedCb();
 
+        /**
+         * @brief Wraps completion callback to run in executor
+         *
+         * @param cb Completion callback
+         * @return Callback for underlaying adapter
+         */
+        AdapterDoneCb doneCb(FarLayerDoneCb cb);
+
+        /**
+         * @brief Splits topics into chunks and starts pipeline of requests
+         *
+         * @param topics Topics
+         * @param subscribe Subscribe (or unsubscribe)
+         * @param cb Completion callback
+         */
+        void pipelineStart(const std::vector<std::string>& topics, bool subscribe,
+                           FarLayerDoneCb cb);
+
+        /**
+         * @brief Sends request for single chunk
+         *
+         * Completion of the chunk sends next one waiting.
+         *
+         * @param state Pipeline state
+         * @param idx Chunk index
+         */
+        void pipelineRun(std::shared_ptr<Pipeline> state, size_t idx);
+
         /**
          * @brief Callback for underlaying adapter to receive subscribe data
          *
+         * Runs in executor.
+         *
          * @param topic Topic
          * @param payload Payload
          */
@@ -10,7 +10,10 @@
 #pragma once
 
 #include <functional>
+#include <string>
+#include <vector>
 
+#include "spsp/layers.hpp"
 #include "spsp/mqtt_types.hpp"
 
 namespace SPSP::FarLayers::MQTT
@@ -28,6 +31,7 @@ namespace SPSP::FarLayers::MQTT
     using AdapterConnectedCb = std::function<void()>;
     using AdapterSubDataCb = std::function<void(const std::string& topic,
                                                 const std::string& payload)>;
+    using AdapterDoneCb = std::function<void(bool success)>;
 
     /**
      * @brief Interface for platform-dependent MQTT adapter
@@ -71,9 +75,76 @@ namespace SPSP::FarLayers::MQTT
          */
         virtual bool unsubscribe(const std::string& topic) = 0;
 
+        /**
+         * @brief Subscribes to given topic without waiting for result
+         *
+         * Callback is called exactly once, when broker responds (or
+         * request fails). It may be called from client library's context.
+         * Default implementation blocks in `subscribe()`.
+         *
+         * @param topic Topic
+         * @param cb Completion callback
+         */
+        virtual void subscribeAsync(const std::string& topic, AdapterDoneCb cb)
+        {
+            cb(this->subscribe(topic));
+        }
+
+        /**
+         * @brief Unsubscribes from given topic without waiting for result
+         *
+         * Same rules as for `subscribeAsync()` apply.
+         * Default implementation blocks in `unsubscribe()`.
+         *
+         * @param topic Topic
+         * @param cb Completion callback
+         */
+        virtual void unsubscribeAsync(const std::string& topic, AdapterDoneCb cb)
+        {
+            cb(this->unsubscribe(topic));
+        }
+
+        /**
+         * @brief Subscribes to many topics in single request
+         *
+         * Same rules as for `subscribeAsync()` apply. Callback is called
+         * once for all topics (successful if all subscribes were).
+         * Default implementation calls `subscribeAsync()` on each topic.
+         *
+         * @param topics Topics
+         * @param cb Completion callback
+         */
+        virtual void subscribeManyAsync(const std::vector<std::string>& topics,
+                                        AdapterDoneCb cb)
+        {
+            joinAsync(topics, [this](const std::string& topic, AdapterDoneCb topicCb) {
+                this->subscribeAsync(topic, topicCb);
+            }, cb);
+        }
+
+        /**
+         * @brief Unsubscribes from many topics in single request
+         *
+         * Same rules as for `subscribeManyAsync()` apply.
+         * Default implementation calls `unsubscribeAsync()` on each topic.
+         *
+         * @param topics Topics
+         * @param cb Completion callback
+         */
+        virtual void unsubscribeManyAsync(const std::vector<std::string>& topics,
+                                          AdapterDoneCb cb)
+        {
+            joinAsync(topics, [this](const std::string& topic, AdapterDoneCb topicCb) {
+                this->unsubscribeAsync(topic, topicCb);
+            }, cb);
+        }
+
         /**
          * @brief Sets callback for incoming subscription data
          *
+         * Callback may be called from client library's context,
+         * layer passes data to its executor.
+         *
          * @param cb Callback
          */
         virtual void setSubDataCb(AdapterSubDataCb cb) = 0;
@@ -10,6 +10,7 @@
 #pragma once
 
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
 
 #include "spsp/exception.hpp"
@@ -96,6 +97,16 @@ namespace SPSP::FarLayers::MQTT
             bool retain = false;  //!< LWT retain flag
         };
 
+        /**
+         * Batching of (un)subscribe requests (e.g. resubscription
+         * after reconnect)
+         */
+        struct Batch
+        {
+            size_t topics = 64;   //!< Maximum number of topics in single request
+            size_t inFlight = 4;  //!< Maximum number of requests in flight
+        };
+
         /**
          * Topic prefix
          *
@@ -108,5 +119,6 @@ namespace SPSP::FarLayers::MQTT
         Connection connection;
         Auth auth;
         LastWill lastWill;
+        Batch batch;
     };
 } // namespace SPSP::FarLayers::MQTT
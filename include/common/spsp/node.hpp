@@ -15,8 +15,8 @@
 #include <functional>
 #include <memory>
 #include <mutex>
-#include <thread>
 
+#include "spsp/executor.hpp"
 #include "spsp/layers.hpp"
 #include "spsp/local_message.hpp"
 #include "spsp/logger.hpp"
@@ -48,6 +48,9 @@ namespace SPSP
      */
     class INode
     {
+        IExecutor* m_executor = nullptr;  //!< Executor of asynchronous tasks (`nullptr` for default)
+        TaskGroup m_tasks;                //!< Tasks submitted by this node
+
     public:
         /**
          * @brief Constructs a new generic node
@@ -99,6 +102,50 @@ namespace SPSP
          *
          */
         virtual void resubscribeAll() = 0;
+
+    protected:
+        /**
+         * @brief Sets executor of asynchronous tasks
+         *
+         * @param executor Executor (`nullptr` for default executor)
+         */
+        void setExecutor(IExecutor* executor)
+        {
+            m_executor = executor;
+        }
+
+        /**
+         * @brief Gets executor of asynchronous tasks
+         *
+         * @return Executor
+         */
+        IExecutor& getExecutor() const
+        {
+            return m_executor != nullptr ? *m_executor : defaultExecutor();
+        }
+
+        /**
+         * @brief Submits asynchronous task to executor
+         *
+         * @param task Task
+         * @return true Task has been accepted
+         * @return false Task has been dropped
+         */
+        bool execute(IExecutor::TaskT task)
+        {
+            return m_tasks.execute(this->getExecutor(), std::move(task));
+        }
+
+        /**
+         * @brief Waits for all asynchronous tasks of this node
+         *
+         * Must be called by destructor of derived node before destroying
+         * anything the tasks use.
+         */
+        void waitForTasks()
+        {
+            m_tasks.wait();
+        }
     };
 
     /**
@@ -111,7 +158,8 @@ namespace SPSP
     {
         using LocalAddrT = typename TLocalLayer::LocalAddrT;
         using LocalMessageT = typename TLocalLayer::LocalMessageT;
-        using LocalRecvSendCb = std::function<void(const LocalMessageT&)>;
+        using LocalMessageViewT = LocalMessageView<LocalAddrT>;
+        using LocalRecvSendCb = std::function<void(const LocalMessageViewT&)>;
 
         TLocalLayer* m_ll;
         LocalRecvSendCb m_localRecvSendCb = nullptr;
@@ -130,11 +178,13 @@ namespace SPSP
          * @brief Receives the message from local layer
          *
          * Acts as a callback for local layer receiver.
+         * Message data are valid only during this call, handlers have to
+         * make copy of anything they retain.
          *
          * @param msg Received message
          * @param rssi Received signal strength indicator (in dBm)
          */
-        void receiveLocal(const LocalMessageT& msg, int rssi = NODE_RSSI_UNKNOWN)
+        void receiveLocal(const LocalMessageViewT& msg, int rssi = NODE_RSSI_UNKNOWN)
         {
             if (rssi != NODE_RSSI_UNKNOWN) {
                 SPSP_LOGI("Received local msg: %s (%d dBm)",
@@ -251,103 +301,102 @@ namespace SPSP
         {
             if (rssi == NODE_RSSI_UNKNOWN) return;
 
-            // Spawn new thread for this publish
-            std::thread t([this, addr, rssi] {
+            // Publish asynchronously
+            this->execute([this, addr, rssi] {
                 std::string topic = NODE_REPORTING_TOPIC + "/"
                                   + NODE_REPORTING_RSSI_SUBTOPIC + "/"
                                   + addr.str;
 
                 this->publish(topic, std::to_string(rssi));
             });
-            t.detach();
         }
 
         /**
          * @brief Processes PROBE_REQ message
          *
-         * @param req Request message
+         * @param req Request message (valid only during the call)
          * @param rssi Received signal strength indicator (in dBm)
          * @return true Message delivery successful
          * @return false Message delivery failed
          */
-        virtual bool processProbeReq(const LocalMessageT& req,
+        virtual bool processProbeReq(const LocalMessageViewT& req,
                                      int rssi = NODE_RSSI_UNKNOWN) = 0;
 
         /**
          * @brief Processes PROBE_RES message
          *
-         * @param req Request message
+         * @param req Request message (valid only during the call)
          * @param rssi Received signal strength indicator (in dBm)
          * @return true Message delivery successful
          * @return false Message delivery failed
          */
-        virtual bool processProbeRes(const LocalMessageT& req,
+        virtual bool processProbeRes(const LocalMessageViewT& req,
                                      int rssi = NODE_RSSI_UNKNOWN) = 0;
 
         /**
          * @brief Processes PUB message
          *
-         * @param req Request message
+         * @param req Request message (valid only during the call)
          * @param rssi Received signal strength indicator (in dBm)
          * @return true Message delivery successful
          * @return false Message delivery failed
          */
-        virtual bool processPub(const LocalMessageT& req,
+        virtual bool processPub(const LocalMessageViewT& req,
                                 int rssi = NODE_RSSI_UNKNOWN) = 0;
 
         /**
          * @brief Processes SUB_REQ message
          *
-         * @param req Request message
+         * @param req Request message (valid only during the call)
          * @param rssi Received signal strength indicator (in dBm)
          * @return true Message delivery successful
          * @return false Message delivery failed
          */
-        virtual bool processSubReq(const LocalMessageT& req,
+        virtual bool processSubReq(const LocalMessageViewT& req,
                                    int rssi = NODE_RSSI_UNKNOWN) = 0;
 
         /**
          * @brief Processes SUB_DATA message
          *
-         * @param req Request message
+         * @param req Request message (valid only during the call)
          * @param rssi Received signal strength indicator (in dBm)
          * @return true Message delivery successful
          * @return false Message delivery failed
          */
-        virtual bool processSubData(const LocalMessageT& req,
+        virtual bool processSubData(const LocalMessageViewT& req,
                                     int rssi = NODE_RSSI_UNKNOWN) = 0;
 
         /**
          * @brief Processes UNSUB message
          *
-         * @param req Request message
+         * @param req Request message (valid only during the call)
          * @param rssi Received signal strength indicator (in dBm)
          * @return true Message delivery successful
          * @return false Message delivery failed
          */
-        virtual bool processUnsub(const LocalMessageT& req,
+        virtual bool processUnsub(const LocalMessageViewT& req,
                                   int rssi = NODE_RSSI_UNKNOWN) = 0;
 
         /**
          * @brief Processes TIME_REQ message
          *
-         * @param req Request message
+         * @param req Request message (valid only during the call)
          * @param rssi Received signal strength indicator (in dBm)
          * @return true Message delivery successful
          * @return false Message delivery failed
          */
-        virtual bool processTimeReq(const LocalMessageT& req,
+        virtual bool processTimeReq(const LocalMessageViewT& req,
                                     int rssi = NODE_RSSI_UNKNOWN) = 0;
 
         /**
          * @brief Processes TIME_RES message
          *
-         * @param req Request message
+         * @param req Request message (valid only during the call)
          * @param rssi Received signal strength indicator (in dBm)
          * @return true Message delivery successful
          * @return false Message delivery failed
          */
-        virtual bool processTimeRes(const LocalMessageT& req,
+        virtual bool processTimeRes(const LocalMessageViewT& req,
                                     int rssi = NODE_RSSI_UNKNOWN) = 0;
     };
 
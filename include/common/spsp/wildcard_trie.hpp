@@ -9,13 +9,19 @@
 
 #pragma once
 
+#include <cstdint>
 #include <functional>
+#include <map>
 #include <memory>
 #include <queue>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
+#include "spsp/inline_stack.hpp"
+
 namespace SPSP
 {
     /**
@@ -28,6 +34,10 @@ namespace SPSP
      * There are no exceptions and no key validation. If key is
      * semantically invalid, the item will just become inaccessible.
      *
+     * Keys without wildcard levels can match only the same topic, so they
+     * are kept in hash index instead of the trie. Searching costs one hash
+     * lookup plus walk of trie with only wildcard keys.
+     *
      * @tparam TValue Type of value
      */
     template <typename TValue>
@@ -39,19 +49,63 @@ namespace SPSP
          */
         struct Node
         {
-            TValue value;                                                   //!< Value
-            std::unordered_map<std::string, std::unique_ptr<Node>> childs;  //!< Children
-            size_t levelIndex = 0;                                          //!< Index of level
-            bool isLeaf = false;                                            //!< Whether is leaf node
+            TValue value;                                                      //!< Value
+            std::map<std::string, std::unique_ptr<Node>, std::less<>> childs;  //!< Children (allows `string_view` lookup)
+            bool isLeaf = false;                                               //!< Whether is leaf node
+        };
+
+        /**
+         * @brief Item with exact (wildcard-free) key
+         *
+         */
+        struct ExactItem
+        {
+            std::string key;  //!< Key (viewed by key of `m_exact`)
+            TValue value;     //!< Value
         };
 
         using BFSQueueT = std::queue<std::pair<std::string, const Node*>>;
+        using ExactMapT = std::unordered_map<std::string_view, std::unique_ptr<ExactItem>>;
+
+        //! Marks topic position past the last level
+        static constexpr size_t FIND_END = std::string_view::npos;
+
+        //! Depth of `findEach()` search without heap allocation
+        static constexpr size_t FIND_INLINE_DEPTH = 16;
+
+        /**
+         * @brief Next kind of child to visit in `findEach()`
+         *
+         */
+        enum FindStep : uint8_t
+        {
+            FIND_EXACT = 0,        //!< Child with same level
+            FIND_SINGLE_WILD = 1,  //!< Single-level wildcard child
+            FIND_MULTI_WILD = 2,   //!< Multi-level wildcard child
+            FIND_DONE = 3,         //!< Nothing to visit
+        };
+
+        /**
+         * @brief Node on `findEach()` search path
+         *
+         */
+        struct FindFrame
+        {
+            const Node* node = nullptr;  //!< Node
+            std::string_view edge;       //!< Level of `node` in trie
+            std::string_view level;      //!< Topic level matched against children
+            size_t nextPos = FIND_END;   //!< Topic position of level after `level`
+            FindStep next = FIND_DONE;   //!< Next kind of child to visit
+        };
+
+        using FindStackT = InlineStack<FindFrame, FIND_INLINE_DEPTH>;
 
         const std::string m_lSep;         //!< Level separator
         const std::string m_lSingleWild;  //!< Single-level wildcard token
         const std::string m_lMultiWild;   //!< Multi-level wildcard token
 
-        Node m_root;                      //!< Root node
+        Node m_root;                      //!< Root node (keys with wildcards)
+        ExactMapT m_exact;                //!< Items with exact keys
 
     public:
         /**
@@ -76,6 +130,17 @@ namespace SPSP
          */
         TValue& operator[](const std::string& key)
         {
+            if (!this->hasWildcard(key)) {
+                auto it = m_exact.find(key);
+                if (it == m_exact.end()) {
+                    auto item = std::make_unique<ExactItem>(ExactItem{ key, TValue{} });
+                    std::string_view itemKey = item->key;
+                    it = m_exact.emplace(itemKey, std::move(item)).first;
+                }
+
+                return it->second->value;
+            }
+
             Node* cur = &m_root;
             auto levels = this->splitToLevels(key);
 
@@ -86,7 +151,6 @@ namespace SPSP
                 // Create new child
                 if (cur->childs.find(level) == cur->childs.end()) {
                     cur->childs[level] = std::make_unique<Node>();
-                    cur->childs[level]->levelIndex = i + 1;
                 }
 
                 // Move to next level
@@ -118,6 +182,10 @@ namespace SPSP
          */
         bool remove(const std::string& key)
         {
+            if (!this->hasWildcard(key)) {
+                return m_exact.erase(key) > 0;
+            }
+
             Node* cur = &m_root;
             auto levels = this->splitToLevels(key);
 
@@ -161,54 +229,227 @@ namespace SPSP
         using FindReturnT = std::unordered_map<std::string, const TValue&>;
 
         /**
-         * @brief Finds `key` in trie
+         * @brief Item matched by `findEach()`
          *
-         * @param key Key
-         * @return Vector of values from matching keys (empty if not found)
+         * Key of the item is built only when requested.
+         * Valid only during visitor call.
          */
-        const FindReturnT find(const std::string& key) const
+        class Match
         {
-            auto levels = this->splitToLevels(key);
+            friend class WildcardTrie;
+
+            const FindStackT& m_stack;       //!< Search path
+            const std::string& m_lSep;       //!< Level separator
+            const std::string* m_lastLevel;  //!< Level after search path (if any)
+            const std::string* m_exactKey;   //!< Key of exact item (search path unused)
+
+            Match(const FindStackT& stack, const std::string& lSep,
+                  const std::string* lastLevel, const std::string* exactKey,
+                  const TValue& value)
+                : m_stack{stack}, m_lSep{lSep}, m_lastLevel{lastLevel},
+                  m_exactKey{exactKey}, value{value}
+            {}
+
+        public:
+            const TValue& value;  //!< Value
+
+            /**
+             * @brief Builds key of the item
+             *
+             * @return Key
+             */
+            std::string key() const
+            {
+                if (m_exactKey != nullptr) {
+                    return *m_exactKey;
+                }
 
-            FindReturnT values;
+                std::string key;
 
-            // Queue for to-be-processed nodes
-            BFSQueueT nodeQueue;
-            nodeQueue.push({ "", &m_root });
+                // Root has no level
+                for (size_t i = 1; i < m_stack.size(); i++) {
+                    if (i > 1) key += m_lSep;
+                    key += m_stack[i].edge;
+                }
 
-            while (!nodeQueue.empty()) {
-                auto [nodeKey, node] = nodeQueue.front();
+                if (m_lastLevel != nullptr) {
+                    if (m_stack.size() > 1) key += m_lSep;
+                    key += *m_lastLevel;
+                }
 
-                if (node->levelIndex == levels.size() && node->isLeaf) {
-                    // Match
-                    values.insert({ nodeKey, node->value });
+                return key;
+            }
+        };
+
+        /**
+         * @brief Calls visitor for each item matching `topic`
+         *
+         * Exact item (if any) is visited first. Then depth-first search
+         * of wildcard keys. Topic is tokenized lazily and search path
+         * is kept on fixed-capacity stack, so there's no heap allocation
+         * unless there are more than `FIND_INLINE_DEPTH` levels.
+         *
+         * Visitor takes `const Match&`. If it returns `bool`, `false`
+         * stops the search.
+         *
+         * @tparam F Visitor type
+         * @param topic Topic
+         * @param visitor Visitor
+         * @return true Search finished
+         * @return false Search was stopped by visitor
+         */
+        template <typename F>
+        bool findEach(std::string_view topic, F&& visitor) const
+        {
+            FindStackT stack;
+
+            auto visit = [&](const TValue& value, const std::string* lastLevel,
+                             const std::string* exactKey = nullptr) {
+                Match match{stack, m_lSep, lastLevel, exactKey, value};
+
+                if constexpr (std::is_void_v<std::invoke_result_t<F&, const Match&>>) {
+                    visitor(match);
+                    return true;
+                } else {
+                    return static_cast<bool>(visitor(match));
                 }
-                else if (node->levelIndex < levels.size()) {
-                    // Enqueue relevant childs
-                    for (auto& [childLevel, childNode] : node->childs) {
-                        std::string childKey = nodeKey == ""
-                            ? childLevel
-                            : nodeKey + m_lSep + childLevel;
-
-                        if (childLevel == levels.at(node->levelIndex) ||
-                            childLevel == m_lSingleWild) {
-                            // Key matches or has single-level wildcard
-                            nodeQueue.push({ childKey, childNode.get() });
-                        }
-                        else if (childLevel == m_lMultiWild &&
-                                 childNode->isLeaf) {
-                            // Multi-level wildcard
-                            values.insert({ childKey, childNode->value });
-                        }
-                    }
+            };
+
+            // Pushes node at topic position `pos`
+            auto push = [&](const Node* node, std::string_view edge, size_t pos) {
+                FindFrame frame;
+                frame.node = node;
+                frame.edge = edge;
+
+                if (pos == FIND_END) {
+                    // All levels consumed
+                    stack.push(frame);
+                    return !node->isLeaf || visit(node->value, nullptr);
                 }
 
-                nodeQueue.pop();
+                size_t sepPos = topic.find(m_lSep, pos);
+                if (sepPos == std::string_view::npos) {
+                    frame.level = topic.substr(pos);
+                } else {
+                    frame.level = topic.substr(pos, sepPos - pos);
+                    frame.nextPos = sepPos + m_lSep.length();
+                }
+                frame.next = FIND_EXACT;
+
+                stack.push(frame);
+                return true;
+            };
+
+            // Exact key
+            auto exactIt = m_exact.find(topic);
+            if (exactIt != m_exact.end() &&
+                !visit(exactIt->second->value, nullptr, &exactIt->second->key)) {
+                return false;
+            }
+
+            if (m_root.childs.empty()) {
+                return true;
             }
 
+            if (!push(&m_root, {}, 0)) {
+                return false;
+            }
+
+            while (!stack.empty()) {
+                // Push may invalidate the reference
+                FindFrame frame = stack.top();
+
+                if (frame.next == FIND_DONE) {
+                    stack.pop();
+                    continue;
+                }
+
+                stack.top().next = static_cast<FindStep>(frame.next + 1);
+
+                switch (frame.next) {
+                case FIND_EXACT: {
+                    // Key matches
+                    auto it = frame.node->childs.find(frame.level);
+                    if (it != frame.node->childs.end() &&
+                        !push(it->second.get(), it->first, frame.nextPos)) {
+                        return false;
+                    }
+                    break;
+                }
+                case FIND_SINGLE_WILD: {
+                    // Single-level wildcard
+                    if (frame.level == m_lSingleWild) break;
+
+                    auto it = frame.node->childs.find(m_lSingleWild);
+                    if (it != frame.node->childs.end() &&
+                        !push(it->second.get(), it->first, frame.nextPos)) {
+                        return false;
+                    }
+                    break;
+                }
+                case FIND_MULTI_WILD: {
+                    // Multi-level wildcard
+                    if (frame.level == m_lMultiWild) break;
+
+                    auto it = frame.node->childs.find(m_lMultiWild);
+                    if (it != frame.node->childs.end() && it->second->isLeaf &&
+                        !visit(it->second->value, &m_lMultiWild)) {
+                        return false;
+                    }
+                    break;
+                }
+                default:
+                    break;
+                }
+            }
+
+            return true;
+        }
+
+        /**
+         * @brief Finds `key` in trie
+         *
+         * @param key Key
+         * @return Vector of values from matching keys (empty if not found)
+         */
+        const FindReturnT find(const std::string& key) const
+        {
+            FindReturnT values;
+
+            this->findEach(key, [&values](const Match& match) {
+                values.insert({ match.key(), match.value });
+            });
+
             return values;
         }
 
+        /**
+         * @brief Checks whether any item matches `topic`
+         *
+         * Stops on first match.
+         *
+         * @param topic Topic
+         * @return true There's a matching item
+         * @return false There's no matching item
+         */
+        bool matchesAny(std::string_view topic) const
+        {
+            return !this->findEach(topic, [](const Match&) { return false; });
+        }
+
+        /**
+         * @brief Counts items matching `topic`
+         *
+         * @param topic Topic
+         * @return Number of matching items
+         */
+        size_t countMatches(std::string_view topic) const
+        {
+            size_t count = 0;
+            this->findEach(topic, [&count](const Match&) { count++; });
+            return count;
+        }
+
         /**
          * @brief Iterates through each item in trie and calls callback
          *        on each one
@@ -217,6 +458,11 @@ namespace SPSP
          */
         void forEach(std::function<void(const std::string& key, const TValue& value)> f)
         {
+            // Exact keys
+            for (auto& [exactKey, item] : m_exact) {
+                f(item->key, item->value);
+            }
+
             // Queue for to-be-processed nodes
             BFSQueueT nodeQueue;
             nodeQueue.push({ "", &m_root });
@@ -231,7 +477,7 @@ namespace SPSP
 
                 // Enqueue children
                 for (auto& [childLevel, childNode] : node->childs) {
-                    std::string childKey = nodeKey == ""
+                    std::string childKey = node == &m_root
                         ? childLevel
                         : nodeKey + m_lSep + childLevel;
                     nodeQueue.push({ childKey, childNode.get() });
@@ -249,10 +495,38 @@ namespace SPSP
          */
         bool empty() const
         {
-            return m_root.childs.empty();
+            return m_exact.empty() && m_root.childs.empty();
         }
 
     protected:
+        /**
+         * @brief Checks whether any level of `key` is wildcard
+         *
+         * @param key Key
+         * @return true Key has wildcard level
+         * @return false Key is exact
+         */
+        bool hasWildcard(std::string_view key) const
+        {
+            size_t curPos = 0, nextPos;
+
+            while (true) {
+                nextPos = key.find(m_lSep, curPos);
+                auto level = key.substr(curPos, nextPos == std::string_view::npos
+                                                ? std::string_view::npos
+                                                : nextPos - curPos);
+
+                if (level == m_lSingleWild || level == m_lMultiWild) {
+                    return true;
+                }
+
+                if (nextPos == std::string_view::npos) {
+                    return false;
+                }
+                curPos = nextPos + m_lSep.length();
+            }
+        }
+
         /**
          * @brief Splits `key` to levels
          *
@@ -0,0 +1,272 @@
+/**
+ * @file worker_pool.hpp
+ * @author Dávid Benko (davidbenko@davidbenko.dev)
+ * @brief Fixed-size worker pool with bounded queue
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace SPSP
+{
+    /**
+     * @brief Behaviour of bounded queue when it's full
+     *
+     */
+    enum class OverflowPolicy : uint8_t
+    {
+        DROP_OLDEST = 0,  //!< Discard the oldest queued item to make room
+        DROP_NEWEST = 1,  //!< Discard the item being pushed
+        BLOCK       = 2,  //!< Block producer until there's room
+    };
+
+    /**
+     * @brief Worker pool statistics
+     *
+     */
+    struct WorkerPoolStats
+    {
+        size_t queueDepth = 0;         //!< Current number of queued items
+        size_t queueDepthMax = 0;      //!< Highest observed number of queued items
+        uint64_t processed = 0;        //!< Number of items passed to handler
+        uint64_t droppedOldest = 0;    //!< Number of items dropped by `DROP_OLDEST` policy
+        uint64_t droppedNewest = 0;    //!< Number of items dropped by `DROP_NEWEST` policy
+    };
+
+    /**
+     * @brief Fixed-size pool of worker threads fed by bounded queue
+     *
+     * Any number of producers may push items, which are processed by
+     * `workers` threads calling handler on each of them.
+     * Queue storage is allocated once during construction.
+     *
+     * @tparam TItem Type of queued item (must be default constructible
+     *               and move assignable)
+     */
+    template <typename TItem>
+    class WorkerPool
+    {
+    public:
+        using HandlerT = std::function<void(TItem& item)>;
+
+    protected:
+        std::mutex m_mutex;                 //!< Mutex protecting queue
+        std::condition_variable m_cvItem;   //!< Signalled when item is pushed
+        std::condition_variable m_cvSpace;  //!< Signalled when item is popped
+        std::vector<TItem> m_queue;         //!< Ring buffer of queued items
+        size_t m_head = 0;                  //!< Index of the oldest item
+        size_t m_count = 0;                 //!< Number of queued items
+        size_t m_countMax = 0;              //!< Highest observed `m_count`
+        const OverflowPolicy m_policy;      //!< Overflow policy
+        const HandlerT m_handler;           //!< Item handler
+        bool m_run = true;                  //!< Whether to continue running
+        std::vector<std::thread> m_threads; //!< Worker threads
+
+        std::atomic<uint64_t> m_processed = 0;      //!< Processed items counter
+        std::atomic<uint64_t> m_droppedOldest = 0;  //!< Dropped oldest items counter
+        std::atomic<uint64_t> m_droppedNewest = 0;  //!< Dropped newest items counter
+
+    public:
+        /**
+         * @brief Constructs a new worker pool and starts the workers
+         *
+         * @param workers Number of worker threads (at least 1 is used)
+         * @param capacity Maximum number of queued items (at least 1 is used)
+         * @param policy Behaviour when queue is full
+         * @param handler Handler called on each item from worker thread
+         */
+        WorkerPool(size_t workers, size_t capacity, OverflowPolicy policy,
+                   HandlerT handler)
+            : m_queue(capacity > 0 ? capacity : 1), m_policy{policy},
+              m_handler{handler}
+        {
+            if (workers == 0) workers = 1;
+
+            for (size_t i = 0; i < workers; i++) {
+                m_threads.emplace_back(&WorkerPool<TItem>::workerThread, this);
+            }
+        }
+
+        /**
+         * @brief Stops the workers and destroys the pool
+         *
+         * Items currently being processed are finished, the rest of queue
+         * is discarded.
+         */
+        ~WorkerPool()
+        {
+            {
+                const std::scoped_lock lock(m_mutex);
+                m_run = false;
+            }
+
+            m_cvItem.notify_all();
+            m_cvSpace.notify_all();
+
+            for (auto& t : m_threads) {
+                t.join();
+            }
+        }
+
+        /**
+         * @brief Pushes item to the queue
+         *
+         * If the queue is full, overflow policy is applied.
+         *
+         * @param item Item
+         * @return true Item has been enqueued
+         * @return false Item has been dropped
+         */
+        bool push(TItem&& item)
+        {
+            return this->pushImpl(std::move(item), nullptr);
+        }
+
+        /**
+         * @brief Pushes item to the queue, blocking at most for `timeout`
+         *
+         * Same as `push()`, but with `BLOCK` policy gives up after `timeout`.
+         * In that case, `item` is left untouched, so it may be pushed again.
+         *
+         * @param item Item
+         * @param timeout Maximum time to wait for free space
+         * @return true Item has been enqueued
+         * @return false Item has been dropped or timeout expired
+         */
+        template <typename TRep, typename TPeriod>
+        bool pushFor(TItem&& item, const std::chrono::duration<TRep, TPeriod>& timeout)
+        {
+            const auto deadline = std::chrono::steady_clock::now() + timeout;
+            return this->pushImpl(std::move(item), &deadline);
+        }
+
+        /**
+         * @brief Gets overflow policy
+         *
+         * @return Overflow policy
+         */
+        OverflowPolicy getPolicy() const noexcept { return m_policy; }
+
+        /**
+         * @brief Gets native handles of worker threads
+         *
+         * @return Native handles
+         */
+        std::vector<std::thread::native_handle_type> getNativeHandles()
+        {
+            std::vector<std::thread::native_handle_type> handles;
+            for (auto& t : m_threads) {
+                handles.push_back(t.native_handle());
+            }
+            return handles;
+        }
+
+        /**
+         * @brief Gets current statistics
+         *
+         * @return Statistics
+         */
+        WorkerPoolStats getStats()
+        {
+            WorkerPoolStats stats = {};
+
+            {
+                const std::scoped_lock lock(m_mutex);
+                stats.queueDepth = m_count;
+                stats.queueDepthMax = m_countMax;
+            }
+
+            stats.processed = m_processed;
+            stats.droppedOldest = m_droppedOldest;
+            stats.droppedNewest = m_droppedNewest;
+            return stats;
+        }
+
+    protected:
+        /**
+         * @brief Pushes item to the queue
+         *
+         * @param item Item
+         * @param deadline Deadline for `BLOCK` policy (`nullptr` waits forever)
+         * @return true Item has been enqueued
+         * @return false Item has been dropped or deadline expired
+         */
+        bool pushImpl(TItem&& item,
+                      const std::chrono::steady_clock::time_point* deadline)
+        {
+            {
+                std::unique_lock lock(m_mutex);
+
+                if (m_count == m_queue.size()) {
+                    auto hasSpace = [this] {
+                        return m_count < m_queue.size() || !m_run;
+                    };
+
+                    switch (m_policy) {
+                    case OverflowPolicy::DROP_OLDEST:
+                        m_head = (m_head + 1) % m_queue.size();
+                        m_count--;
+                        m_droppedOldest++;
+                        break;
+                    case OverflowPolicy::DROP_NEWEST:
+                        m_droppedNewest++;
+                        return false;
+                    case OverflowPolicy::BLOCK:
+                        if (deadline == nullptr) {
+                            m_cvSpace.wait(lock, hasSpace);
+                        } else if (!m_cvSpace.wait_until(lock, *deadline, hasSpace)) {
+                            return false;
+                        }
+                        if (!m_run) return false;
+                        break;
+                    }
+                }
+
+                m_queue[(m_head + m_count) % m_queue.size()] = std::move(item);
+                m_count++;
+                if (m_count > m_countMax) m_countMax = m_count;
+            }
+
+            m_cvItem.notify_one();
+            return true;
+        }
+
+        /**
+         * @brief Function of worker thread
+         *
+         */
+        void workerThread()
+        {
+            while (true) {
+                TItem item;
+
+                {
+                    std::unique_lock lock(m_mutex);
+                    m_cvItem.wait(lock, [this] { return m_count > 0 || !m_run; });
+
+                    if (!m_run) return;
+
+                    item = std::move(m_queue[m_head]);
+                    m_head = (m_head + 1) % m_queue.size();
+                    m_count--;
+                }
+
+                m_cvSpace.notify_one();
+
+                m_handler(item);
+                m_processed++;
+            }
+        }
+    };
+} // namespace SPSP
@@ -13,6 +13,7 @@
 #include <string>
 
 #include "spsp/espnow_adapter_if.hpp"
+#include "spsp/executor.hpp"
 #include "spsp/espnow_types.hpp"
 
 namespace SPSP::LocalLayers::ESPNOW
@@ -31,6 +32,7 @@ namespace SPSP::LocalLayers::ESPNOW
     {
         AdapterRecvCb m_recvCb = nullptr;
         AdapterSendCb m_sendCb = nullptr;
+        ThreadPoolExecutor m_sendExecutor{{.workers = 1}};  //!< Runs send callbacks outside WiFi task
 
     public:
         /**
@@ -49,7 +51,7 @@ namespace SPSP::LocalLayers::ESPNOW
         /**
          * @brief Sets receive callback
          *
-         * Callback should be called in new thread.
+         * Callback is called from WiFi task.
          *
          * @param cb Callback
          */
@@ -76,15 +78,22 @@ namespace SPSP::LocalLayers::ESPNOW
          */
         AdapterSendCb getSendCb() const noexcept;
 
+        /**
+         * @brief Gets executor of send callbacks
+         *
+         * @return Executor
+         */
+        IExecutor& getSendExecutor() noexcept;
+
         /**
          * @brief Sends local message
          *
          * @param dst Destination address
-         * @param data Raw data to be sent
+         * @param frame Frame with packet to be sent
          * @throw AdapterError when call to send function fails
          *        (not when packet undelivered)
          */
-        void send(const LocalAddrT& dst, const std::string& data);
+        void send(const LocalAddrT& dst, TxFrame& frame);
 
         /**
          * @brief Adds peer to peer list
@@ -101,5 +110,12 @@ namespace SPSP::LocalLayers::ESPNOW
          * @throw AdapterError when peer can't be removed
          */
         void removePeer(const LocalAddrT& peer);
+
+        /**
+         * @brief Gets maximum number of simultaneously registered peers
+         *
+         * @return `MAX_PEER_NUM`
+         */
+        size_t getMaxPeerNum() const noexcept;
     };
 } // namespace SPSP::LocalLayers::ESPNOW
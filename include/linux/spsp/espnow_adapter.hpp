@@ -9,16 +9,68 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <sys/socket.h>
 #include <thread>
+#include <vector>
 
 #include "spsp/espnow_adapter_if.hpp"
 #include "spsp/espnow_packet_ieee80211.hpp"
 #include "spsp/espnow_types.hpp"
+#include "spsp/executor.hpp"
+#include "spsp/worker_pool.hpp"
 
 namespace SPSP::LocalLayers::ESPNOW
 {
+    /**
+     * @brief Linux ESP-NOW adapter configuration
+     *
+     * Everything here is optional.
+     */
+    struct AdapterConfig
+    {
+        struct Recv
+        {
+            size_t workers = 2;      //!< Number of threads running receive callback
+            size_t queueSize = 64;   //!< Maximum number of received batches waiting for worker
+
+            //! What to do with received batch when queue is full
+            OverflowPolicy overflow = OverflowPolicy::DROP_OLDEST;
+        };
+
+        /**
+         * @brief Memory-mapped receive ring (`PACKET_RX_RING`, `TPACKET_V3`)
+         *
+         * Kernel places captured frames directly into memory shared with
+         * handler thread, which saves one copy and one syscall per frame.
+         * If ring can't be set up, plain `read()` is used instead.
+         */
+        struct RxRing
+        {
+            bool enabled = false;         //!< Whether to use the ring
+            size_t blockSize = 1 << 16;   //!< Block size (rounded up to page size)
+            size_t blockNum = 8;          //!< Number of blocks
+
+            //! Time after which partially filled block is passed to handler
+            std::chrono::milliseconds blockTimeout{2};
+        };
+
+        struct Send
+        {
+            size_t queueSize = 64;   //!< Maximum number of frames waiting for injection
+            size_t batchSize = 16;   //!< Maximum number of frames injected by one syscall
+        };
+
+        Recv recv;
+        RxRing rxRing;
+        Send send;
+    };
+
     /**
      * @brief ESP-NOW adapter for Linux platform
      *
@@ -37,8 +89,24 @@ namespace SPSP::LocalLayers::ESPNOW
         struct RawSocket
         {
             int fd;
+            uint8_t* ring = nullptr;   //!< Mapped receive ring (if used)
+            size_t ringBlockSize = 0;  //!< Size of ring block
+            size_t ringBlockNum = 0;   //!< Number of ring blocks
+            size_t ringBlockCur = 0;   //!< Index of next block to process
+
             RawSocket();
             ~RawSocket();
+
+            /**
+             * @brief Sets up and maps `TPACKET_V3` receive ring
+             *
+             * Must be called before binding the socket.
+             *
+             * @param conf Ring configuration
+             * @return true Ring is ready
+             * @return false Setup failed (socket is usable without ring)
+             */
+            bool setupRxRing(const AdapterConfig::RxRing& conf);
         };
 
         /**
@@ -53,12 +121,65 @@ namespace SPSP::LocalLayers::ESPNOW
             ~EventFD();
         };
 
+        //! Maximum number of packets passed to receive callback at once
+        static constexpr size_t RECV_BATCH_LEN = 16;
+
+        /**
+         * @brief Received packet waiting for receive callback
+         *
+         */
+        struct RecvPacket
+        {
+            LocalAddrT src;                       //!< Source address
+            uint8_t data[MAX_PACKET_LENGTH] = {}; //!< Raw data
+            size_t len = 0;                       //!< Length of raw data
+            int rssi = 0;                         //!< Received signal strength indicator (in dBm)
+        };
+
+        /**
+         * @brief Batch of received packets (e.g. from one ring block)
+         *
+         */
+        struct RecvItem
+        {
+            RecvPacket packets[RECV_BATCH_LEN];   //!< Packets
+            size_t count = 0;                     //!< Number of packets
+        };
+
+        /**
+         * @brief Frame waiting for injection
+         *
+         */
+        struct SendItem
+        {
+            LocalAddrT dst;   //!< Destination address
+            uint8_t* data;    //!< Frame including radiotap header (in `TxFrame`)
+            size_t len;       //!< Frame length
+        };
+
         RawSocket m_sock;                               //!< Socket
         EventFD m_eventFd;                              //!< Epoll event file descriptor
         int m_epollFd;                                  //!< Epoll file descriptor
         LocalAddrT m_localAddr;                         //!< Cached local MAC address
         AdapterRecvCb m_recvCb = nullptr;               //!< Receive callback
+        AdapterRecvBatchCb m_recvBatchCb = nullptr;     //!< Batch receive callback
+        RecvItem m_recvBatch;                           //!< Batch being filled by handler
         AdapterSendCb m_sendCb = nullptr;               //!< Send callback
+        std::unique_ptr<WorkerPool<RecvItem>> m_recvPool;  //!< Workers running receive callback (if no executor is given)
+        IExecutor* m_executor;                          //!< Executor running receive callback (if given)
+        TaskGroup m_recvTasks;                          //!< Receive callbacks submitted to executor
+
+        std::mutex m_sendMutex;                         //!< Mutex protecting send queue
+        std::vector<SendItem> m_sendQueue;              //!< Ring buffer of frames to inject
+        size_t m_sendHead = 0;                          //!< Index of the oldest frame
+        size_t m_sendCount = 0;                         //!< Number of queued frames
+        EventFD m_sendEventFd;                          //!< Signals queued frames to handler
+        std::vector<mmsghdr> m_sendMsgs;                //!< Message headers for `sendmmsg()`
+        std::vector<iovec> m_sendIovs;                  //!< Vectors for `sendmmsg()`
+        std::vector<LocalAddrT> m_sendDone;             //!< Destinations of injected batch
+        bool m_sendWaitWritable = false;                //!< Whether `EPOLLOUT` is requested
+
+        std::atomic<bool> m_run = true;                 //!< Whether handler should continue
         std::thread m_thread;                           //!< Handler thread
 
     public:
@@ -67,11 +188,19 @@ namespace SPSP::LocalLayers::ESPNOW
          *
          * Starts packet capture on 802.11 interface identified by `ifname`.
          *
+         * Without executor, receive callbacks run in adapter's own
+         * preallocated worker pool (configured by `conf.recv`).
+         * With executor, batches of received packets are submitted to it
+         * without blocking (dropped when it's busy).
+         *
          * @param ifname Interface name (must be in monitor mode)
+         * @param conf Configuration
+         * @param executor Executor of receive callbacks (`nullptr` for own workers)
          *
          * @throw AdapterError when any call to underlaying library fails
          */
-        Adapter(const std::string& ifname);
+        Adapter(const std::string& ifname, const AdapterConfig& conf = {},
+                IExecutor* executor = nullptr);
 
         /**
          * @brief Destroys the adapter
@@ -82,7 +211,8 @@ namespace SPSP::LocalLayers::ESPNOW
         /**
          * @brief Sets receive callback
          *
-         * Callback should be called in new thread.
+         * Callback is called from one of receive worker threads
+         * (or from executor, if given).
          *
          * @param cb Callback
          */
@@ -95,6 +225,30 @@ namespace SPSP::LocalLayers::ESPNOW
          */
         AdapterRecvCb getRecvCb() const noexcept { return m_recvCb; }
 
+        /**
+         * @brief Checks whether receive callback is called from driver's context
+         *
+         * @return false Callback is called from receive workers
+         */
+        bool recvFromDriverContext() const noexcept { return false; }
+
+        /**
+         * @brief Sets batch receive callback
+         *
+         * Callback is called instead of receive callback, from one
+         * of receive worker threads (or from executor, if given).
+         *
+         * @param cb Callback
+         */
+        void setRecvBatchCb(AdapterRecvBatchCb cb) noexcept { m_recvBatchCb = cb; }
+
+        /**
+         * @brief Gets batch receive callback
+         *
+         * @return Callback
+         */
+        AdapterRecvBatchCb getRecvBatchCb() const noexcept { return m_recvBatchCb; }
+
         /**
          * @brief Sets send callback
          *
@@ -112,14 +266,19 @@ namespace SPSP::LocalLayers::ESPNOW
         /**
          * @brief Sends local message
          *
-         * Injects IEEE 802.11 packet onto the packet capture interface.
+         * Enqueues IEEE 802.11 packet for injection onto the packet capture
+         * interface. Radiotap and 802.11 headers are written into frame's
+         * headroom, so the packet isn't copied.
+         * Queued packets are injected in batches by handler thread, which
+         * also calls send callback (`delivered` is false when injection
+         * failed).
          *
          * @param dst Destination address
-         * @param data Raw data to be sent
-         * @throw AdapterError when call to send function fails
+         * @param frame Frame with packet to be sent
+         * @throw AdapterError when send queue is full
          *        (not when packet undelivered)
          */
-        void send(const LocalAddrT& dst, const std::string& data);
+        void send(const LocalAddrT& dst, TxFrame& frame);
 
         /**
          * @brief Adds peer to peer list
@@ -139,6 +298,28 @@ namespace SPSP::LocalLayers::ESPNOW
          */
         void removePeer(const LocalAddrT& peer) {}
 
+        /**
+         * @brief Gets maximum number of simultaneously registered peers
+         *
+         * There's no peer list on Linux platform, so this is limited only
+         * by capacity of send queue.
+         *
+         * @return Send queue capacity
+         */
+        size_t getMaxPeerNum() const noexcept { return m_sendQueue.size(); }
+
+        /**
+         * @brief Gets statistics of receive queue
+         *
+         * With executor, its queue statistics are returned.
+         *
+         * @return Statistics (queue depth and drop counters)
+         */
+        WorkerPoolStats getRecvStats()
+        {
+            return m_recvPool ? m_recvPool->getStats() : m_executor->getStats().queue;
+        }
+
     protected:
         /**
          * @brief Function of thread handling incoming packets
@@ -146,6 +327,37 @@ namespace SPSP::LocalLayers::ESPNOW
          */
         void handlerThread();
 
+        /**
+         * @brief Processes all blocks of receive ring owned by user space
+         *
+         * Frames are parsed directly in the ring, each block is returned
+         * to kernel afterwards. Packets of each block are passed
+         * to receive workers together.
+         */
+        void processRxRing();
+
+        /**
+         * @brief Passes batch of received packets to receive workers
+         *
+         */
+        void flushRecvBatch();
+
+        /**
+         * @brief Injects queued frames
+         *
+         * Runs until the send queue is empty or socket buffer is full
+         * (in that case `EPOLLOUT` is requested). Send callbacks are called
+         * for each injected frame.
+         */
+        void flushSendQueue();
+
+        /**
+         * @brief Requests or cancels `EPOLLOUT` notifications on the socket
+         *
+         * @param enable Whether to wait for socket to become writable
+         */
+        void waitWritable(bool enable);
+
         /**
          * @brief Attaches BPF filter to the socket
          *
@@ -190,5 +402,14 @@ namespace SPSP::LocalLayers::ESPNOW
          * @param rssi Received signal strength indicator (in dBm)
          */
         void processIEEE80211RawAck(const uint8_t* data, size_t len, int rssi);
+
+        /**
+         * @brief Passes batch of received packets to receive callback
+         *
+         * Called from receive worker thread.
+         *
+         * @param item Received packets
+         */
+        void recvWorker(RecvItem& item);
     };
 } // namespace SPSP::LocalLayers::ESPNOW
@@ -9,6 +9,9 @@
 
 #pragma once
 
+#include <string>
+#include <vector>
+
 #include "MQTTAsync.h"
 
 #include "spsp/mqtt_adapter_if.hpp"
@@ -24,6 +27,16 @@ namespace SPSP::FarLayers::MQTT
      */
     class Adapter : public IAdapter
     {
+        /**
+         * @brief Context of multi-topic subscribe request
+         *
+         */
+        struct SubscribeManyCtx
+        {
+            AdapterDoneCb cb;  //!< Completion callback
+            size_t count;      //!< Number of topics
+        };
+
         Config m_conf;                               //!< Configuration
         MQTTAsync m_mqtt;                            //!< MQTT client instance
         AdapterSubDataCb m_subDataCb = nullptr;      //!< Subscription data callback
@@ -80,6 +93,48 @@ namespace SPSP::FarLayers::MQTT
          */
         bool unsubscribe(const std::string& topic);
 
+        /**
+         * @brief Subscribes to given topic without waiting for result
+         *
+         * Callback is called from client library's thread.
+         *
+         * @param topic Topic
+         * @param cb Completion callback
+         */
+        void subscribeAsync(const std::string& topic, AdapterDoneCb cb);
+
+        /**
+         * @brief Unsubscribes from given topic without waiting for result
+         *
+         * Callback is called from client library's thread.
+         *
+         * @param topic Topic
+         * @param cb Completion callback
+         */
+        void unsubscribeAsync(const std::string& topic, AdapterDoneCb cb);
+
+        /**
+         * @brief Subscribes to many topics in single request
+         *
+         * Callback is called from client library's thread.
+         *
+         * @param topics Topics
+         * @param cb Completion callback
+         */
+        void subscribeManyAsync(const std::vector<std::string>& topics,
+                                AdapterDoneCb cb);
+
+        /**
+         * @brief Unsubscribes from many topics in single request
+         *
+         * Callback is called from client library's thread.
+         *
+         * @param topics Topics
+         * @param cb Completion callback
+         */
+        void unsubscribeManyAsync(const std::vector<std::string>& topics,
+                                  AdapterDoneCb cb);
+
         /**
          * @brief Sets callback for incoming subscription data
          *
@@ -162,6 +217,55 @@ namespace SPSP::FarLayers::MQTT
         static int subMsgCb(void* ctx, char* topic, int topicLen,
                             MQTTAsync_message* msg);
 
+        /**
+         * @brief Success callback of asynchronous request
+         *
+         * Passed to underlaying library.
+         *
+         * @param ctx Context (owned `AdapterDoneCb`)
+         * @param resp Response
+         */
+        static void doneSuccessCb(void* ctx, MQTTAsync_successData* resp);
+
+        /**
+         * @brief Failure callback of asynchronous request
+         *
+         * Passed to underlaying library.
+         *
+         * @param ctx Context (owned `AdapterDoneCb`)
+         * @param resp Response
+         */
+        static void doneFailureCb(void* ctx, MQTTAsync_failureData* resp);
+
+        /**
+         * @brief Calls completion callback and frees it
+         *
+         * @param ctx Context (owned `AdapterDoneCb`)
+         * @param success Whether request was successful
+         */
+        static void done(void* ctx, bool success);
+
+        /**
+         * @brief Success callback of multi-topic subscribe request
+         *
+         * Passed to underlaying library.
+         * Broker may refuse some topics even in successful response.
+         *
+         * @param ctx Context (owned `SubscribeManyCtx`)
+         * @param resp Response
+         */
+        static void subscribeManySuccessCb(void* ctx, MQTTAsync_successData* resp);
+
+        /**
+         * @brief Failure callback of multi-topic subscribe request
+         *
+         * Passed to underlaying library.
+         *
+         * @param ctx Context (owned `SubscribeManyCtx`)
+         * @param resp Response
+         */
+        static void subscribeManyFailureCb(void* ctx, MQTTAsync_failureData* resp);
+
         /**
          * @brief Helper to convert `std::string` to C string or `nullptr`
          *
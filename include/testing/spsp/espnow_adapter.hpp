@@ -14,6 +14,7 @@
 
 #include "spsp/espnow_adapter_if.hpp"
 #include "spsp/espnow_types.hpp"
+#include "spsp/executor.hpp"
 
 namespace SPSP::LocalLayers::ESPNOW
 {
@@ -24,14 +25,18 @@ namespace SPSP::LocalLayers::ESPNOW
     class Adapter : public IAdapter
     {
         AdapterRecvCb m_recvCb = nullptr;
+        AdapterRecvBatchCb m_recvBatchCb = nullptr;
         AdapterSendCb m_sendCb = nullptr;
         std::unordered_set<LocalAddrT> m_peers;
+        size_t m_maxPeerNum = MAX_PEER_NUM;
+        ThreadPoolExecutor m_sendExecutor{{.workers = 1}};  //!< Runs send callbacks (as driver would)
+        bool m_recvFromDriver = true;                        //!< Whether receive callback simulates driver's context
 
     public:
         /**
          * @brief Sets receive callback
          *
-         * Callback should be called in new thread.
+         * Callback may be called from driver's context.
          *
          * @param cb Callback
          */
@@ -50,6 +55,48 @@ namespace SPSP::LocalLayers::ESPNOW
             return m_recvCb;
         }
 
+        /**
+         * @brief Checks whether receive callback is called from driver's context
+         *
+         * @return Value set by `setRecvFromDriverContext()` (default `true`)
+         */
+        bool recvFromDriverContext() const noexcept
+        {
+            return m_recvFromDriver;
+        }
+
+        /**
+         * @brief Sets whether receive callback is called from driver's context
+         *
+         * Must be set before layer is constructed.
+         *
+         * @param fromDriver Whether receive callback is called from driver's context
+         */
+        void setRecvFromDriverContext(bool fromDriver) noexcept
+        {
+            m_recvFromDriver = fromDriver;
+        }
+
+        /**
+         * @brief Sets batch receive callback
+         *
+         * @param cb Callback
+         */
+        void setRecvBatchCb(AdapterRecvBatchCb cb) noexcept
+        {
+            m_recvBatchCb = cb;
+        }
+
+        /**
+         * @brief Gets batch receive callback
+         *
+         * @return Callback
+         */
+        AdapterRecvBatchCb getRecvBatchCb() const noexcept
+        {
+            return m_recvBatchCb;
+        }
+
         /**
          * @brief Sets send callback
          *
@@ -74,14 +121,15 @@ namespace SPSP::LocalLayers::ESPNOW
          * @brief Sends local message
          *
          * @param dst Destination address
-         * @param data Raw data to be sent
+         * @param frame Frame with packet to be sent
          * @throw AdapterError when call to send function fails
          *        (not when packet undelivered)
          */
-        virtual void send(const LocalAddrT& dst, const std::string& data) const
+        virtual void send(const LocalAddrT& dst, TxFrame& frame)
         {
-            std::thread t(this->getSendCb(), dst, true);
-            t.detach();
+            m_sendExecutor.execute([cb = this->getSendCb(), dst]() {
+                cb(dst, true);
+            });
         }
 
         /**
@@ -107,5 +155,35 @@ namespace SPSP::LocalLayers::ESPNOW
                 throw AdapterError("Can't remove non-existing peer");
             }
         }
+
+        /**
+         * @brief Gets number of registered peers
+         *
+         * @return Number of peers
+         */
+        size_t getPeerNum() const noexcept
+        {
+            return m_peers.size();
+        }
+
+        /**
+         * @brief Gets maximum number of simultaneously registered peers
+         *
+         * @return Maximum number of peers
+         */
+        size_t getMaxPeerNum() const noexcept
+        {
+            return m_maxPeerNum;
+        }
+
+        /**
+         * @brief Sets maximum number of simultaneously registered peers
+         *
+         * @param num Maximum number of peers
+         */
+        void setMaxPeerNum(size_t num) noexcept
+        {
+            m_maxPeerNum = num;
+        }
     };
 } // namespace SPSP::LocalLayers::ESPNOW
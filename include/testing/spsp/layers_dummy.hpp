@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include <mutex>
 #include <string>
 #include <tuple>
 #include <unordered_set>
@@ -103,6 +104,7 @@ namespace SPSP::FarLayers
         using SubsLogT = std::vector<std::string>;
 
     protected:
+        std::mutex m_mutex;  //!< Mutex (bridge shards call far layer concurrently)
         PubsSetT m_pubs;
         SubsSetT m_subs;
         SubsLogT m_subsLog;
@@ -121,6 +123,8 @@ namespace SPSP::FarLayers
         virtual bool publish(const std::string& src, const std::string& topic,
                              const std::string& payload)
         {
+            const std::scoped_lock lock(m_mutex);
+
             // `LocalMessage.toString()`-compatible string
             m_pubs.insert("PUB " + src + " " + topic + " " + payload);
             return true;
@@ -135,6 +139,8 @@ namespace SPSP::FarLayers
          */
         virtual bool subscribe(const std::string& topic)
         {
+            const std::scoped_lock lock(m_mutex);
+
             m_subs.insert(topic);
             m_subsLog.push_back(topic);
             return true;
@@ -149,6 +155,8 @@ namespace SPSP::FarLayers
          */
         virtual bool unsubscribe(const std::string& topic)
         {
+            const std::scoped_lock lock(m_mutex);
+
             m_unsubsLog.push_back(topic);
             return m_subs.erase(topic);
         }
@@ -170,40 +178,44 @@ namespace SPSP::FarLayers
         /**
          * @brief Returns current publishes set
          *
-         * @return Publishes set
+         * @return Publishes set (copy)
          */
-        const PubsSetT& getPubs()
+        PubsSetT getPubs()
         {
+            const std::scoped_lock lock(m_mutex);
             return m_pubs;
         }
 
         /**
          * @brief Returns current subscriptions set
          *
-         * @return Subscriptions set
+         * @return Subscriptions set (copy)
          */
-        const SubsSetT& getSubs()
+        SubsSetT getSubs()
         {
+            const std::scoped_lock lock(m_mutex);
             return m_subs;
         }
 
         /**
          * @brief Returns current subscriptions log
          *
-         * @return Subscriptions log
+         * @return Subscriptions log (copy)
          */
-        const SubsLogT& getSubsLog()
+        SubsLogT getSubsLog()
         {
+            const std::scoped_lock lock(m_mutex);
             return m_subsLog;
         }
 
         /**
          * @brief Returns current unsubscriptions log
          *
-         * @return Unsubscriptions log
+         * @return Unsubscriptions log (copy)
          */
-        const SubsLogT& getUnsubsLog()
+        SubsLogT getUnsubsLog()
         {
+            const std::scoped_lock lock(m_mutex);
             return m_unsubsLog;
         }
     };
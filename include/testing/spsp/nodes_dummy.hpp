@@ -24,6 +24,7 @@ namespace SPSP::Nodes
     public:
         using LocalAddrT = typename TLocalLayer::LocalAddrT;
         using LocalMessageT = typename TLocalLayer::LocalMessageT;
+        using LocalMessageViewT = LocalMessageView<LocalAddrT>;
 
         using ILocalNode<TLocalLayer>::ILocalNode;
 
@@ -37,28 +38,28 @@ namespace SPSP::Nodes
         virtual void resubscribeAll() {}
 
     protected:
-        virtual bool processProbeReq(const LocalMessageT& req,
+        virtual bool processProbeReq(const LocalMessageViewT& req,
                                      int rssi = NODE_RSSI_UNKNOWN) { return true; }
 
-        virtual bool processProbeRes(const LocalMessageT& req,
+        virtual bool processProbeRes(const LocalMessageViewT& req,
                                      int rssi = NODE_RSSI_UNKNOWN) { return true; }
 
-        virtual bool processPub(const LocalMessageT& req,
+        virtual bool processPub(const LocalMessageViewT& req,
                                 int rssi = NODE_RSSI_UNKNOWN) { return true; }
 
-        virtual bool processSubReq(const LocalMessageT& req,
+        virtual bool processSubReq(const LocalMessageViewT& req,
                                    int rssi = NODE_RSSI_UNKNOWN) { return true; }
 
-        virtual bool processSubData(const LocalMessageT& req,
+        virtual bool processSubData(const LocalMessageViewT& req,
                                     int rssi = NODE_RSSI_UNKNOWN) { return true; }
 
-        virtual bool processUnsub(const LocalMessageT& req,
+        virtual bool processUnsub(const LocalMessageViewT& req,
                                   int rssi = NODE_RSSI_UNKNOWN) { return true; }
 
-        virtual bool processTimeReq(const LocalMessageT& req,
-                                     int rssi = NODE_RSSI_UNKNOWN) { return true; }
+        virtual bool processTimeReq(const LocalMessageViewT& req,
+                                    int rssi = NODE_RSSI_UNKNOWN) { return true; }
 
-        virtual bool processTimeRes(const LocalMessageT& req,
-                                     int rssi = NODE_RSSI_UNKNOWN) { return true; }
+        virtual bool processTimeRes(const LocalMessageViewT& req,
+                                    int rssi = NODE_RSSI_UNKNOWN) { return true; }
     };
 } // namespace SPSP::Nodes
@@ -68,6 +68,24 @@ void setLogLevel(const std::string& logLevelStr)
     }
 }
 
+/**
+ * @brief Parses overflow policy of bounded queue
+ *
+ * @param policyStr Overflow policy string
+ * @return Overflow policy
+ *
+ * @throw std::runtime_error If policyStr is invalid.
+ */
+SPSP::OverflowPolicy parseOverflowPolicy(const std::string& policyStr)
+{
+    if      (policyStr == "drop_oldest") return SPSP::OverflowPolicy::DROP_OLDEST;
+    else if (policyStr == "drop_newest") return SPSP::OverflowPolicy::DROP_NEWEST;
+    else if (policyStr == "block")       return SPSP::OverflowPolicy::BLOCK;
+    else {
+        throw std::runtime_error("Invalid overflow policy '" + policyStr + "'");
+    }
+}
+
 void printHelp()
 {
     std::cerr << "Usage: spsp_bridge_espnow CONFIG_FILE.ini" << std::endl
@@ -96,6 +114,7 @@ int main(int argc, char const* argv[])
     std::string iface;
     FarLayer farLayer;
     SPSP::LocalLayers::ESPNOW::Config espnowConfig = {};
+    SPSP::LocalLayers::ESPNOW::AdapterConfig espnowAdapterConfig = {};
     SPSP::FarLayers::MQTT::Config mqttConfig = {};
     std::string localBrokerTopicPrefix;
 
@@ -123,6 +142,23 @@ int main(int argc, char const* argv[])
             throw std::runtime_error("ESP-NOW password must be 32 bytes long");
         }
 
+        // ESP-NOW adapter config
+        std::string recvOverflowStr = "drop_oldest";
+        SAVE_OPTION(espnowAdapterConfig.recv.workers, "espnow", "recv_workers", size_t);
+        SAVE_OPTION(espnowAdapterConfig.recv.queueSize, "espnow", "recv_queue_size", size_t);
+        SAVE_OPTION(recvOverflowStr, "espnow", "recv_queue_overflow", std::string);
+        espnowAdapterConfig.recv.overflow = parseOverflowPolicy(recvOverflowStr);
+
+        SAVE_OPTION(espnowAdapterConfig.send.queueSize, "espnow", "send_queue_size", size_t);
+        SAVE_OPTION(espnowAdapterConfig.send.batchSize, "espnow", "send_batch_size", size_t);
+
+        auto rxRingTimeoutMs = espnowAdapterConfig.rxRing.blockTimeout.count();
+        SAVE_OPTION(espnowAdapterConfig.rxRing.enabled, "espnow", "rx_ring", bool);
+        SAVE_OPTION(espnowAdapterConfig.rxRing.blockSize, "espnow", "rx_ring_block_size", size_t);
+        SAVE_OPTION(espnowAdapterConfig.rxRing.blockNum, "espnow", "rx_ring_block_num", size_t);
+        SAVE_OPTION(rxRingTimeoutMs, "espnow", "rx_ring_block_timeout", typeof(rxRingTimeoutMs));
+        espnowAdapterConfig.rxRing.blockTimeout = std::chrono::milliseconds(rxRingTimeoutMs);
+
         // MQTT config
         auto timeoutMs = mqttConfig.connection.timeout.count();
         SAVE_OPTION(mqttConfig.connection.uri, "mqtt", "uri", std::string);
@@ -153,7 +189,7 @@ int main(int argc, char const* argv[])
     try {
         // Initialize ESP-NOW
         SPSP::WiFi::Dummy wifi;
-        SPSP::LocalLayers::ESPNOW::Adapter llAdapter{iface};
+        SPSP::LocalLayers::ESPNOW::Adapter llAdapter{iface, espnowAdapterConfig};
         SPSP::LocalLayers::ESPNOW::ESPNOW ll{llAdapter, wifi, espnowConfig};
 
         if (farLayer == FL_MQTT) {
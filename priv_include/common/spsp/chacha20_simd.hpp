@@ -0,0 +1,157 @@
+/**
+ * @file chacha20_simd.hpp
+ * @author Dávid Benko (davidbenko@davidbenko.dev)
+ * @brief Vectorized ChaCha20 with fused additive checksum
+ *
+ * Same cipher as `chacha20.hpp` (64-bit nonce, 64-bit block counter), but
+ * generates up to four keystream blocks at once using SSE2, AVX2 or NEON.
+ * Best implementation available on the running CPU is selected at runtime,
+ * portable scalar implementation is used otherwise.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace SPSP::ChaCha20
+{
+    static constexpr size_t KEY_LEN = 32;     //!< Key length in bytes
+    static constexpr size_t NONCE_LEN = 8;    //!< Nonce length in bytes
+    static constexpr size_t BLOCK_LEN = 64;   //!< Keystream block length in bytes
+
+    /**
+     * @brief Implementation of keystream generator
+     *
+     */
+    enum class Impl : uint8_t
+    {
+        SCALAR = 0,  //!< Portable implementation (always available)
+        SSE2   = 1,  //!< 4 blocks in parallel using SSE2 (x86)
+        AVX2   = 2,  //!< 4 blocks in parallel using AVX2 (x86)
+        NEON   = 3,  //!< 4 blocks in parallel using NEON (ARM)
+    };
+
+    /**
+     * @brief Direction of crypt operation
+     *
+     * Affects only which side is checksummed (always the plaintext).
+     */
+    enum class Direction : uint8_t
+    {
+        ENCRYPT = 0,  //!< Input is plaintext
+        DECRYPT = 1,  //!< Output is plaintext
+    };
+
+    /**
+     * @brief Cipher state (key, nonce and counter)
+     *
+     */
+    struct State
+    {
+        uint32_t words[16];  //!< ChaCha20 input block
+
+        /**
+         * @brief Constructs a new uninitialized state
+         *
+         */
+        State() noexcept = default;
+
+        /**
+         * @brief Constructs a new state
+         *
+         * @param key Key (`KEY_LEN` bytes)
+         * @param nonce Nonce (`NONCE_LEN` bytes)
+         * @param counter Initial block counter
+         */
+        State(const uint8_t* key, const uint8_t* nonce, uint64_t counter = 0) noexcept;
+
+        /**
+         * @brief Sets nonce and counter, keeping the key
+         *
+         * Allows reusing precomputed key state.
+         *
+         * @param nonce Nonce (`NONCE_LEN` bytes)
+         * @param counter Initial block counter
+         */
+        void setNonce(const uint8_t* nonce, uint64_t counter = 0) noexcept;
+    };
+
+    /**
+     * @brief Buffer for batch encryption/decryption
+     *
+     */
+    struct BatchItem
+    {
+        State state;           //!< Cipher state of this buffer
+        uint8_t* data;         //!< Data to encrypt/decrypt
+        size_t dataLen;        //!< Length of data
+        Direction dir;         //!< Direction
+        uint8_t checksum = 0;  //!< Output: additive checksum of plaintext
+    };
+
+    /**
+     * @brief Converts implementation to string
+     *
+     * @param impl Implementation
+     * @return String representation
+     */
+    const char* implToStr(Impl impl) noexcept;
+
+    /**
+     * @brief Checks whether implementation can run on this CPU
+     *
+     * @param impl Implementation
+     * @return true Implementation is available
+     * @return false Implementation is not available
+     */
+    bool implAvailable(Impl impl) noexcept;
+
+    /**
+     * @brief Gets currently used implementation
+     *
+     * Best available one unless changed by `setImpl()`.
+     *
+     * @return Implementation
+     */
+    Impl getImpl() noexcept;
+
+    /**
+     * @brief Forces implementation (primarily for testing)
+     *
+     * @param impl Implementation
+     * @return true Implementation is now used
+     * @return false Implementation is not available, nothing changed
+     */
+    bool setImpl(Impl impl) noexcept;
+
+    /**
+     * @brief Encrypts/decrypts data in-place and checksums plaintext
+     *
+     * Keystream XOR and checksum are done in a single pass over data.
+     * Checksum is sum of all plaintext bytes modulo 256.
+     *
+     * @param state Cipher state (not modified, counter of keystream starts there)
+     * @param data Data to encrypt/decrypt
+     * @param dataLen Length of data
+     * @param dir Direction (which side of data is plaintext)
+     * @return Additive checksum of plaintext
+     */
+    uint8_t cryptChecksum(const State& state, uint8_t* data, size_t dataLen,
+                          Direction dir) noexcept;
+
+    /**
+     * @brief Encrypts/decrypts many buffers in-place and checksums plaintext
+     *
+     * Same as calling `cryptChecksum()` on each item, but vectorized
+     * implementations put each buffer into separate lane, so that short
+     * buffers (i.e. ESP-NOW packets) don't leave lanes idle.
+     *
+     * @param items Buffers (`checksum` is filled)
+     * @param count Number of buffers
+     */
+    void cryptChecksumBatch(BatchItem* items, size_t count) noexcept;
+} // namespace SPSP::ChaCha20
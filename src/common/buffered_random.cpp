@@ -0,0 +1,132 @@
+/**
+ * @file buffered_random.cpp
+ * @author Dávid Benko (davidbenko@davidbenko.dev)
+ * @brief Buffered cryptographically secure random generator
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#if defined(__unix__)
+#include <pthread.h>
+#endif
+
+#include "spsp/buffered_random.hpp"
+#include "spsp/chacha20_simd.hpp"
+
+namespace SPSP
+{
+    namespace
+    {
+        //! Length of keystream generated at once
+        constexpr size_t CHUNK_LEN = 256;
+
+        //! Incremented in child process after `fork()`
+        std::atomic<uint64_t> g_forkGeneration = 0;
+
+        /**
+         * @brief Per-thread generator state
+         *
+         */
+        struct ThreadState
+        {
+            uint8_t key[ChaCha20::KEY_LEN] = {};  //!< Current key
+            uint8_t chunk[CHUNK_LEN] = {};        //!< Generated keystream
+            size_t pos = CHUNK_LEN;               //!< Position of first unused byte in `chunk`
+            uint64_t generated = 0;               //!< Bytes generated since reseeding
+            uint64_t forkGeneration = 0;          //!< `g_forkGeneration` when seeded
+            bool seeded = false;                  //!< Whether state has been seeded
+
+            ~ThreadState()
+            {
+                // Don't leave key material nor unused output in freed memory
+                secureZero(key, sizeof(key));
+                secureZero(chunk, sizeof(chunk));
+            }
+
+            /**
+             * @brief Zeroes memory (not optimized away)
+             *
+             * @param buf Buffer
+             * @param len Length of buffer
+             */
+            static void secureZero(uint8_t* buf, size_t len) noexcept
+            {
+                volatile uint8_t* p = buf;
+                for (size_t i = 0; i < len; i++) p[i] = 0;
+            }
+
+            /**
+             * @brief Generates next chunk of keystream
+             *
+             * First bytes of the chunk immediately replace the key.
+             */
+            void refill() noexcept
+            {
+                static const uint8_t zeroNonce[ChaCha20::NONCE_LEN] = {};
+
+                memset(chunk, 0, CHUNK_LEN);
+                ChaCha20::cryptChecksum(ChaCha20::State{key, zeroNonce}, chunk,
+                                        CHUNK_LEN, ChaCha20::Direction::ENCRYPT);
+
+                memcpy(key, chunk, ChaCha20::KEY_LEN);
+                memset(chunk, 0, ChaCha20::KEY_LEN);
+                pos = ChaCha20::KEY_LEN;
+            }
+        };
+
+        thread_local ThreadState t_state;
+
+        void registerForkHandler() noexcept
+        {
+#if defined(__unix__)
+            static const bool registered = [] {
+                pthread_atfork(nullptr, nullptr, [] { g_forkGeneration++; });
+                return true;
+            }();
+            (void) registered;
+#endif
+        }
+    } // namespace
+
+    void BufferedRandom::bytes(void* buf, size_t len) const
+    {
+        registerForkHandler();
+
+        auto& s = t_state;
+        uint64_t forkGeneration = g_forkGeneration.load(std::memory_order_relaxed);
+
+        // (Re)seed
+        if (!s.seeded || s.generated >= RESEED_INTERVAL
+            || s.forkGeneration != forkGeneration) {
+            m_seedSource.bytes(s.key, sizeof(s.key));
+            s.pos = CHUNK_LEN;
+            s.generated = 0;
+            s.forkGeneration = forkGeneration;
+            s.seeded = true;
+        }
+
+        auto out = static_cast<uint8_t*>(buf);
+
+        while (len > 0) {
+            if (s.pos == CHUNK_LEN) {
+                s.refill();
+            }
+
+            size_t n = std::min(len, CHUNK_LEN - s.pos);
+            memcpy(out, s.chunk + s.pos, n);
+
+            // Returned bytes must not stay in memory
+            memset(s.chunk + s.pos, 0, n);
+
+            s.pos += n;
+            s.generated += n;
+            out += n;
+            len -= n;
+        }
+    }
+} // namespace SPSP
@@ -0,0 +1,727 @@
+/**
+ * @file chacha20_simd.cpp
+ * @author Dávid Benko (davidbenko@davidbenko.dev)
+ * @brief Vectorized ChaCha20 with fused additive checksum
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#include "spsp/chacha20_simd.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SPSP_CHACHA20_X86
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define SPSP_CHACHA20_NEON
+#include <arm_neon.h>
+#endif
+
+namespace SPSP::ChaCha20
+{
+    namespace
+    {
+        //! Number of blocks generated at once by vectorized implementations
+        constexpr size_t PARALLEL_BLOCKS = 4;
+        constexpr size_t PARALLEL_LEN = PARALLEL_BLOCKS * BLOCK_LEN;
+
+        uint32_t rotl32(uint32_t x, int n) { return (x << n) | (x >> (32 - n)); }
+
+        uint32_t pack4(const uint8_t* a)
+        {
+            return uint32_t(a[0]) | uint32_t(a[1]) << 8 | uint32_t(a[2]) << 16
+                   | uint32_t(a[3]) << 24;
+        }
+
+        uint64_t getCounter(const State& s)
+        {
+            return uint64_t(s.words[12]) | uint64_t(s.words[13]) << 32;
+        }
+
+        /**
+         * @brief XORs keystream into data and checksums plaintext
+         *
+         * Scalar version, also used for tails of vectorized versions.
+         */
+        uint8_t xorChecksumScalar(uint8_t* data, const uint8_t* ks, size_t len,
+                                  Direction dir)
+        {
+            uint8_t sum = 0;
+
+            for (size_t i = 0; i < len; i++) {
+                uint8_t in = data[i];
+                data[i] = in ^ ks[i];
+                sum += dir == Direction::ENCRYPT ? in : data[i];
+            }
+
+            return sum;
+        }
+
+        /**
+         * @brief Generates single keystream block
+         *
+         */
+        void blockScalar(const uint32_t in[16], uint64_t counter, uint8_t out[BLOCK_LEN])
+        {
+            uint32_t x[16];
+            memcpy(x, in, sizeof(x));
+            x[12] = uint32_t(counter);
+            x[13] = uint32_t(counter >> 32);
+
+            uint32_t orig[16];
+            memcpy(orig, x, sizeof(x));
+
+#define SPSP_CHACHA20_QR(a, b, c, d) \
+    x[a] += x[b]; x[d] = rotl32(x[d] ^ x[a], 16); \
+    x[c] += x[d]; x[b] = rotl32(x[b] ^ x[c], 12); \
+    x[a] += x[b]; x[d] = rotl32(x[d] ^ x[a], 8); \
+    x[c] += x[d]; x[b] = rotl32(x[b] ^ x[c], 7);
+
+            for (int i = 0; i < 10; i++) {
+                SPSP_CHACHA20_QR(0, 4, 8, 12)
+                SPSP_CHACHA20_QR(1, 5, 9, 13)
+                SPSP_CHACHA20_QR(2, 6, 10, 14)
+                SPSP_CHACHA20_QR(3, 7, 11, 15)
+                SPSP_CHACHA20_QR(0, 5, 10, 15)
+                SPSP_CHACHA20_QR(1, 6, 11, 12)
+                SPSP_CHACHA20_QR(2, 7, 8, 13)
+                SPSP_CHACHA20_QR(3, 4, 9, 14)
+            }
+
+#undef SPSP_CHACHA20_QR
+
+            for (size_t i = 0; i < 16; i++) {
+                uint32_t w = x[i] + orig[i];
+                out[i*4 + 0] = w & 0xff;
+                out[i*4 + 1] = (w >> 8) & 0xff;
+                out[i*4 + 2] = (w >> 16) & 0xff;
+                out[i*4 + 3] = (w >> 24) & 0xff;
+            }
+        }
+
+        uint8_t cryptChecksumScalar(const State& s, uint8_t* data, size_t len,
+                                    Direction dir)
+        {
+            uint64_t counter = getCounter(s);
+            uint8_t ks[BLOCK_LEN];
+            uint8_t sum = 0;
+
+            while (len > 0) {
+                size_t n = std::min(len, BLOCK_LEN);
+                blockScalar(s.words, counter++, ks);
+                sum += xorChecksumScalar(data, ks, n, dir);
+                data += n;
+                len -= n;
+            }
+
+            return sum;
+        }
+
+        /**
+         * @brief Input words of independent blocks, one row per vector
+         *
+         * @tparam LANES Number of blocks (vector lanes)
+         */
+        template <size_t LANES>
+        struct LaneInput
+        {
+            alignas(32) uint32_t w[16][LANES];
+        };
+
+        template <size_t LANES>
+        void setLane(LaneInput<LANES>& in, size_t lane, const uint32_t words[16],
+                     uint64_t counter)
+        {
+            for (size_t i = 0; i < 16; i++) in.w[i][lane] = words[i];
+            in.w[12][lane] = uint32_t(counter);
+            in.w[13][lane] = uint32_t(counter >> 32);
+        }
+
+        template <size_t LANES>
+        using BlocksFn = void (*)(const LaneInput<LANES>& in, uint8_t* out);
+        using XorChecksumFn = uint8_t (*)(uint8_t* data, const uint8_t* ks,
+                                          size_t len, Direction dir);
+
+        /**
+         * @brief Encrypts/decrypts `LANES` buffers at once
+         *
+         * Each lane of the keystream generator works on a different buffer,
+         * so short buffers (up to a few blocks) keep all lanes busy.
+         */
+        template <size_t LANES>
+        void cryptChecksumBatchLanes(BatchItem* items, size_t count,
+                                     BlocksFn<LANES> blocks,
+                                     XorChecksumFn xorChecksum)
+        {
+            LaneInput<LANES> in;
+            alignas(32) uint8_t ks[LANES * BLOCK_LEN];
+
+            for (size_t first = 0; first < count; first += LANES) {
+                BatchItem* group = items + first;
+                size_t lanes = std::min(LANES, count - first);
+                size_t maxLen = 0;
+
+                for (size_t k = 0; k < lanes; k++) {
+                    group[k].checksum = 0;
+                    maxLen = std::max(maxLen, group[k].dataLen);
+                }
+
+                for (size_t off = 0, block = 0; off < maxLen; off += BLOCK_LEN, block++) {
+                    // Idle lanes just repeat the first buffer
+                    for (size_t k = 0; k < LANES; k++) {
+                        const State& state = group[k < lanes ? k : 0].state;
+                        setLane(in, k, state.words, getCounter(state) + block);
+                    }
+
+                    blocks(in, ks);
+
+                    for (size_t k = 0; k < lanes; k++) {
+                        auto& item = group[k];
+                        if (item.dataLen <= off) continue;
+
+                        size_t n = std::min(item.dataLen - off, BLOCK_LEN);
+                        item.checksum += xorChecksum(item.data + off,
+                                                     ks + k*BLOCK_LEN, n,
+                                                     item.dir);
+                    }
+                }
+            }
+        }
+
+#ifdef SPSP_CHACHA20_X86
+
+        /**
+         * @brief Generates 4 keystream blocks using SSE2
+         *
+         * Each vector holds the same state word of all 4 blocks, which may
+         * belong to the same or to different streams.
+         */
+        __attribute__((target("sse2")))
+        void blocksSSE2(const LaneInput<4>& in, uint8_t* out)
+        {
+            __m128i x[16], orig[16];
+
+            for (size_t i = 0; i < 16; i++) {
+                x[i] = orig[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in.w[i]));
+            }
+
+#define SPSP_CHACHA20_ROTL(v, n) \
+    _mm_or_si128(_mm_slli_epi32(v, n), _mm_srli_epi32(v, 32 - (n)))
+#define SPSP_CHACHA20_QR(a, b, c, d) \
+    x[a] = _mm_add_epi32(x[a], x[b]); x[d] = SPSP_CHACHA20_ROTL(_mm_xor_si128(x[d], x[a]), 16); \
+    x[c] = _mm_add_epi32(x[c], x[d]); x[b] = SPSP_CHACHA20_ROTL(_mm_xor_si128(x[b], x[c]), 12); \
+    x[a] = _mm_add_epi32(x[a], x[b]); x[d] = SPSP_CHACHA20_ROTL(_mm_xor_si128(x[d], x[a]), 8); \
+    x[c] = _mm_add_epi32(x[c], x[d]); x[b] = SPSP_CHACHA20_ROTL(_mm_xor_si128(x[b], x[c]), 7);
+
+            for (int i = 0; i < 10; i++) {
+                SPSP_CHACHA20_QR(0, 4, 8, 12)
+                SPSP_CHACHA20_QR(1, 5, 9, 13)
+                SPSP_CHACHA20_QR(2, 6, 10, 14)
+                SPSP_CHACHA20_QR(3, 7, 11, 15)
+                SPSP_CHACHA20_QR(0, 5, 10, 15)
+                SPSP_CHACHA20_QR(1, 6, 11, 12)
+                SPSP_CHACHA20_QR(2, 7, 8, 13)
+                SPSP_CHACHA20_QR(3, 4, 9, 14)
+            }
+
+#undef SPSP_CHACHA20_QR
+#undef SPSP_CHACHA20_ROTL
+
+            for (size_t i = 0; i < 16; i++) x[i] = _mm_add_epi32(x[i], orig[i]);
+
+            // Transpose 4x4 words to get consecutive blocks
+            for (size_t i = 0; i < 16; i += 4) {
+                __m128i t0 = _mm_unpacklo_epi32(x[i], x[i + 1]);
+                __m128i t1 = _mm_unpacklo_epi32(x[i + 2], x[i + 3]);
+                __m128i t2 = _mm_unpackhi_epi32(x[i], x[i + 1]);
+                __m128i t3 = _mm_unpackhi_epi32(x[i + 2], x[i + 3]);
+
+                auto dst = out + i*4;
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 0*BLOCK_LEN), _mm_unpacklo_epi64(t0, t1));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 1*BLOCK_LEN), _mm_unpackhi_epi64(t0, t1));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2*BLOCK_LEN), _mm_unpacklo_epi64(t2, t3));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 3*BLOCK_LEN), _mm_unpackhi_epi64(t2, t3));
+            }
+        }
+
+        __attribute__((target("sse2")))
+        uint8_t xorChecksumSSE2(uint8_t* data, const uint8_t* ks, size_t len,
+                                Direction dir)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            __m128i acc = zero;
+            size_t i = 0;
+
+            // Bytewise accumulation wraps modulo 256, which is what we want
+            for (; i + 16 <= len; i += 16) {
+                auto p = reinterpret_cast<__m128i*>(data + i);
+                __m128i in = _mm_loadu_si128(p);
+                __m128i out = _mm_xor_si128(in, _mm_loadu_si128(reinterpret_cast<const __m128i*>(ks + i)));
+                _mm_storeu_si128(p, out);
+                acc = _mm_add_epi8(acc, dir == Direction::ENCRYPT ? in : out);
+            }
+
+            __m128i sums = _mm_sad_epu8(acc, zero);
+            uint8_t sum = static_cast<uint8_t>(_mm_cvtsi128_si32(sums)
+                                               + _mm_extract_epi16(sums, 4));
+
+            return sum + xorChecksumScalar(data + i, ks + i, len - i, dir);
+        }
+
+        __attribute__((target("sse2")))
+        uint8_t cryptChecksumSSE2(const State& s, uint8_t* data, size_t len,
+                                  Direction dir)
+        {
+            uint64_t counter = getCounter(s);
+            LaneInput<PARALLEL_BLOCKS> in;
+            alignas(16) uint8_t ks[PARALLEL_LEN];
+            uint8_t sum = 0;
+
+            while (len > 0) {
+                size_t n = std::min(len, PARALLEL_LEN);
+                for (size_t k = 0; k < PARALLEL_BLOCKS; k++) {
+                    setLane(in, k, s.words, counter + k);
+                }
+                blocksSSE2(in, ks);
+                counter += PARALLEL_BLOCKS;
+                sum += xorChecksumSSE2(data, ks, n, dir);
+                data += n;
+                len -= n;
+            }
+
+            return sum;
+        }
+
+        /**
+         * @brief Generates 4 keystream blocks using AVX2
+         *
+         * Each vector holds one row of 2 blocks, two sets of vectors are
+         * processed interleaved.
+         */
+        __attribute__((target("avx2")))
+        void blocksAVX2(const uint32_t in[16], uint64_t counter, uint8_t out[PARALLEL_LEN])
+        {
+            const __m256i rot16 = _mm256_setr_epi8(
+                2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+                2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+            const __m256i rot8 = _mm256_setr_epi8(
+                3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14,
+                3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14);
+
+            auto rows = reinterpret_cast<const __m128i*>(in);
+            const __m256i a = _mm256_broadcastsi128_si256(_mm_loadu_si128(rows + 0));
+            const __m256i b = _mm256_broadcastsi128_si256(_mm_loadu_si128(rows + 1));
+            const __m256i c = _mm256_broadcastsi128_si256(_mm_loadu_si128(rows + 2));
+
+            uint32_t d[PARALLEL_BLOCKS][4];
+            for (size_t i = 0; i < PARALLEL_BLOCKS; i++) {
+                d[i][0] = uint32_t(counter + i);
+                d[i][1] = uint32_t((counter + i) >> 32);
+                d[i][2] = in[14];
+                d[i][3] = in[15];
+            }
+            const __m256i d0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(d[0]));
+            const __m256i d1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(d[2]));
+
+            __m256i a0 = a, b0 = b, c0 = c, x0 = d0;
+            __m256i a1 = a, b1 = b, c1 = c, x1 = d1;
+
+#define SPSP_CHACHA20_ROTL(v, n) \
+    _mm256_or_si256(_mm256_slli_epi32(v, n), _mm256_srli_epi32(v, 32 - (n)))
+#define SPSP_CHACHA20_QR(a, b, c, d) \
+    a = _mm256_add_epi32(a, b); d = _mm256_shuffle_epi8(_mm256_xor_si256(d, a), rot16); \
+    c = _mm256_add_epi32(c, d); b = SPSP_CHACHA20_ROTL(_mm256_xor_si256(b, c), 12); \
+    a = _mm256_add_epi32(a, b); d = _mm256_shuffle_epi8(_mm256_xor_si256(d, a), rot8); \
+    c = _mm256_add_epi32(c, d); b = SPSP_CHACHA20_ROTL(_mm256_xor_si256(b, c), 7);
+#define SPSP_CHACHA20_SHUFFLE(b, c, d, sb, sc, sd) \
+    b = _mm256_shuffle_epi32(b, sb); \
+    c = _mm256_shuffle_epi32(c, sc); \
+    d = _mm256_shuffle_epi32(d, sd);
+
+            for (int i = 0; i < 10; i++) {
+                // Columns
+                SPSP_CHACHA20_QR(a0, b0, c0, x0)
+                SPSP_CHACHA20_QR(a1, b1, c1, x1)
+
+                // Diagonals
+                SPSP_CHACHA20_SHUFFLE(b0, c0, x0, 0x39, 0x4e, 0x93)
+                SPSP_CHACHA20_SHUFFLE(b1, c1, x1, 0x39, 0x4e, 0x93)
+                SPSP_CHACHA20_QR(a0, b0, c0, x0)
+                SPSP_CHACHA20_QR(a1, b1, c1, x1)
+                SPSP_CHACHA20_SHUFFLE(b0, c0, x0, 0x93, 0x4e, 0x39)
+                SPSP_CHACHA20_SHUFFLE(b1, c1, x1, 0x93, 0x4e, 0x39)
+            }
+
+#undef SPSP_CHACHA20_SHUFFLE
+#undef SPSP_CHACHA20_QR
+#undef SPSP_CHACHA20_ROTL
+
+            a0 = _mm256_add_epi32(a0, a); b0 = _mm256_add_epi32(b0, b);
+            c0 = _mm256_add_epi32(c0, c); x0 = _mm256_add_epi32(x0, d0);
+            a1 = _mm256_add_epi32(a1, a); b1 = _mm256_add_epi32(b1, b);
+            c1 = _mm256_add_epi32(c1, c); x1 = _mm256_add_epi32(x1, d1);
+
+            // Lower lanes belong to even blocks, upper lanes to odd blocks
+            auto dst = reinterpret_cast<__m256i*>(out);
+            _mm256_storeu_si256(dst + 0, _mm256_permute2x128_si256(a0, b0, 0x20));
+            _mm256_storeu_si256(dst + 1, _mm256_permute2x128_si256(c0, x0, 0x20));
+            _mm256_storeu_si256(dst + 2, _mm256_permute2x128_si256(a0, b0, 0x31));
+            _mm256_storeu_si256(dst + 3, _mm256_permute2x128_si256(c0, x0, 0x31));
+            _mm256_storeu_si256(dst + 4, _mm256_permute2x128_si256(a1, b1, 0x20));
+            _mm256_storeu_si256(dst + 5, _mm256_permute2x128_si256(c1, x1, 0x20));
+            _mm256_storeu_si256(dst + 6, _mm256_permute2x128_si256(a1, b1, 0x31));
+            _mm256_storeu_si256(dst + 7, _mm256_permute2x128_si256(c1, x1, 0x31));
+        }
+
+        __attribute__((target("avx2")))
+        uint8_t xorChecksumAVX2(uint8_t* data, const uint8_t* ks, size_t len,
+                                Direction dir)
+        {
+            const __m256i zero = _mm256_setzero_si256();
+            __m256i acc = zero;
+            size_t i = 0;
+
+            for (; i + 32 <= len; i += 32) {
+                auto p = reinterpret_cast<__m256i*>(data + i);
+                __m256i in = _mm256_loadu_si256(p);
+                __m256i out = _mm256_xor_si256(in, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ks + i)));
+                _mm256_storeu_si256(p, out);
+                acc = _mm256_add_epi8(acc, dir == Direction::ENCRYPT ? in : out);
+            }
+
+            __m256i sums256 = _mm256_sad_epu8(acc, zero);
+            __m128i sums = _mm_add_epi64(_mm256_castsi256_si128(sums256),
+                                         _mm256_extracti128_si256(sums256, 1));
+            uint8_t sum = static_cast<uint8_t>(_mm_cvtsi128_si32(sums)
+                                               + _mm_extract_epi16(sums, 4));
+
+            return sum + xorChecksumSSE2(data + i, ks + i, len - i, dir);
+        }
+
+        __attribute__((target("avx2")))
+        uint8_t cryptChecksumAVX2(const State& s, uint8_t* data, size_t len,
+                                  Direction dir)
+        {
+            uint64_t counter = getCounter(s);
+            alignas(32) uint8_t ks[PARALLEL_LEN];
+            uint8_t sum = 0;
+
+            while (len > 0) {
+                size_t n = std::min(len, PARALLEL_LEN);
+                blocksAVX2(s.words, counter, ks);
+                counter += PARALLEL_BLOCKS;
+                sum += xorChecksumAVX2(data, ks, n, dir);
+                data += n;
+                len -= n;
+            }
+
+            return sum;
+        }
+
+        /**
+         * @brief Generates 8 keystream blocks of different streams using AVX2
+         *
+         * Each vector holds the same state word of all 8 blocks.
+         */
+        __attribute__((target("avx2")))
+        void blocksMultiAVX2(const LaneInput<8>& in, uint8_t* out)
+        {
+            const __m256i rot16 = _mm256_setr_epi8(
+                2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+                2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+            const __m256i rot8 = _mm256_setr_epi8(
+                3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14,
+                3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14);
+
+            __m256i x[16], orig[16];
+
+            for (size_t i = 0; i < 16; i++) {
+                x[i] = orig[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in.w[i]));
+            }
+
+#define SPSP_CHACHA20_ROTL(v, n) \
+    _mm256_or_si256(_mm256_slli_epi32(v, n), _mm256_srli_epi32(v, 32 - (n)))
+#define SPSP_CHACHA20_QR(a, b, c, d) \
+    x[a] = _mm256_add_epi32(x[a], x[b]); x[d] = _mm256_shuffle_epi8(_mm256_xor_si256(x[d], x[a]), rot16); \
+    x[c] = _mm256_add_epi32(x[c], x[d]); x[b] = SPSP_CHACHA20_ROTL(_mm256_xor_si256(x[b], x[c]), 12); \
+    x[a] = _mm256_add_epi32(x[a], x[b]); x[d] = _mm256_shuffle_epi8(_mm256_xor_si256(x[d], x[a]), rot8); \
+    x[c] = _mm256_add_epi32(x[c], x[d]); x[b] = SPSP_CHACHA20_ROTL(_mm256_xor_si256(x[b], x[c]), 7);
+
+            for (int i = 0; i < 10; i++) {
+                SPSP_CHACHA20_QR(0, 4, 8, 12)
+                SPSP_CHACHA20_QR(1, 5, 9, 13)
+                SPSP_CHACHA20_QR(2, 6, 10, 14)
+                SPSP_CHACHA20_QR(3, 7, 11, 15)
+                SPSP_CHACHA20_QR(0, 5, 10, 15)
+                SPSP_CHACHA20_QR(1, 6, 11, 12)
+                SPSP_CHACHA20_QR(2, 7, 8, 13)
+                SPSP_CHACHA20_QR(3, 4, 9, 14)
+            }
+
+#undef SPSP_CHACHA20_QR
+#undef SPSP_CHACHA20_ROTL
+
+            for (size_t i = 0; i < 16; i++) x[i] = _mm256_add_epi32(x[i], orig[i]);
+
+            // Transpose 8x8 words to get consecutive blocks
+            for (size_t i = 0; i < 16; i += 8) {
+                __m256i t0 = _mm256_unpacklo_epi32(x[i + 0], x[i + 1]);
+                __m256i t1 = _mm256_unpackhi_epi32(x[i + 0], x[i + 1]);
+                __m256i t2 = _mm256_unpacklo_epi32(x[i + 2], x[i + 3]);
+                __m256i t3 = _mm256_unpackhi_epi32(x[i + 2], x[i + 3]);
+                __m256i t4 = _mm256_unpacklo_epi32(x[i + 4], x[i + 5]);
+                __m256i t5 = _mm256_unpackhi_epi32(x[i + 4], x[i + 5]);
+                __m256i t6 = _mm256_unpacklo_epi32(x[i + 6], x[i + 7]);
+                __m256i t7 = _mm256_unpackhi_epi32(x[i + 6], x[i + 7]);
+
+                // Words i..i+3 (lower half) and i+4..i+7 (upper half) of
+                // lanes k and k+4
+                __m256i u[8] = {
+                    _mm256_unpacklo_epi64(t0, t2), _mm256_unpackhi_epi64(t0, t2),
+                    _mm256_unpacklo_epi64(t1, t3), _mm256_unpackhi_epi64(t1, t3),
+                    _mm256_unpacklo_epi64(t4, t6), _mm256_unpackhi_epi64(t4, t6),
+                    _mm256_unpacklo_epi64(t5, t7), _mm256_unpackhi_epi64(t5, t7),
+                };
+
+                for (size_t k = 0; k < 4; k++) {
+                    auto lo = reinterpret_cast<__m256i*>(out + k*BLOCK_LEN + i*4);
+                    auto hi = reinterpret_cast<__m256i*>(out + (k + 4)*BLOCK_LEN + i*4);
+                    _mm256_storeu_si256(lo, _mm256_permute2x128_si256(u[k], u[k + 4], 0x20));
+                    _mm256_storeu_si256(hi, _mm256_permute2x128_si256(u[k], u[k + 4], 0x31));
+                }
+            }
+        }
+
+#endif // SPSP_CHACHA20_X86
+
+#ifdef SPSP_CHACHA20_NEON
+
+        /**
+         * @brief Generates 4 keystream blocks using NEON
+         *
+         * Each vector holds the same state word of all 4 blocks, which may
+         * belong to the same or to different streams.
+         */
+        void blocksNEON(const LaneInput<4>& in, uint8_t* out)
+        {
+            uint32x4_t x[16], orig[16];
+
+            for (size_t i = 0; i < 16; i++) {
+                x[i] = orig[i] = vld1q_u32(in.w[i]);
+            }
+
+#define SPSP_CHACHA20_ROTL(v, n) vsriq_n_u32(vshlq_n_u32(v, n), v, 32 - (n))
+#define SPSP_CHACHA20_ROTL16(v) vreinterpretq_u32_u16(vrev32q_u16(vreinterpretq_u16_u32(v)))
+#define SPSP_CHACHA20_QR(a, b, c, d) \
+    x[a] = vaddq_u32(x[a], x[b]); x[d] = veorq_u32(x[d], x[a]); x[d] = SPSP_CHACHA20_ROTL16(x[d]); \
+    x[c] = vaddq_u32(x[c], x[d]); x[b] = veorq_u32(x[b], x[c]); x[b] = SPSP_CHACHA20_ROTL(x[b], 12); \
+    x[a] = vaddq_u32(x[a], x[b]); x[d] = veorq_u32(x[d], x[a]); x[d] = SPSP_CHACHA20_ROTL(x[d], 8); \
+    x[c] = vaddq_u32(x[c], x[d]); x[b] = veorq_u32(x[b], x[c]); x[b] = SPSP_CHACHA20_ROTL(x[b], 7);
+
+            for (int i = 0; i < 10; i++) {
+                SPSP_CHACHA20_QR(0, 4, 8, 12)
+                SPSP_CHACHA20_QR(1, 5, 9, 13)
+                SPSP_CHACHA20_QR(2, 6, 10, 14)
+                SPSP_CHACHA20_QR(3, 7, 11, 15)
+                SPSP_CHACHA20_QR(0, 5, 10, 15)
+                SPSP_CHACHA20_QR(1, 6, 11, 12)
+                SPSP_CHACHA20_QR(2, 7, 8, 13)
+                SPSP_CHACHA20_QR(3, 4, 9, 14)
+            }
+
+#undef SPSP_CHACHA20_QR
+#undef SPSP_CHACHA20_ROTL16
+#undef SPSP_CHACHA20_ROTL
+
+            for (size_t i = 0; i < 16; i++) x[i] = vaddq_u32(x[i], orig[i]);
+
+            // Transpose 4x4 words to get consecutive blocks
+            for (size_t i = 0; i < 16; i += 4) {
+                uint32x4x2_t t01 = vtrnq_u32(x[i], x[i + 1]);
+                uint32x4x2_t t23 = vtrnq_u32(x[i + 2], x[i + 3]);
+
+                auto dst = out + i*4;
+                vst1q_u8(dst + 0*BLOCK_LEN, vreinterpretq_u8_u32(vcombine_u32(vget_low_u32(t01.val[0]), vget_low_u32(t23.val[0]))));
+                vst1q_u8(dst + 1*BLOCK_LEN, vreinterpretq_u8_u32(vcombine_u32(vget_low_u32(t01.val[1]), vget_low_u32(t23.val[1]))));
+                vst1q_u8(dst + 2*BLOCK_LEN, vreinterpretq_u8_u32(vcombine_u32(vget_high_u32(t01.val[0]), vget_high_u32(t23.val[0]))));
+                vst1q_u8(dst + 3*BLOCK_LEN, vreinterpretq_u8_u32(vcombine_u32(vget_high_u32(t01.val[1]), vget_high_u32(t23.val[1]))));
+            }
+        }
+
+        uint8_t xorChecksumNEON(uint8_t* data, const uint8_t* ks, size_t len,
+                                Direction dir)
+        {
+            uint8x16_t acc = vdupq_n_u8(0);
+            size_t i = 0;
+
+            // Bytewise accumulation wraps modulo 256, which is what we want
+            for (; i + 16 <= len; i += 16) {
+                uint8x16_t in = vld1q_u8(data + i);
+                uint8x16_t out = veorq_u8(in, vld1q_u8(ks + i));
+                vst1q_u8(data + i, out);
+                acc = vaddq_u8(acc, dir == Direction::ENCRYPT ? in : out);
+            }
+
+            uint8_t lanes[16];
+            vst1q_u8(lanes, acc);
+            uint8_t sum = 0;
+            for (auto lane : lanes) sum += lane;
+
+            return sum + xorChecksumScalar(data + i, ks + i, len - i, dir);
+        }
+
+        uint8_t cryptChecksumNEON(const State& s, uint8_t* data, size_t len,
+                                  Direction dir)
+        {
+            uint64_t counter = getCounter(s);
+            LaneInput<PARALLEL_BLOCKS> in;
+            alignas(16) uint8_t ks[PARALLEL_LEN];
+            uint8_t sum = 0;
+
+            while (len > 0) {
+                size_t n = std::min(len, PARALLEL_LEN);
+                for (size_t k = 0; k < PARALLEL_BLOCKS; k++) {
+                    setLane(in, k, s.words, counter + k);
+                }
+                blocksNEON(in, ks);
+                counter += PARALLEL_BLOCKS;
+                sum += xorChecksumNEON(data, ks, n, dir);
+                data += n;
+                len -= n;
+            }
+
+            return sum;
+        }
+
+#endif // SPSP_CHACHA20_NEON
+
+        /**
+         * @brief Selects the best implementation available on this CPU
+         *
+         */
+        Impl bestImpl() noexcept
+        {
+            if (implAvailable(Impl::AVX2)) return Impl::AVX2;
+            if (implAvailable(Impl::NEON)) return Impl::NEON;
+            if (implAvailable(Impl::SSE2)) return Impl::SSE2;
+            return Impl::SCALAR;
+        }
+
+        std::atomic<Impl>& currentImpl() noexcept
+        {
+            static std::atomic<Impl> impl{bestImpl()};
+            return impl;
+        }
+    } // namespace
+
+    State::State(const uint8_t* key, const uint8_t* nonce, uint64_t counter) noexcept
+    {
+        const auto constant = reinterpret_cast<const uint8_t*>("expand 32-byte k");
+
+        for (size_t i = 0; i < 4; i++) words[i] = pack4(constant + i*4);
+        for (size_t i = 0; i < 8; i++) words[4 + i] = pack4(key + i*4);
+        this->setNonce(nonce, counter);
+    }
+
+    void State::setNonce(const uint8_t* nonce, uint64_t counter) noexcept
+    {
+        words[12] = uint32_t(counter);
+        words[13] = uint32_t(counter >> 32);
+        words[14] = pack4(nonce + 0);
+        words[15] = pack4(nonce + 4);
+    }
+
+    const char* implToStr(Impl impl) noexcept
+    {
+        switch (impl) {
+        case Impl::SCALAR: return "SCALAR";
+        case Impl::SSE2: return "SSE2";
+        case Impl::AVX2: return "AVX2";
+        case Impl::NEON: return "NEON";
+        default: return "UNKNOWN";
+        }
+    }
+
+    bool implAvailable(Impl impl) noexcept
+    {
+        switch (impl) {
+        case Impl::SCALAR:
+            return true;
+#ifdef SPSP_CHACHA20_X86
+        case Impl::SSE2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("sse2");
+        case Impl::AVX2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+#endif
+#ifdef SPSP_CHACHA20_NEON
+        case Impl::NEON:
+            return true;
+#endif
+        default:
+            return false;
+        }
+    }
+
+    Impl getImpl() noexcept
+    {
+        return currentImpl().load(std::memory_order_relaxed);
+    }
+
+    bool setImpl(Impl impl) noexcept
+    {
+        if (!implAvailable(impl)) {
+            return false;
+        }
+
+        currentImpl().store(impl, std::memory_order_relaxed);
+        return true;
+    }
+
+    uint8_t cryptChecksum(const State& state, uint8_t* data, size_t dataLen,
+                          Direction dir) noexcept
+    {
+        switch (getImpl()) {
+#ifdef SPSP_CHACHA20_X86
+        case Impl::SSE2: return cryptChecksumSSE2(state, data, dataLen, dir);
+        case Impl::AVX2: return cryptChecksumAVX2(state, data, dataLen, dir);
+#endif
+#ifdef SPSP_CHACHA20_NEON
+        case Impl::NEON: return cryptChecksumNEON(state, data, dataLen, dir);
+#endif
+        default: return cryptChecksumScalar(state, data, dataLen, dir);
+        }
+    }
+
+    void cryptChecksumBatch(BatchItem* items, size_t count) noexcept
+    {
+        switch (getImpl()) {
+#ifdef SPSP_CHACHA20_X86
+        case Impl::SSE2:
+            cryptChecksumBatchLanes<4>(items, count, blocksSSE2, xorChecksumSSE2);
+            return;
+        case Impl::AVX2:
+            cryptChecksumBatchLanes<8>(items, count, blocksMultiAVX2, xorChecksumAVX2);
+            return;
+#endif
+#ifdef SPSP_CHACHA20_NEON
+        case Impl::NEON:
+            cryptChecksumBatchLanes<4>(items, count, blocksNEON, xorChecksumNEON);
+            return;
+#endif
+        default:
+            for (size_t i = 0; i < count; i++) {
+                items[i].checksum = cryptChecksumScalar(items[i].state, items[i].data,
+                                                        items[i].dataLen, items[i].dir);
+            }
+            return;
+        }
+    }
+} // namespace SPSP::ChaCha20
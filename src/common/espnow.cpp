@@ -9,7 +9,10 @@
 
 #include <cstring>
 #include <functional>
-#include <thread>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include "spsp/espnow.hpp"
 #include "spsp/logger.hpp"
@@ -21,13 +24,42 @@ static const char* SPSP_LOG_TAG = "SPSP/Local/ESPNOW";
 
 namespace SPSP::LocalLayers::ESPNOW
 {
-    ESPNOW::ESPNOW(IAdapter& adapter, WiFi::IESPNOW& wifi, const Config& conf)
-        : m_conf{conf}, m_wifi{wifi}, m_adapter{adapter}, m_serdes{m_conf}
+    ESPNOW::ESPNOW(IAdapter& adapter, WiFi::IESPNOW& wifi, const Config& conf,
+                   IExecutor* executor)
+        : m_conf{conf}, m_wifi{wifi}, m_adapter{adapter}, m_serdes{m_conf},
+          m_executor{executor != nullptr ? executor : &defaultExecutor()}
     {
         using namespace std::placeholders;
 
+        // Concurrency limit
+        m_maxInFlight = m_adapter.getMaxPeerNum();
+        if (m_conf.maxInFlightPeers > 0 && m_conf.maxInFlightPeers < m_maxInFlight) {
+            m_maxInFlight = m_conf.maxInFlightPeers;
+        }
+        if (m_maxInFlight == 0) {
+            m_maxInFlight = 1;
+        }
+
         // Set callbacks
-        m_adapter.setRecvCb(std::bind(&ESPNOW::recvCb, this, _1, _2, _3));
+        if (m_adapter.recvFromDriverContext()) {
+            m_adapter.setRecvCb([this](const LocalAddrT& src, uint8_t* data, size_t len, int rssi) {
+                // Data are owned by adapter, so they must be copied for the task
+                // Driver mustn't wait for executor (it's needed for send callbacks)
+                bool queued = m_tasks.tryExecute(*m_executor,
+                    [this, src, buf = std::string((char*) data, len), rssi]() mutable {
+                        this->recvCb(src, reinterpret_cast<uint8_t*>(buf.data()),
+                                     buf.length(), rssi);
+                    });
+
+                if (!queued) {
+                    SPSP_LOGD("Receive: executor busy, packet from %s dropped",
+                              src.str.c_str());
+                }
+            });
+        } else {
+            m_adapter.setRecvCb(std::bind(&ESPNOW::recvCb, this, _1, _2, _3, _4));
+            m_adapter.setRecvBatchCb(std::bind(&ESPNOW::recvBatchCb, this, _1, _2));
+        }
         m_adapter.setSendCb(std::bind(&ESPNOW::sendCb, this, _1, _2));
 
         SPSP_LOGI("Protocol version: %d", PROTO_VERSION);
@@ -36,29 +68,43 @@ namespace SPSP::LocalLayers::ESPNOW
 
     ESPNOW::~ESPNOW()
     {
+        m_tasks.wait();
+
+        // Unregister cached peers
+        for (auto& peer : m_peerCache) {
+            try {
+                m_adapter.removePeer(peer);
+            } catch (const AdapterError& e) {
+                SPSP_LOGW("Peer %s can't be removed: %s", peer.str.c_str(), e.what());
+            }
+        }
+
         SPSP_LOGI("Deinitialized");
     }
 
     bool ESPNOW::send(const LocalMessageT& msg)
     {
-        SPSP_LOGD("Send: %s", msg.toString().c_str());
+        auto promise = std::make_shared<std::promise<bool>>();
+        auto future = promise->get_future();
 
-        LocalAddrT dst = msg.addr;
+        bool queued = this->sendAsync(msg, [promise](bool delivered) {
+            promise->set_value(delivered);
+        });
 
-        // Process empty destination address
-        if (dst == LocalAddrT{}) {
-            // Client: check discovered bridge
-            // Bridge: `dst` shouldn't be ever empty
-
-            if (!m_bestBridge.empty()) {
-                dst = m_bestBridge.addr;
-                SPSP_LOGD("Send: rewriting destination MAC to %s", dst.str.c_str());
-            } else {
-                SPSP_LOGE("Send fail: destination address is empty and no bridge is connected");
-                return false;
-            }
+        if (!queued) {
+            return false;
         }
 
+        SPSP_LOGD("Send: waiting for callback");
+
+        // Wait for callback to finish
+        return future.get();
+    }
+
+    bool ESPNOW::sendAsync(const LocalMessageT& msg, SendCb cb)
+    {
+        SPSP_LOGD("Send: %s", msg.toString().c_str());
+
         // Check length
         size_t dataLen = m_serdes.getPacketLength(msg);
         if (dataLen > MAX_PACKET_LENGTH) {
@@ -67,43 +113,43 @@ namespace SPSP::LocalLayers::ESPNOW
             return false;
         }
 
-        // Promise/mutex bucket
-        auto bucketId = this->getBucketIdFromLocalAddr(dst);
-
-        // Lock both `m_mutex` and MAC's `m_sendingMutexes` entry without
-        // deadlock
-        std::lock(m_mutex, m_sendingMutexes[bucketId]);
-
-        auto future = m_sendingPromises[bucketId].get_future();
-
-        // Create block, so `data` is destroyed immediatelly after sending
-        {
-            // Serialize
-            std::string data;
-            m_serdes.serialize(msg, data);
+        // Serialize
+        auto frame = this->acquireFrame();
+        frame->len = m_serdes.serialize(msg, frame->packet(), MAX_PACKET_LENGTH);
 
-            // Send
-            this->sendRaw(dst, data);
-        }
-
-        m_mutex.unlock();
-
-        SPSP_LOGD("Send: waiting for %s (bucket %d) callback",
-                  dst == LocalAddrT{} ? "." : dst.str.c_str(), bucketId);
+        LocalAddrT dst = msg.addr;
 
-        // Wait for callback to finish
-        bool delivered = future.get();
+        {   // Mutex
+            // Waits for connection to bridge in progress
+            const std::scoped_lock lock(m_mutex);
 
-        // Reset promise
-        m_sendingPromises[bucketId] = std::promise<bool>{};
+            // Process empty destination address
+            if (dst == LocalAddrT{}) {
+                // Client: check discovered bridge
+                // Bridge: `dst` shouldn't be ever empty
+                const std::scoped_lock bestBridgeLock(m_bestBridgeMutex);
+
+                if (!m_bestBridge.empty()) {
+                    dst = m_bestBridge.addr;
+                    SPSP_LOGD("Send: rewriting destination MAC to %s", dst.str.c_str());
+                } else {
+                    SPSP_LOGE("Send fail: destination address is empty and no bridge is connected");
+                    this->releaseFrame(std::move(frame));
+                    return false;
+                }
+            }
+        }  // Mutex
 
-        m_sendingMutexes[bucketId].unlock();
+        this->sendRawAsync(dst, std::move(frame), [cb, dst, dataLen](bool delivered) {
+            SPSP_LOGD("Send: %zu bytes to %s: %s", dataLen, dst.str.c_str(),
+                      delivered ? "success" : "fail");
 
-        SPSP_LOGD("Send: %zu bytes to %s: %s", dataLen,
-                  dst == LocalAddrT{} ? "." : dst.str.c_str(),
-                  delivered ? "success" : "fail");
+            if (cb != nullptr) {
+                cb(delivered);
+            }
+        });
 
-        return delivered;
+        return true;
     }
 
     bool ESPNOW::connectToBridge(BridgeConnInfoRTC* rtndBr,
@@ -114,6 +160,7 @@ namespace SPSP::LocalLayers::ESPNOW
 
             if (rtndBr != nullptr) {
                 // Reconnect to retained bridge
+                const std::scoped_lock bestBridgeLock(m_bestBridgeMutex);
                 m_bestBridge = *rtndBr;
                 m_wifi.setChannel(m_bestBridge.ch);
 
@@ -137,7 +184,9 @@ namespace SPSP::LocalLayers::ESPNOW
             SPSP_LOGI("Connect to bridge: channels %u - %u", lowCh, highCh);
 
             // Clear previous results
+            m_bestBridgeMutex.lock();
             m_bestBridge = {};
+            m_bestBridgeMutex.unlock();
 
             // Prepare message
             LocalMessageT msg = {};
@@ -145,47 +194,40 @@ namespace SPSP::LocalLayers::ESPNOW
             msg.type = LocalMessageType::PROBE_REQ;
             msg.payload = m_conf.probePayload;
 
-            // Convert to raw data
-            std::string data;
-            m_serdes.serialize(msg, data);
-
-            // Promise/mutex bucket
-            auto bucketId = this->getBucketIdFromLocalAddr(msg.addr);
-
             // Probe all channels
             for (uint8_t ch = lowCh; ch <= highCh; ch++) {
-                auto future = m_sendingPromises[bucketId].get_future();
-
                 m_wifi.setChannel(ch);
-                this->sendRaw(msg.addr, data);
-
-                SPSP_LOGD("Connect to bridge: waiting for callback");
 
-                // Wait for callback to finish
-                future.get();
+                // Convert to raw data
+                auto frame = this->acquireFrame();
+                frame->len = m_serdes.serialize(msg, frame->packet(), MAX_PACKET_LENGTH);
 
-                // Reset promise
-                m_sendingPromises[bucketId] = std::promise<bool>{};
+                SPSP_LOGD("Connect to bridge: waiting for callback");
+                this->sendRawBlocking(msg.addr, std::move(frame));
 
                 // Sleep
                 std::this_thread::sleep_for(m_conf.connectToBridgeChannelWaiting);
             }
 
-            // No response
-            if (m_bestBridge.empty()) {
-                SPSP_LOGE("Connect to bridge: no response from bridge");
-                return false;
-            }
+            {
+                const std::scoped_lock bestBridgeLock(m_bestBridgeMutex);
 
-            // New best bridge is available - switch to it's channel
-            m_wifi.setChannel(m_bestBridge.ch);
+                // No response
+                if (m_bestBridge.empty()) {
+                    SPSP_LOGE("Connect to bridge: no response from bridge");
+                    return false;
+                }
 
-            SPSP_LOGI("Connected to bridge: %s on channel %u (%d dBm)",
-                      m_bestBridge.addr.str.c_str(), m_bestBridge.ch,
-                      m_bestBridge.rssi);
+                // New best bridge is available - switch to it's channel
+                m_wifi.setChannel(m_bestBridge.ch);
 
-            if (connBr != nullptr) {
-                *connBr = m_bestBridge.toRTC();
+                SPSP_LOGI("Connected to bridge: %s on channel %u (%d dBm)",
+                          m_bestBridge.addr.str.c_str(), m_bestBridge.ch,
+                          m_bestBridge.rssi);
+
+                if (connBr != nullptr) {
+                    *connBr = m_bestBridge.toRTC();
+                }
             }
         }  // Mutex
 
@@ -197,7 +239,13 @@ namespace SPSP::LocalLayers::ESPNOW
         return true;
     }
 
-    void ESPNOW::receive(const LocalMessageT& msg, int rssi)
+    PeerCacheStats ESPNOW::getPeerCacheStats()
+    {
+        const std::scoped_lock lock(m_adapterMutex);
+        return m_peerCacheStats;
+    }
+
+    void ESPNOW::receive(const LocalMessageViewT& msg, int rssi)
     {
         // Process probe requests internally
         if (msg.type == LocalMessageType::PROBE_RES) {
@@ -222,26 +270,231 @@ namespace SPSP::LocalLayers::ESPNOW
         }
     }
 
-    void ESPNOW::sendRaw(const LocalAddrT& dst, const std::string& data)
+    void ESPNOW::sendRaw(const LocalAddrT& dst, TxFrame& frame)
     {
+        // Recursive, as adapter may call send callback (which sends next
+        // packet) before returning
+        const std::scoped_lock lock(m_adapterMutex);
+
         // Register peer
-        m_adapter.addPeer(dst);
+        this->registerPeer(dst);
 
         // Send
-        SPSP_LOGD("Send raw: %zu bytes to %s", data.length(), dst.str.c_str());
-        m_adapter.send(dst, data);
+        SPSP_LOGD("Send raw: %zu bytes to %s", frame.len, dst.str.c_str());
+        m_adapter.send(dst, frame);
+    }
+
+    void ESPNOW::registerPeer(const LocalAddrT& peer)
+    {
+        const std::scoped_lock lock(m_adapterMutex);
+
+        // Already registered - move to front
+        auto indexIt = m_peerCacheIndex.find(peer);
+        if (indexIt != m_peerCacheIndex.end()) {
+            m_peerCache.splice(m_peerCache.begin(), m_peerCache, indexIt->second);
+            m_peerCacheStats.hits++;
+            return;
+        }
+
+        m_peerCacheStats.misses++;
+
+        // Make room
+        if (!m_peerCache.empty() && m_peerCache.size() >= m_adapter.getMaxPeerNum()) {
+            auto victim = std::prev(m_peerCache.end());
+
+            {   // Mutex
+                const std::scoped_lock sendLock(m_sendMutex);
+
+                // Prefer peers without packet in flight
+                for (auto it = m_peerCache.rbegin(); it != m_peerCache.rend(); it++) {
+                    auto queueIt = m_sendQueues.find(*it);
+                    if (queueIt == m_sendQueues.end() || !queueIt->second.inFlight) {
+                        victim = std::prev(it.base());
+                        break;
+                    }
+                }
+            }  // Mutex
+
+            SPSP_LOGD("Peer cache: evicting %s", victim->str.c_str());
+
+            try {
+                m_adapter.removePeer(*victim);
+            } catch (const AdapterError& e) {
+                SPSP_LOGW("Peer %s can't be removed: %s", victim->str.c_str(), e.what());
+            }
+
+            m_peerCacheIndex.erase(*victim);
+            m_peerCache.erase(victim);
+            m_peerCacheStats.evictions++;
+        }
+
+        m_adapter.addPeer(peer);
+        m_peerCache.push_front(peer);
+        m_peerCacheIndex[peer] = m_peerCache.begin();
+    }
+
+    void ESPNOW::sendRawAsync(const LocalAddrT& dst, std::unique_ptr<TxFrame> frame,
+                              SendCb cb)
+    {
+        bool start = false;
 
-        // Unregister peer
-        m_adapter.removePeer(dst);
+        {   // Mutex
+            const std::scoped_lock lock(m_sendMutex);
+
+            auto& peerQueue = m_sendQueues[dst];
+            peerQueue.packets.push_back({dst, std::move(frame), cb});
+
+            // Peer is already in flight or waiting
+            if (peerQueue.packets.size() > 1) {
+                SPSP_LOGD("Send raw: %s busy, queued", dst.str.c_str());
+                return;
+            }
+
+            if (m_inFlight < m_maxInFlight) {
+                peerQueue.inFlight = true;
+                m_inFlight++;
+                start = true;
+            } else {
+                SPSP_LOGD("Send raw: %s waiting for free slot", dst.str.c_str());
+                m_waitingPeers.push_back(dst);
+            }
+        }  // Mutex
+
+        if (start) {
+            this->sendRawNext(dst);
+        }
+    }
+
+    bool ESPNOW::sendRawBlocking(const LocalAddrT& dst, std::unique_ptr<TxFrame> frame)
+    {
+        auto promise = std::make_shared<std::promise<bool>>();
+        auto future = promise->get_future();
+
+        this->sendRawAsync(dst, std::move(frame), [promise](bool delivered) {
+            promise->set_value(delivered);
+        });
+
+        return future.get();
+    }
+
+    void ESPNOW::sendRawNext(LocalAddrT peer)
+    {
+        while (true) {
+            LocalAddrT dst;
+            TxFrame* frame;
+
+            {   // Mutex
+                const std::scoped_lock lock(m_sendMutex);
+
+                auto it = m_sendQueues.find(peer);
+                if (it == m_sendQueues.end() || it->second.packets.empty()) {
+                    return;
+                }
+
+                // Frame stays in place until it's send callback, address
+                // is copied, as callback may come before adapter returns
+                dst = it->second.packets.front().dst;
+                frame = it->second.packets.front().frame.get();
+            }  // Mutex
+
+            try {
+                this->sendRaw(dst, *frame);
+                return;
+            } catch (const AdapterError& e) {
+                SPSP_LOGE("Send raw: %s: %s", dst.str.c_str(), e.what());
+            }
+
+            // Complete refused packet as undelivered and continue with next one
+            PendingSend failed;
+            auto next = this->popInFlight(peer, failed);
+
+            this->releaseFrame(std::move(failed.frame));
+
+            if (failed.cb != nullptr) {
+                failed.cb(false);
+            }
+
+            if (!next) {
+                return;
+            }
+
+            peer = *next;
+        }
+    }
+
+    std::unique_ptr<TxFrame> ESPNOW::acquireFrame()
+    {
+        {   // Mutex
+            const std::scoped_lock lock(m_framePoolMutex);
+
+            if (!m_framePool.empty()) {
+                auto frame = std::move(m_framePool.back());
+                m_framePool.pop_back();
+                return frame;
+            }
+        }  // Mutex
+
+        return std::make_unique<TxFrame>();
+    }
+
+    void ESPNOW::releaseFrame(std::unique_ptr<TxFrame> frame)
+    {
+        if (frame == nullptr) {
+            return;
+        }
+
+        const std::scoped_lock lock(m_framePoolMutex);
+
+        // Keep enough frames for all in-flight peers
+        if (m_framePool.size() < m_maxInFlight) {
+            m_framePool.push_back(std::move(frame));
+        }
     }
 
-    void ESPNOW::recvCb(const LocalAddrT src, std::string data, int rssi)
+    std::optional<LocalAddrT> ESPNOW::popInFlight(const LocalAddrT& peer,
+                                                  PendingSend& done)
+    {
+        const std::scoped_lock lock(m_sendMutex);
+
+        auto it = m_sendQueues.find(peer);
+        if (it == m_sendQueues.end() || !it->second.inFlight) {
+            SPSP_LOGW("Send callback: no packet is being sent to %s",
+                      peer.str.c_str());
+            return std::nullopt;
+        }
+
+        auto& peerQueue = it->second;
+        done = std::move(peerQueue.packets.front());
+        peerQueue.packets.pop_front();
+
+        // Continue with the same peer
+        if (!peerQueue.packets.empty()) {
+            return peer;
+        }
+
+        // Release slot
+        m_sendQueues.erase(it);
+        m_inFlight--;
+
+        // Pass it to waiting peer
+        if (m_waitingPeers.empty()) {
+            return std::nullopt;
+        }
+
+        LocalAddrT next = m_waitingPeers.front();
+        m_waitingPeers.pop_front();
+        m_sendQueues[next].inFlight = true;
+        m_inFlight++;
+        return next;
+    }
+
+    void ESPNOW::recvCb(const LocalAddrT& src, uint8_t* data, size_t len, int rssi)
     {
         SPSP_LOGD("Receive: packet from %s", src.str.c_str());
 
-        // Deserialize message
-        LocalMessageT msg = {};
-        if (!m_serdes.deserialize(src, data, msg)) {
+        // Deserialize message (in-place)
+        LocalMessageViewT msg{src};
+        if (!m_serdes.deserialize(data, len, msg)) {
             SPSP_LOGD("Receive: deserialization of packet from %s failed",
                       src.str.c_str());
             return;
@@ -250,21 +503,57 @@ namespace SPSP::LocalLayers::ESPNOW
         this->receive(msg, rssi);
     }
 
-    void ESPNOW::sendCb(const LocalAddrT dst, bool delivered)
+    void ESPNOW::recvBatchCb(const AdapterRecvItem* items, size_t count)
     {
-        // Promise/mutex bucket
-        auto bucketId = this->getBucketIdFromLocalAddr(dst);
+        SPSP_LOGD("Receive: batch of %zu packets", count);
+
+        // Reused by adapter's thread (items can't be default-constructed)
+        thread_local std::vector<DeserializeBatchItem> t_batch;
+        t_batch.clear();
+        t_batch.reserve(count);
+
+        for (size_t i = 0; i < count; i++) {
+            t_batch.push_back({
+                .data = items[i].data,
+                .dataLen = items[i].len,
+                .msg = LocalMessageViewT{items[i].src},
+            });
+        }
 
-        SPSP_LOGD("Send callback: %s (bucket %d): %s",
-                  LocalAddrT(dst).str.c_str(), bucketId,
-                  delivered ? "delivered" : "not delivered");
+        // Deserialize messages (in-place)
+        m_serdes.deserializeBatch(t_batch.data(), t_batch.size());
+
+        for (size_t i = 0; i < count; i++) {
+            if (!t_batch[i].valid) {
+                SPSP_LOGD("Receive: deserialization of packet from %s failed",
+                          items[i].src.str.c_str());
+                continue;
+            }
+
+            this->receive(t_batch[i].msg, items[i].rssi);
+        }
 
-        m_sendingPromises[bucketId].set_value(delivered);
+        t_batch.clear();
     }
 
-    uint8_t ESPNOW::getBucketIdFromLocalAddr(const LocalAddrT& addr) const
+    void ESPNOW::sendCb(const LocalAddrT dst, bool delivered)
     {
-        return std::hash<LocalAddrT>{}(addr) % this->m_sendingPromises.size();
+        SPSP_LOGD("Send callback: %s: %s", LocalAddrT(dst).str.c_str(),
+                  delivered ? "delivered" : "not delivered");
+
+        PendingSend done;
+        auto next = this->popInFlight(dst, done);
+
+        // Keep the radio busy before running completion
+        if (next) {
+            this->sendRawNext(*next);
+        }
+
+        this->releaseFrame(std::move(done.frame));
+
+        if (done.cb != nullptr) {
+            done.cb(delivered);
+        }
     }
 
     BridgeConnInfoRTC ESPNOW::BridgeConnInfoInternal::toRTC()
@@ -7,10 +7,11 @@
  *
  */
 
+#include <algorithm>
 #include <cinttypes>
 #include <cstring>
 
-#include "spsp/chacha20.hpp"
+#include "spsp/chacha20_simd.hpp"
 #include "spsp/espnow_ser_des.hpp"
 #include "spsp/logger.hpp"
 
@@ -19,25 +20,76 @@ static const char* SPSP_LOG_TAG = "SPSP/Local/ESPNOW/SerDes";
 
 namespace SPSP::LocalLayers::ESPNOW
 {
-    SerDes::SerDes(const Config& conf) noexcept : m_conf{conf}
+    namespace
     {
+        /**
+         * @brief Creates cipher state from precomputed key words
+         *
+         */
+        template <typename TKeyEntry>
+        ChaCha20::State makeState(const TKeyEntry& key, const uint8_t* nonce) noexcept
+        {
+            ChaCha20::State state;
+            memcpy(state.words, key.words, sizeof(state.words));
+            state.setNonce(nonce);
+            return state;
+        }
+    } // namespace
+
+    SerDes::SerDes(const Config& conf) noexcept
+    {
+        this->setKey(conf.ssid, conf.password);
+    }
+
+    bool SerDes::setKey(uint32_t ssid, const std::string& password) noexcept
+    {
+        // Replace existing or use new entry
+        auto key = const_cast<KeyEntry*>(this->findKey(ssid));
+        if (key == nullptr) {
+            if (m_keysCount == MAX_KEYS) {
+                SPSP_LOGE("Can't set key for SSID 0x%" PRIx32 ": table full", ssid);
+                return false;
+            }
+            key = &m_keys[m_keysCount++];
+        }
+
+        uint8_t keyBytes[ChaCha20::KEY_LEN] = {};
+        memcpy(keyBytes, password.c_str(), std::min(password.length(), ChaCha20::KEY_LEN));
+
+        const uint8_t zeroNonce[ChaCha20::NONCE_LEN] = {};
+        ChaCha20::State state{keyBytes, zeroNonce};
+
+        key->ssid = ssid;
+        static_assert(sizeof(key->words) == sizeof(state.words));
+        memcpy(key->words, state.words, sizeof(key->words));
+        return true;
     }
 
     void SerDes::serialize(const LocalMessageT& msg, std::string& data) const noexcept
+    {
+        data.resize(this->getPacketLength(msg));
+        this->serialize(msg, reinterpret_cast<uint8_t*>(data.data()), data.length());
+    }
+
+    size_t SerDes::serialize(const LocalMessageT& msg, uint8_t* buf,
+                             size_t bufLen) const noexcept
     {
         size_t topicLen = msg.topic.length();
         size_t payloadLen = msg.payload.length();
         size_t dataLen = this->getPacketLength(msg);
 
-        // Allocate buffer
-        uint8_t* dataRaw = new uint8_t[dataLen];
+        // Check buffer
+        if (dataLen > bufLen) {
+            return 0;
+        }
 
-        Packet* p = reinterpret_cast<Packet*>(dataRaw);
+        Packet* p = reinterpret_cast<Packet*>(buf);
 
         // Fill data
-        p->header.ssid = m_conf.ssid;
+        p->header.ssid = m_keys[0].ssid;
         p->header.version = PROTO_VERSION;
         p->payload.type = msg.type;
+        memset(p->payload._reserved, 0, sizeof(p->payload._reserved));
         p->payload.checksum = 0;
         p->payload.topicLen = topicLen;
         p->payload.payloadLen = payloadLen;
@@ -51,27 +103,38 @@ namespace SPSP::LocalLayers::ESPNOW
         m_rand.bytes(&(p->header.nonce), NONCE_LEN);
 
         // Skip header
-        auto dataRawNoHeader = dataRaw + sizeof(PacketHeader);
+        auto dataRawNoHeader = buf + sizeof(PacketHeader);
         auto dataLenNoHeader = dataLen - sizeof(PacketHeader);
 
-        // Checksum
-        p->payload.checksum = this->checksumRaw(dataRawNoHeader,
-                                                dataLenNoHeader);
-
-        // Encrypt
-        this->encryptRaw(dataRawNoHeader, dataLenNoHeader, p->header.nonce);
+        // Encrypt and checksum in one pass
+        // Checksum was zero during encryption, so encrypted checksum field
+        // holds bare keystream byte and the checksum can be XORed into it.
+        p->payload.checksum ^= this->cryptRaw(m_keys[0], dataRawNoHeader,
+                                              dataLenNoHeader, p->header.nonce,
+                                              false);
 
-        // Convert to std::string
-        data = std::string(reinterpret_cast<char*>(dataRaw), dataLen);
-
-        delete[] dataRaw;
+        return dataLen;
     }
 
     bool SerDes::deserialize(const LocalAddrT& src, std::string& data,
                              LocalMessageT& msg) const noexcept
     {
-        size_t dataLen = data.length();
+        // Decrypt copy to keep input intact
+        std::string dataCopy = data;
+
+        LocalMessageViewT view{src};
+        if (!this->deserialize(reinterpret_cast<uint8_t*>(dataCopy.data()),
+                               dataCopy.length(), view)) {
+            return false;
+        }
+
+        msg = view.toMessage();
+        return true;
+    }
 
+    bool SerDes::deserialize(uint8_t* data, size_t dataLen,
+                             LocalMessageViewT& msg) const noexcept
+    {
         // Check packet length
         if (dataLen < sizeof(Packet)) {
             SPSP_LOGD("Deserialize failed: packet too short (%zu < %zu bytes)",
@@ -79,35 +142,85 @@ namespace SPSP::LocalLayers::ESPNOW
             return false;
         }
 
-        // Allocate buffer and copy data
-        uint8_t* dataRaw = new uint8_t[dataLen];
-        memcpy(dataRaw, data.c_str(), dataLen);
-
         // Treat as `Packet`
-        Packet* p = reinterpret_cast<Packet*>(dataRaw);
+        const Packet* p = reinterpret_cast<const Packet*>(data);
 
-        // Validate and decrypt
+        // Validate header
         if (!this->validatePacketHeader(p)) {
-            delete[] dataRaw;
             return false;
         }
-        if (!this->decryptAndValidatePacketPayload(dataRaw, dataLen)) {
-            delete[] dataRaw;
+
+        // Decrypt and validate payload
+        uint8_t plaintextSum = this->cryptRaw(*this->findKey(p->header.ssid),
+                                              data + sizeof(PacketHeader),
+                                              dataLen - sizeof(PacketHeader),
+                                              p->header.nonce, true);
+        if (!this->validatePacketPayload(p, dataLen, plaintextSum)) {
             return false;
         }
 
-        const char* topicAndPayload = reinterpret_cast<const char*>(p->payload.topicAndPayload);
+        this->viewPacket(p, msg);
+        return true;
+    }
 
-        // Construct message
-        msg = {};
-        msg.type = p->payload.type;
-        msg.addr = src;
-        msg.topic = std::string{topicAndPayload, p->payload.topicLen};
-        msg.payload = std::string{topicAndPayload + p->payload.topicLen,
-                                  p->payload.payloadLen};
+    size_t SerDes::deserializeBatch(DeserializeBatchItem* items,
+                                    size_t count) const noexcept
+    {
+        ChaCha20::BatchItem cryptItems[DESERIALIZE_BATCH_CHUNK];
+        DeserializeBatchItem* cryptOwners[DESERIALIZE_BATCH_CHUNK];
+        size_t validCount = 0;
+
+        for (size_t first = 0; first < count; first += DESERIALIZE_BATCH_CHUNK) {
+            size_t chunkLen = std::min(DESERIALIZE_BATCH_CHUNK, count - first);
+            size_t cryptCount = 0;
+
+            // Validate headers
+            for (size_t i = first; i < first + chunkLen; i++) {
+                auto& item = items[i];
+                item.valid = false;
+
+                if (item.dataLen < sizeof(Packet)) {
+                    SPSP_LOGD("Deserialize failed: packet too short (%zu < %zu bytes)",
+                              item.dataLen, sizeof(Packet));
+                    continue;
+                }
+
+                const Packet* p = reinterpret_cast<const Packet*>(item.data);
+                if (!this->validatePacketHeader(p)) {
+                    continue;
+                }
+
+                cryptItems[cryptCount] = ChaCha20::BatchItem{
+                    .state = makeState(*this->findKey(p->header.ssid),
+                                       p->header.nonce),
+                    .data = item.data + sizeof(PacketHeader),
+                    .dataLen = item.dataLen - sizeof(PacketHeader),
+                    .dir = ChaCha20::Direction::DECRYPT,
+                };
+                cryptOwners[cryptCount] = &item;
+                cryptCount++;
+            }
+
+            // Decrypt all of them at once
+            ChaCha20::cryptChecksumBatch(cryptItems, cryptCount);
+
+            // Validate payloads
+            for (size_t i = 0; i < cryptCount; i++) {
+                auto& item = *cryptOwners[i];
+                const Packet* p = reinterpret_cast<const Packet*>(item.data);
+
+                if (!this->validatePacketPayload(p, item.dataLen,
+                                                 cryptItems[i].checksum)) {
+                    continue;
+                }
+
+                this->viewPacket(p, item.msg);
+                item.valid = true;
+                validCount++;
+            }
+        }
 
-        delete[] dataRaw;
-        return true;
+        return validCount;
     }
 
     size_t SerDes::getPacketLength(const LocalMessageT& msg) noexcept
@@ -115,35 +228,32 @@ namespace SPSP::LocalLayers::ESPNOW
         return sizeof(Packet) + msg.topic.length() + msg.payload.length();
     }
 
-    uint8_t SerDes::checksumRaw(uint8_t* data, size_t dataLen,
-                                uint8_t existingChecksum) noexcept
+    uint8_t SerDes::cryptRaw(const KeyEntry& key, uint8_t* data,
+                             size_t dataLen, const uint8_t* nonce,
+                             bool decrypt) noexcept
     {
-        uint8_t checksum = 0;
-
-        for (size_t i = 0; i < dataLen; i++) {
-            checksum += data[i];
-        }
-
-        return checksum - existingChecksum;
+        return ChaCha20::cryptChecksum(makeState(key, nonce), data, dataLen,
+                                       decrypt ? ChaCha20::Direction::DECRYPT
+                                               : ChaCha20::Direction::ENCRYPT);
     }
 
-    void SerDes::encryptRaw(uint8_t* data, size_t dataLen,
-                            const uint8_t* nonce) const noexcept
+    const SerDes::KeyEntry* SerDes::findKey(uint32_t ssid) const noexcept
     {
-        Chacha20 chch{
-            reinterpret_cast<const uint8_t*>(m_conf.password.c_str()),
-            nonce
-        };
+        for (size_t i = 0; i < m_keysCount; i++) {
+            if (m_keys[i].ssid == ssid) {
+                return &m_keys[i];
+            }
+        }
 
-        chch.crypt(reinterpret_cast<uint8_t*>(data), dataLen);
+        return nullptr;
     }
 
     bool SerDes::validatePacketHeader(const Packet* p) const noexcept
     {
         // Check SSID
-        if (p->header.ssid != m_conf.ssid) {
-            SPSP_LOGD("Deserialize failed: different SSID (0x%" PRIx32 " != 0x%" PRIx32 ")",
-                      p->header.ssid, m_conf.ssid);
+        if (this->findKey(p->header.ssid) == nullptr) {
+            SPSP_LOGD("Deserialize failed: unknown SSID (0x%" PRIx32 ")",
+                      p->header.ssid);
             return false;
         }
 
@@ -157,20 +267,11 @@ namespace SPSP::LocalLayers::ESPNOW
         return true;
     }
 
-    bool SerDes::decryptAndValidatePacketPayload(uint8_t* data, size_t dataLen) const noexcept
+    bool SerDes::validatePacketPayload(const Packet* p, size_t dataLen,
+                                       uint8_t plaintextSum) const noexcept
     {
-        // Treat as `Packet`
-        Packet* p = reinterpret_cast<Packet*>(data);
-
-        // Skip header
-        data += sizeof(PacketHeader);
-        dataLen -= sizeof(PacketHeader);
-
-        // Decrypt
-        this->encryptRaw(data, dataLen, p->header.nonce);
-
-        // Check checksum
-        uint8_t checksum = this->checksumRaw(data, dataLen, p->payload.checksum);
+        // Check checksum (sum of everything except checksum itself)
+        uint8_t checksum = plaintextSum - p->payload.checksum;
 
         if (p->payload.checksum != checksum) {
             SPSP_LOGD("Deserialize failed: invalid checksum (%u != %u)",
@@ -181,6 +282,7 @@ namespace SPSP::LocalLayers::ESPNOW
         // Assert valid payload length
         size_t payloadTotalLen = sizeof(PacketPayload) + p->payload.topicLen
                                  + p->payload.payloadLen;
+        dataLen -= sizeof(PacketHeader);
         if (payloadTotalLen != dataLen) {
             SPSP_LOGD("Deserialize failed: invalid total length without header (%zu != %zu bytes)",
                       payloadTotalLen, dataLen);
@@ -189,4 +291,15 @@ namespace SPSP::LocalLayers::ESPNOW
 
         return true;
     }
+
+    void SerDes::viewPacket(const Packet* p, LocalMessageViewT& msg) noexcept
+    {
+        const char* topicAndPayload = reinterpret_cast<const char*>(p->payload.topicAndPayload);
+
+        // Point into decrypted data
+        msg.type = p->payload.type;
+        msg.topic = std::string_view{topicAndPayload, p->payload.topicLen};
+        msg.payload = std::string_view{topicAndPayload + p->payload.topicLen,
+                                       p->payload.payloadLen};
+    }
 } // namespace SPSP::LocalLayers::ESPNOW
@@ -0,0 +1,121 @@
+/**
+ * @file executor.cpp
+ * @author Dávid Benko (davidbenko@davidbenko.dev)
+ * @brief Executors of asynchronous tasks
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <algorithm>
+#include <thread>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "spsp/executor.hpp"
+#include "spsp/logger.hpp"
+
+// Log tag
+static const char* SPSP_LOG_TAG = "SPSP/Executor";
+
+namespace SPSP
+{
+    namespace
+    {
+        //! Executor whose worker is the current thread
+        thread_local const ThreadPoolExecutor* t_executor = nullptr;
+    } // namespace
+
+    ThreadPoolExecutor::ThreadPoolExecutor(const ThreadPoolExecutorConfig& conf)
+        : m_pool{conf.workers, conf.queueSize, conf.overflow,
+                 std::bind(&ThreadPoolExecutor::run, this, std::placeholders::_1)}
+    {
+        if (conf.cpus.empty()) {
+            return;
+        }
+
+#if defined(__linux__)
+        auto threads = m_pool.getNativeHandles();
+        for (size_t i = 0; i < threads.size(); i++) {
+            int cpu = conf.cpus[i % conf.cpus.size()];
+
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(cpu, &cpus);
+
+            if (pthread_setaffinity_np(threads[i], sizeof(cpus), &cpus) != 0) {
+                SPSP_LOGW("Worker %zu can't be pinned to CPU %d", i, cpu);
+            }
+        }
+#else
+        SPSP_LOGW("Pinning workers to CPUs isn't supported on this platform");
+#endif
+    }
+
+    bool ThreadPoolExecutor::execute(TaskT task)
+    {
+        Task item{ std::move(task), std::chrono::steady_clock::now() };
+
+        // Worker waiting for space in its own queue would never get it
+        if (t_executor == this && m_pool.getPolicy() == OverflowPolicy::BLOCK) {
+            if (!m_pool.pushFor(std::move(item), std::chrono::milliseconds(0))) {
+                this->run(item);
+            }
+            return true;
+        }
+
+        return m_pool.push(std::move(item));
+    }
+
+    bool ThreadPoolExecutor::tryExecute(TaskT task)
+    {
+        Task item{ std::move(task), std::chrono::steady_clock::now() };
+
+        return m_pool.pushFor(std::move(item), std::chrono::milliseconds(0));
+    }
+
+    ExecutorStats ThreadPoolExecutor::getStats()
+    {
+        ExecutorStats stats;
+        stats.queue = m_pool.getStats();
+        stats.executed = m_executed;
+
+        if (stats.executed > 0) {
+            stats.latencyAvg = std::chrono::microseconds(m_latencySum / stats.executed);
+        }
+        stats.latencyMax = std::chrono::microseconds(m_latencyMax);
+
+        return stats;
+    }
+
+    void ThreadPoolExecutor::run(Task& task)
+    {
+        t_executor = this;
+
+        uint64_t latency = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - task.submitted).count();
+
+        m_latencySum += latency;
+        uint64_t latencyMax = m_latencyMax;
+        while (latency > latencyMax &&
+               !m_latencyMax.compare_exchange_weak(latencyMax, latency)) {}
+
+        task.fn();
+        m_executed++;
+
+        // Release everything captured by the task now
+        task.fn = nullptr;
+    }
+
+    IExecutor& defaultExecutor()
+    {
+        static ThreadPoolExecutor executor{ThreadPoolExecutorConfig{
+            .workers = std::max<size_t>(std::thread::hardware_concurrency(), 2),
+        }};
+
+        return executor;
+    }
+} // namespace SPSP
@@ -7,8 +7,6 @@
  *
  */
 
-#include <thread>
-
 #include "spsp/local_broker.hpp"
 #include "spsp/logger.hpp"
 
@@ -17,14 +15,17 @@ static const char* SPSP_LOG_TAG = "SPSP/Far/LocalBroker";
 
 namespace SPSP::FarLayers::LocalBroker
 {
-    LocalBroker::LocalBroker(const std::string topicPrefix)
-        : m_topicPrefix{topicPrefix}
+    LocalBroker::LocalBroker(const std::string topicPrefix, IExecutor* executor)
+        : m_topicPrefix{topicPrefix},
+          m_executor{executor != nullptr ? executor : &defaultExecutor()}
     {
         SPSP_LOGI("Initialized");
     }
 
     LocalBroker::~LocalBroker()
     {
+        m_tasks.wait();
+
         SPSP_LOGI("Deinitialized");
     }
 
@@ -45,15 +46,14 @@ namespace SPSP::FarLayers::LocalBroker
         bool subscribed;
         {
             const std::scoped_lock lock(m_mutex);
-            subscribed = !m_subs.find(topicExtended).empty();
+            subscribed = m_subs.matchesAny(topicExtended);
         }
 
         if (subscribed && this->nodeConnected()) {
             // Send data back as received (parameters must be copied)
-            std::thread t([this, topicExtended, payload]() {
+            m_tasks.execute(*m_executor, [this, topicExtended, payload]() {
                 this->getNode()->receiveFar(topicExtended, payload);
             });
-            t.detach();
         }
 
         return true;
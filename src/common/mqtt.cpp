@@ -7,6 +7,7 @@
  *
  */
 
+#include <algorithm>
 #include <cinttypes>
 
 #include "spsp/logger.hpp"
@@ -17,16 +18,20 @@ static const char* SPSP_LOG_TAG = "SPSP/Far/MQTT";
 
 namespace SPSP::FarLayers::MQTT
 {
-    MQTT::MQTT(IAdapter& adapter, const Config& conf)
-        : m_conf{conf}, m_adapter{adapter}
+    MQTT::MQTT(IAdapter& adapter, const Config& conf, IExecutor* executor)
+        : m_conf{conf}, m_adapter{adapter},
+          m_executor{executor != nullptr ? executor : &defaultExecutor()}
     {
-        using namespace std::placeholders;
-
         m_initializing = true;
 
         // Set adapter callbacks
         m_adapter.setConnectedCb(std::bind(&MQTT::connectedCb, this));
-        m_adapter.setSubDataCb(std::bind(&MQTT::subDataCb, this, _1, _2));
+        m_adapter.setSubDataCb([this](const std::string& topic, const std::string& payload) {
+            // Adapter's context must not be blocked by node
+            m_tasks.execute(*m_executor, [this, topic, payload]() {
+                this->subDataCb(topic, payload);
+            });
+        });
 
         // Wait until connected
         auto future = m_connectingPromise.get_future();
@@ -47,6 +52,8 @@ namespace SPSP::FarLayers::MQTT
 
     MQTT::~MQTT()
     {
+        m_tasks.wait();
+
         SPSP_LOGI("Deinitialized");
     }
 
@@ -74,6 +81,13 @@ namespace SPSP::FarLayers::MQTT
         return m_adapter.subscribe(topic);
     }
 
+    void MQTT::subscribeAsync(const std::string& topic, FarLayerDoneCb cb)
+    {
+        SPSP_LOGD("Subscribe (async) to topic '%s'", topic.c_str());
+
+        m_adapter.subscribeAsync(topic, this->doneCb(cb));
+    }
+
     bool MQTT::unsubscribe(const std::string& topic)
     {
         SPSP_LOGD("Unsubscribe from topic '%s'", topic.c_str());
@@ -82,6 +96,29 @@ namespace SPSP::FarLayers::MQTT
         return m_adapter.unsubscribe(topic);
     }
 
+    void MQTT::unsubscribeAsync(const std::string& topic, FarLayerDoneCb cb)
+    {
+        SPSP_LOGD("Unsubscribe (async) from topic '%s'", topic.c_str());
+
+        m_adapter.unsubscribeAsync(topic, this->doneCb(cb));
+    }
+
+    void MQTT::subscribeManyAsync(const std::vector<std::string>& topics,
+                                  FarLayerDoneCb cb)
+    {
+        SPSP_LOGD("Subscribe (async) to %zu topics", topics.size());
+
+        this->pipelineStart(topics, true, cb);
+    }
+
+    void MQTT::unsubscribeManyAsync(const std::vector<std::string>& topics,
+                                    FarLayerDoneCb cb)
+    {
+        SPSP_LOGD("Unsubscribe (async) from %zu topics", topics.size());
+
+        this->pipelineStart(topics, false, cb);
+    }
+
     void MQTT::connectedCb()
     {
         if (m_initializing) {
@@ -95,6 +132,81 @@ namespace SPSP::FarLayers::MQTT
         }
     }
 
+    AdapterDoneCb MQTT::doneCb(FarLayerDoneCb cb)
+    {
+        return [this, cb](bool success) {
+            // Node mustn't lose completion, run it here if executor drops it
+            bool queued = m_tasks.execute(*m_executor, [cb, success]() {
+                cb(success);
+            });
+
+            if (!queued) {
+                cb(success);
+            }
+        };
+    }
+
+    void MQTT::pipelineStart(const std::vector<std::string>& topics,
+                             bool subscribe, FarLayerDoneCb cb)
+    {
+        auto state = std::make_shared<Pipeline>();
+        state->subscribe = subscribe;
+        state->cb = this->doneCb(cb);
+
+        if (topics.empty()) {
+            state->cb(true);
+            return;
+        }
+
+        // Split into chunks
+        size_t chunkSize = std::max<size_t>(m_conf.batch.topics, 1);
+        for (size_t i = 0; i < topics.size(); i += chunkSize) {
+            auto end = topics.begin() + std::min(i + chunkSize, topics.size());
+            state->chunks.emplace_back(topics.begin() + i, end);
+        }
+
+        // Fill the pipeline
+        size_t inFlight = std::clamp<size_t>(m_conf.batch.inFlight, 1,
+                                             state->chunks.size());
+        state->remaining = state->chunks.size();
+        state->next = inFlight;
+
+        for (size_t i = 0; i < inFlight; i++) {
+            this->pipelineRun(state, i);
+        }
+    }
+
+    void MQTT::pipelineRun(std::shared_ptr<Pipeline> state, size_t idx)
+    {
+        auto& chunk = state->chunks[idx];
+
+        SPSP_LOGD("%s request %zu/%zu (%zu topics)",
+                  state->subscribe ? "Subscribe" : "Unsubscribe",
+                  idx + 1, state->chunks.size(), chunk.size());
+
+        auto chunkDone = [this, state](bool success) {
+            if (!success) {
+                state->success = false;
+            }
+
+            // Send next chunk before counting this one as finished
+            size_t next = state->next++;
+            if (next < state->chunks.size()) {
+                this->pipelineRun(state, next);
+            }
+
+            if (--state->remaining == 0) {
+                state->cb(state->success);
+            }
+        };
+
+        if (state->subscribe) {
+            m_adapter.subscribeManyAsync(chunk, chunkDone);
+        } else {
+            m_adapter.unsubscribeManyAsync(chunk, chunkDone);
+        }
+    }
+
     void MQTT::subDataCb(const std::string& topic, const std::string& payload)
     {
         if (this->nodeConnected()) {
@@ -7,8 +7,6 @@
  *
  */
 
-#include <thread>
-
 #include "esp_now.h"
 
 #include "spsp/espnow_adapter.hpp"
@@ -34,15 +32,11 @@ namespace SPSP::LocalLayers::ESPNOW
             return;
         }
 
-        // Create new thread for receive handler
+        // Layer copies data and runs receive handler in its executor
         // Otherwise creates deadlock, because receive callback tries to send
         // response, but ESP-NOW's internal mutex is still held by this
         // unfinished callback.
-        std::thread t(cb, espnowInfo->src_addr,
-                      std::string((char*) data, dataLen), rssi);
-
-        // Run independently
-        t.detach();
+        cb(LocalAddrT{espnowInfo->src_addr}, const_cast<uint8_t*>(data), dataLen, rssi);
     }
 
     // Wrapper for C send callback
@@ -54,7 +48,13 @@ namespace SPSP::LocalLayers::ESPNOW
             return;
         }
 
-        cb(dst, status == ESP_NOW_SEND_SUCCESS);
+        // Pass send handler to dedicated worker
+        // Send callback starts delivery of the next queued packet and runs
+        // completion callbacks, which mustn't be done from WiFi task.
+        _adapterInstance->getSendExecutor().execute(
+            [cb, dst = LocalAddrT(dst), delivered = status == ESP_NOW_SEND_SUCCESS]() {
+                cb(dst, delivered);
+            });
     }
 
     Adapter::Adapter()
@@ -94,15 +94,19 @@ namespace SPSP::LocalLayers::ESPNOW
         return m_sendCb;
     }
 
-    void Adapter::send(const LocalAddrT& dst, const std::string& data)
+    IExecutor& Adapter::getSendExecutor() noexcept
+    {
+        return m_sendExecutor;
+    }
+
+    void Adapter::send(const LocalAddrT& dst, TxFrame& frame)
     {
         // Get MAC address
         esp_now_peer_info_t peerInfo = {};
         dst.toMAC(peerInfo.peer_addr);
 
-        SPSP_ERROR_CHECK(esp_now_send(peerInfo.peer_addr,
-                                      (const uint8_t*) data.c_str(),
-                                      data.length()),
+        SPSP_ERROR_CHECK(esp_now_send(peerInfo.peer_addr, frame.packet(),
+                                      frame.len),
                          AdapterError("Sending failed"));
     }
 
@@ -125,4 +129,9 @@ namespace SPSP::LocalLayers::ESPNOW
         SPSP_ERROR_CHECK(esp_now_del_peer(peerInfo.peer_addr),
                          AdapterError("Deleting peer failed"));
     }
+
+    size_t Adapter::getMaxPeerNum() const noexcept
+    {
+        return MAX_PEER_NUM;
+    }
 } // namespace SPSP::LocalLayers::ESPNOW
@@ -8,7 +8,6 @@
  */
 
 #include <chrono>
-#include <thread>
 
 #include "esp_mac.h"
 
@@ -54,8 +53,7 @@ namespace SPSP::FarLayers::MQTT
 
             // Call subscription data callback if defined
             if (inst->getSubDataCb() != nullptr) {
-                std::thread t(inst->getSubDataCb(), topic, data);
-                t.detach();
+                inst->getSubDataCb()(topic, data);
             }
             break;
 
@@ -11,12 +11,15 @@
 #include <chrono>
 #include <cstdint>
 #include <cstring>
+#include <fcntl.h>
 #include <linux/filter.h>
 #include <linux/if_arp.h>
 #include <linux/if_ether.h>
+#include <linux/if_packet.h>
 #include <sys/epoll.h>
 #include <sys/eventfd.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
 #include <sys/socket.h>
 #include <thread>
 #include <unistd.h>
@@ -48,9 +51,67 @@ namespace SPSP::LocalLayers::ESPNOW
 
     Adapter::RawSocket::~RawSocket()
     {
+        if (ring != nullptr) {
+            munmap(ring, ringBlockSize * ringBlockNum);
+        }
+
         close(fd);
     }
 
+    bool Adapter::RawSocket::setupRxRing(const AdapterConfig::RxRing& conf)
+    {
+        // Frame size is only relevant for `TPACKET_V1/2`, but kernel
+        // still validates it
+        constexpr size_t FRAME_SIZE = 2048;
+
+        int ret;
+
+        // Block size must be a multiple of page size
+        const size_t pageSize = sysconf(_SC_PAGESIZE);
+        size_t blockSize = conf.blockSize < FRAME_SIZE ? FRAME_SIZE : conf.blockSize;
+        blockSize = (blockSize + pageSize - 1) / pageSize * pageSize;
+        const size_t blockNum = conf.blockNum > 0 ? conf.blockNum : 1;
+
+        int version = TPACKET_V3;
+        ret = setsockopt(fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version));
+        if (ret < 0) {
+            SPSP_LOGW("RX ring: packet version: %s", strerror(errno));
+            return false;
+        }
+
+        tpacket_req3 req = {};
+        req.tp_block_size = blockSize;
+        req.tp_block_nr = blockNum;
+        req.tp_frame_size = FRAME_SIZE;
+        req.tp_frame_nr = blockSize / FRAME_SIZE * blockNum;
+        req.tp_retire_blk_tov = conf.blockTimeout.count();
+
+        ret = setsockopt(fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req));
+        if (ret < 0) {
+            SPSP_LOGW("RX ring: request: %s", strerror(errno));
+            return false;
+        }
+
+        void* mem = mmap(nullptr, blockSize * blockNum, PROT_READ | PROT_WRITE,
+                         MAP_SHARED, fd, 0);
+        if (mem == MAP_FAILED) {
+            SPSP_LOGW("RX ring: mmap: %s", strerror(errno));
+
+            // Release ring in kernel
+            req = {};
+            setsockopt(fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req));
+            return false;
+        }
+
+        ring = static_cast<uint8_t*>(mem);
+        ringBlockSize = blockSize;
+        ringBlockNum = blockNum;
+        ringBlockCur = 0;
+
+        SPSP_LOGI("RX ring: mapped %zu blocks of %zu bytes", blockNum, blockSize);
+        return true;
+    }
+
     Adapter::EventFD::EventFD()
     {
         fd = eventfd(0, EFD_NONBLOCK);
@@ -64,10 +125,26 @@ namespace SPSP::LocalLayers::ESPNOW
         close(fd);
     }
 
-    Adapter::Adapter(const std::string& ifname)
+    Adapter::Adapter(const std::string& ifname, const AdapterConfig& conf,
+                     IExecutor* executor)
+        : m_executor{executor},
+          m_sendQueue(conf.send.queueSize > 0 ? conf.send.queueSize : 1)
     {
         int ret;
 
+        // Own workers only if there's no executor
+        if (m_executor == nullptr) {
+            m_recvPool = std::make_unique<WorkerPool<RecvItem>>(
+                conf.recv.workers, conf.recv.queueSize, conf.recv.overflow,
+                std::bind(&Adapter::recvWorker, this, std::placeholders::_1));
+        }
+
+        // Preallocate batch buffers for handler
+        const size_t batchSize = conf.send.batchSize > 0 ? conf.send.batchSize : 1;
+        m_sendMsgs.resize(batchSize);
+        m_sendIovs.resize(batchSize);
+        m_sendDone.reserve(batchSize);
+
         ifreq ifinfo = {};
         strncpy(ifinfo.ifr_name, ifname.c_str(), IFNAMSIZ);
 
@@ -77,6 +154,11 @@ namespace SPSP::LocalLayers::ESPNOW
             throw AdapterError(std::string("Get interface index: ") + strerror(errno));
         }
 
+        // Set up receive ring (must be done before binding)
+        if (conf.rxRing.enabled && !m_sock.setupRxRing(conf.rxRing)) {
+            SPSP_LOGW("RX ring: falling back to read()");
+        }
+
         sockaddr_ll bindAddr = {};
         bindAddr.sll_family = PF_PACKET;
         bindAddr.sll_protocol = htons(ETH_P_ALL);
@@ -101,6 +183,12 @@ namespace SPSP::LocalLayers::ESPNOW
         // Create filter
         this->attachSocketFilter();
 
+        // Make socket non-blocking (injection is driven by `EPOLLOUT`)
+        int flags = fcntl(m_sock.fd, F_GETFL);
+        if (flags < 0 || fcntl(m_sock.fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+            throw AdapterError(std::string("Socket non-blocking: ") + strerror(errno));
+        }
+
         // Initialize epoll
         m_epollFd = epoll_create1(0);
         if (m_epollFd < 0) {
@@ -117,6 +205,11 @@ namespace SPSP::LocalLayers::ESPNOW
         eventFdEvent.data.fd = m_eventFd.fd;
         epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_eventFd.fd, &eventFdEvent);
 
+        epoll_event sendEventFdEvent;
+        sendEventFdEvent.events = EPOLLIN;
+        sendEventFdEvent.data.fd = m_sendEventFd.fd;
+        epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_sendEventFd.fd, &sendEventFdEvent);
+
         // Create handler thread
         m_thread = std::thread(&Adapter::handlerThread, this);
     }
@@ -124,6 +217,7 @@ namespace SPSP::LocalLayers::ESPNOW
     Adapter::~Adapter()
     {
         // Notify handler to stop
+        m_run = false;
         uint64_t v = 1;
         if (write(m_eventFd.fd, &v, sizeof(v)) < 0) {
             SPSP_LOGE("Handler thread join notification failed. "
@@ -133,6 +227,9 @@ namespace SPSP::LocalLayers::ESPNOW
 
         // Wait for handler
         m_thread.join();
+
+        // Wait for receive callbacks in executor
+        m_recvTasks.wait();
     }
 
     void Adapter::attachSocketFilter()
@@ -203,11 +300,15 @@ namespace SPSP::LocalLayers::ESPNOW
         }
     }
 
-    void Adapter::send(const LocalAddrT& dst, const std::string& data)
+    void Adapter::send(const LocalAddrT& dst, TxFrame& frame)
     {
-        uint8_t buf[MAX_PACKET_SIZE] = {};
-        auto packet = reinterpret_cast<ActionFrameWithRadiotap*>(buf);
-        size_t len = sizeof(ActionFrameWithRadiotap) + data.length();
+        static_assert(sizeof(ActionFrameWithRadiotap) <= TX_FRAME_HEADROOM,
+                      "Headers don't fit into frame headroom");
+
+        // Build headers in headroom, directly in front of the packet
+        uint8_t* data = frame.packet() - sizeof(ActionFrameWithRadiotap);
+        size_t len = sizeof(ActionFrameWithRadiotap) + frame.len;
+        auto packet = reinterpret_cast<ActionFrameWithRadiotap*>(data);
 
         // Populate defaults
         *packet = ActionFrameWithRadiotap{};
@@ -215,42 +316,137 @@ namespace SPSP::LocalLayers::ESPNOW
         // Populate fields
         dst.toMAC(packet->action.dst);
         m_localAddr.toMAC(packet->action.src);
-        packet->action.content.setPayloadLen(data.length());
-
-        // Copy payload
-        memcpy(packet->action.content.payload, data.c_str(), data.length());
-
-        SPSP_LOGD("Send: sending %zu bytes on 802.11", len);
-
-        // Write to send buffer
-        if (write(m_sock.fd, buf, len) < 0) {
-            throw AdapterError(std::string("Send: ") + strerror(errno));
-        }
-
-        // Mark packet as delivered successfully
-        // TODO: check delivery status
-        // I'm not aware of reasonable method for querying delivery status
-        // (whether acknowledgement frame for this action frame has been
-        // received).
-        // Waiting for ACK with timeout is inefficient, because it blocks
-        // the interface for too long when many frames are lost.
-        // For now, I'll stick to unconfirmed delivery, as Linux post is
-        // primarily meant for bridge nodes and there's no logic for
-        // retransmissions anyway.
-        // Reference for future self:
-        // https://www.kernel.org/doc/html/v6.8/networking/mac80211-injection.html
-        if (this->getSendCb() != nullptr) {
-            std::thread t(this->getSendCb(), dst, true);
-            t.detach();
+        packet->action.content.setPayloadLen(frame.len);
+
+        {   // Mutex
+            const std::scoped_lock lock(m_sendMutex);
+
+            if (m_sendCount == m_sendQueue.size()) {
+                throw AdapterError("Send: queue full");
+            }
+
+            m_sendQueue[(m_sendHead + m_sendCount) % m_sendQueue.size()] = {
+                .dst = dst,
+                .data = data,
+                .len = len,
+            };
+            m_sendCount++;
+        }  // Mutex
+
+        SPSP_LOGD("Send: queued %zu bytes for 802.11", len);
+
+        // Wake up handler
+        uint64_t v = 1;
+        if (write(m_sendEventFd.fd, &v, sizeof(v)) < 0) {
+            SPSP_LOGE("Send: handler notification failed: %s", strerror(errno));
+        }
+    }
+
+    void Adapter::flushSendQueue()
+    {
+        // Frames stay valid until their send callback, which is called
+        // from here after injection.
+        while (true) {
+            size_t batchLen;
+
+            {   // Mutex
+                const std::scoped_lock lock(m_sendMutex);
+
+                batchLen = std::min(m_sendCount, m_sendMsgs.size());
+
+                for (size_t i = 0; i < batchLen; i++) {
+                    auto& item = m_sendQueue[(m_sendHead + i) % m_sendQueue.size()];
+                    m_sendIovs[i] = {.iov_base = item.data, .iov_len = item.len};
+                    m_sendMsgs[i] = {};
+                    m_sendMsgs[i].msg_hdr.msg_iov = &m_sendIovs[i];
+                    m_sendMsgs[i].msg_hdr.msg_iovlen = 1;
+                }
+            }  // Mutex
+
+            if (batchLen == 0) {
+                this->waitWritable(false);
+                return;
+            }
+
+            int sent = sendmmsg(m_sock.fd, m_sendMsgs.data(), batchLen, 0);
+            bool delivered = true;
+
+            if (sent < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    // Socket buffer is full - continue when writable
+                    this->waitWritable(true);
+                    return;
+                }
+
+                if (errno == EINTR) {
+                    continue;
+                }
+
+                // Drop the first frame and report it as undelivered
+                SPSP_LOGE("Send: %s", strerror(errno));
+                sent = 1;
+                delivered = false;
+            }
+
+            {   // Mutex
+                const std::scoped_lock lock(m_sendMutex);
+
+                m_sendDone.clear();
+
+                for (int i = 0; i < sent; i++) {
+                    m_sendDone.push_back(m_sendQueue[m_sendHead].dst);
+                    m_sendHead = (m_sendHead + 1) % m_sendQueue.size();
+                    m_sendCount--;
+                }
+            }  // Mutex
+
+            SPSP_LOGD("Send: injected %d frames", sent);
+
+            // Mark packets as delivered successfully
+            // TODO: check delivery status
+            // I'm not aware of reasonable method for querying delivery status
+            // (whether acknowledgement frame for this action frame has been
+            // received).
+            // Waiting for ACK with timeout is inefficient, because it blocks
+            // the interface for too long when many frames are lost.
+            // For now, I'll stick to unconfirmed delivery, as Linux post is
+            // primarily meant for bridge nodes and there's no logic for
+            // retransmissions anyway.
+            // Reference for future self:
+            // https://www.kernel.org/doc/html/v6.8/networking/mac80211-injection.html
+            auto cb = this->getSendCb();
+            if (cb != nullptr) {
+                for (auto& dst : m_sendDone) {
+                    cb(dst, delivered);
+                }
+            }
         }
     }
 
+    void Adapter::waitWritable(bool enable)
+    {
+        if (m_sendWaitWritable == enable) {
+            return;
+        }
+
+        epoll_event epollEvent;
+        epollEvent.events = enable ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+        epollEvent.data.fd = m_sock.fd;
+
+        if (epoll_ctl(m_epollFd, EPOLL_CTL_MOD, m_sock.fd, &epollEvent) < 0) {
+            SPSP_LOGE("Send: epoll modify: %s", strerror(errno));
+            return;
+        }
+
+        m_sendWaitWritable = enable;
+    }
+
     void Adapter::handlerThread()
     {
-        constexpr size_t EVENTS_LEN = 1;
+        constexpr size_t EVENTS_LEN = 3;
         epoll_event events[EVENTS_LEN];
 
-        // Buffer for incoming packets
+        // Buffer for incoming packets (not used with receive ring)
         uint8_t buf[MAX_PACKET_SIZE];
 
         while (true) {
@@ -264,28 +460,95 @@ namespace SPSP::LocalLayers::ESPNOW
                 }
             }
 
-            if (events[0].events & EPOLLIN) {
-                if (events[0].data.fd == m_sock.fd) {
-                    // Received data
-                    size_t len = read(events[0].data.fd, buf, MAX_PACKET_SIZE);
+            for (int i = 0; i < ret; i++) {
+                const int fd = events[i].data.fd;
+                const uint32_t ev = events[i].events;
 
-                    if (len == 0) {
-                        continue;
-                    }
+                if (fd == m_eventFd.fd && (ev & EPOLLIN)) {
+                    // Destructor signal
+                    return;
+                }
 
-                    if (len < 0) {
-                        SPSP_LOGE("Receive read: %s", strerror(errno));
-                        continue;
+                if (fd == m_sendEventFd.fd && (ev & EPOLLIN)) {
+                    // Frames queued - reset counter and inject them
+                    uint64_t v;
+                    if (read(m_sendEventFd.fd, &v, sizeof(v)) < 0 && errno != EAGAIN) {
+                        SPSP_LOGE("Send notification read: %s", strerror(errno));
                     }
 
-                    this->processIEEE80211RawPacket(buf, len);
+                    this->flushSendQueue();
+                    continue;
                 }
 
-                if (events[0].data.fd == m_eventFd.fd) {
-                    // Destructor signal
-                    return;
+                if (fd != m_sock.fd) {
+                    continue;
+                }
+
+                if (ev & EPOLLOUT) {
+                    // Socket became writable
+                    this->flushSendQueue();
                 }
+
+                if (!(ev & EPOLLIN)) {
+                    continue;
+                }
+
+                // Received data
+                if (m_sock.ring != nullptr) {
+                    this->processRxRing();
+                    continue;
+                }
+
+                ssize_t len = read(m_sock.fd, buf, MAX_PACKET_SIZE);
+
+                if (len == 0) {
+                    continue;
+                }
+
+                if (len < 0) {
+                    if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                        SPSP_LOGE("Receive read: %s", strerror(errno));
+                    }
+                    continue;
+                }
+
+                this->processIEEE80211RawPacket(buf, len);
+                this->flushRecvBatch();
+            }
+        }
+    }
+
+    void Adapter::processRxRing()
+    {
+        while (true) {
+            auto blockPtr = m_sock.ring + m_sock.ringBlockCur * m_sock.ringBlockSize;
+            auto block = reinterpret_cast<tpacket_block_desc*>(blockPtr);
+
+            // Stop on first block still owned by kernel
+            auto status = __atomic_load_n(&block->hdr.bh1.block_status,
+                                          __ATOMIC_ACQUIRE);
+            if (!(status & TP_STATUS_USER)) {
+                return;
             }
+
+            // Walk frames of the block
+            const uint32_t numPkts = block->hdr.bh1.num_pkts;
+            auto framePtr = blockPtr + block->hdr.bh1.offset_to_first_pkt;
+
+            for (uint32_t i = 0; i < numPkts; i++) {
+                auto frame = reinterpret_cast<const tpacket3_hdr*>(framePtr);
+                this->processIEEE80211RawPacket(framePtr + frame->tp_mac,
+                                                frame->tp_snaplen);
+                framePtr += frame->tp_next_offset;
+            }
+
+            this->flushRecvBatch();
+
+            // Return block to kernel
+            __atomic_store_n(&block->hdr.bh1.block_status, TP_STATUS_KERNEL,
+                             __ATOMIC_RELEASE);
+
+            m_sock.ringBlockCur = (m_sock.ringBlockCur + 1) % m_sock.ringBlockNum;
         }
     }
 
@@ -410,20 +673,88 @@ namespace SPSP::LocalLayers::ESPNOW
             SPSP_LOGD("Receive raw action: packet with payload has invalid size");
             return;
         }
+        if (payloadLen > MAX_PACKET_LENGTH) {
+            SPSP_LOGD("Receive raw action: payload too long (%zu > %zu bytes)",
+                      payloadLen, MAX_PACKET_LENGTH);
+            return;
+        }
 
-        auto cb = this->getRecvCb();
-        if (cb == nullptr) {
+        if (this->getRecvCb() == nullptr && this->getRecvBatchCb() == nullptr) {
+            return;
+        }
+
+        // Add to batch for receive worker
+        // This is the only copy of payload - worker decrypts it in-place.
+        auto& packet = m_recvBatch.packets[m_recvBatch.count++];
+        packet.src = action->src;
+        memcpy(packet.data, action->content.payload, payloadLen);
+        packet.len = payloadLen;
+        packet.rssi = rssi;
+
+        if (m_recvBatch.count == RECV_BATCH_LEN) {
+            this->flushRecvBatch();
+        }
+    }
+
+    void Adapter::flushRecvBatch()
+    {
+        if (m_recvBatch.count == 0) {
             return;
         }
 
-        // Create new thread for receive handler
-        // Otherwise creates deadlock, because receive callback tries to send
-        // response, but ESP-NOW's internal mutex is still held by this
-        // unfinished callback.
-        std::string payload((char*) action->content.payload, payloadLen);
-        std::thread t(cb, action->src, payload, rssi);
+        // Pass to receive worker
+        // Callback can't be called from this thread, otherwise creates
+        // deadlock, because receive callback tries to send response, but
+        // ESP-NOW's internal mutex is still held by this unfinished callback.
+        RecvItem& item = m_recvBatch;
+
+        if (m_executor != nullptr) {
+            // This thread must not wait for executor (it runs send callbacks)
+            auto batch = std::make_shared<RecvItem>(std::move(item));
+            bool queued = m_recvTasks.tryExecute(*m_executor, [this, batch]() {
+                this->recvWorker(*batch);
+            });
+
+            if (!queued) {
+                SPSP_LOGD("Receive raw action: executor busy, %zu packets dropped",
+                          batch->count);
+            }
+        } else if (m_recvPool->getPolicy() != OverflowPolicy::BLOCK) {
+            if (!m_recvPool->push(std::move(item))) {
+                SPSP_LOGD("Receive raw action: receive queue full, %zu packets dropped",
+                          item.count);
+            }
+        } else {
+            // Blocking policy: keep injecting queued frames while waiting,
+            // as workers may be waiting for send callbacks from this thread
+            while (m_run && !m_recvPool->pushFor(std::move(item), 1ms)) {
+                this->flushSendQueue();
+            }
+        }
+
+        m_recvBatch.count = 0;
+    }
+
+    void Adapter::recvWorker(RecvItem& item)
+    {
+        auto batchCb = this->getRecvBatchCb();
+        if (batchCb != nullptr) {
+            AdapterRecvItem items[RECV_BATCH_LEN];
+            for (size_t i = 0; i < item.count; i++) {
+                auto& packet = item.packets[i];
+                items[i] = {packet.src, packet.data, packet.len, packet.rssi};
+            }
 
-        // Run independently
-        t.detach();
+            batchCb(items, item.count);
+            return;
+        }
+
+        auto cb = this->getRecvCb();
+        if (cb != nullptr) {
+            for (size_t i = 0; i < item.count; i++) {
+                auto& packet = item.packets[i];
+                cb(packet.src, packet.data, packet.len, packet.rssi);
+            }
+        }
     }
 } // namespace SPSP::LocalLayers::ESPNOW
@@ -8,7 +8,7 @@
  */
 
 #include <chrono>
-#include <thread>
+#include <memory>
 
 #include "spsp/logger.hpp"
 #include "spsp/mac.hpp"
@@ -162,6 +162,96 @@ namespace SPSP::FarLayers::MQTT
         return ret == MQTTASYNC_SUCCESS;
     }
 
+    void Adapter::subscribeAsync(const std::string& topic, AdapterDoneCb cb)
+    {
+        int ret;
+        MQTTAsync_responseOptions opts = MQTTAsync_responseOptions_initializer;
+        opts.onSuccess = &Adapter::doneSuccessCb;
+        opts.onFailure = &Adapter::doneFailureCb;
+
+        // Owned by library (may be completed before this returns)
+        opts.context = new AdapterDoneCb(cb);
+
+        ret = MQTTAsync_subscribe(m_mqtt, topic.c_str(), m_conf.connection.qos, &opts);
+        if (ret != MQTTASYNC_SUCCESS) {
+            SPSP_LOGE("Subscribe: %s", MQTTAsync_strerror(ret));
+            Adapter::done(opts.context, false);
+        }
+    }
+
+    void Adapter::unsubscribeAsync(const std::string& topic, AdapterDoneCb cb)
+    {
+        int ret;
+        MQTTAsync_responseOptions opts = MQTTAsync_responseOptions_initializer;
+        opts.onSuccess = &Adapter::doneSuccessCb;
+        opts.onFailure = &Adapter::doneFailureCb;
+
+        // Owned by library (may be completed before this returns)
+        opts.context = new AdapterDoneCb(cb);
+
+        ret = MQTTAsync_unsubscribe(m_mqtt, topic.c_str(), &opts);
+        if (ret != MQTTASYNC_SUCCESS) {
+            SPSP_LOGE("Unsubscribe: %s", MQTTAsync_strerror(ret));
+            Adapter::done(opts.context, false);
+        }
+    }
+
+    void Adapter::subscribeManyAsync(const std::vector<std::string>& topics,
+                                     AdapterDoneCb cb)
+    {
+        int ret;
+        MQTTAsync_responseOptions opts = MQTTAsync_responseOptions_initializer;
+        opts.onSuccess = &Adapter::subscribeManySuccessCb;
+        opts.onFailure = &Adapter::subscribeManyFailureCb;
+
+        // Library copies topics before returning
+        std::vector<char*> topicsC;
+        topicsC.reserve(topics.size());
+        for (auto& topic : topics) {
+            topicsC.push_back(const_cast<char*>(topic.c_str()));
+        }
+        std::vector<int> qos(topics.size(), m_conf.connection.qos);
+
+        // Owned by library (may be completed before this returns)
+        auto ctx = new SubscribeManyCtx{cb, topics.size()};
+        opts.context = ctx;
+
+        ret = MQTTAsync_subscribeMany(m_mqtt, topicsC.size(), topicsC.data(),
+                                      qos.data(), &opts);
+        if (ret != MQTTASYNC_SUCCESS) {
+            SPSP_LOGE("Subscribe many: %s", MQTTAsync_strerror(ret));
+            std::unique_ptr<SubscribeManyCtx> owned{ctx};
+            if (owned->cb != nullptr) {
+                owned->cb(false);
+            }
+        }
+    }
+
+    void Adapter::unsubscribeManyAsync(const std::vector<std::string>& topics,
+                                       AdapterDoneCb cb)
+    {
+        int ret;
+        MQTTAsync_responseOptions opts = MQTTAsync_responseOptions_initializer;
+        opts.onSuccess = &Adapter::doneSuccessCb;
+        opts.onFailure = &Adapter::doneFailureCb;
+
+        // Library copies topics before returning
+        std::vector<char*> topicsC;
+        topicsC.reserve(topics.size());
+        for (auto& topic : topics) {
+            topicsC.push_back(const_cast<char*>(topic.c_str()));
+        }
+
+        // Owned by library (may be completed before this returns)
+        opts.context = new AdapterDoneCb(cb);
+
+        ret = MQTTAsync_unsubscribeMany(m_mqtt, topicsC.size(), topicsC.data(), &opts);
+        if (ret != MQTTASYNC_SUCCESS) {
+            SPSP_LOGE("Unsubscribe many: %s", MQTTAsync_strerror(ret));
+            Adapter::done(opts.context, false);
+        }
+    }
+
     void Adapter::connectedCb(void* ctx, char* cause)
     {
         auto inst = static_cast<Adapter*>(ctx);
@@ -195,8 +285,7 @@ namespace SPSP::FarLayers::MQTT
 
         // Call subscription data callback if defined
         if (inst->getSubDataCb() != nullptr) {
-            std::thread t(inst->getSubDataCb(), topic, data);
-            t.detach();
+            inst->getSubDataCb()(topic, data);
         }
 
         MQTTAsync_freeMessage(&msg);
@@ -205,6 +294,63 @@ namespace SPSP::FarLayers::MQTT
         return true;
     }
 
+    void Adapter::doneSuccessCb(void* ctx, MQTTAsync_successData* resp)
+    {
+        Adapter::done(ctx, true);
+    }
+
+    void Adapter::doneFailureCb(void* ctx, MQTTAsync_failureData* resp)
+    {
+        SPSP_LOGW("Request failed: %s", MQTTAsync_strerror(resp->code));
+        Adapter::done(ctx, false);
+    }
+
+    void Adapter::done(void* ctx, bool success)
+    {
+        std::unique_ptr<AdapterDoneCb> cb{static_cast<AdapterDoneCb*>(ctx)};
+
+        if (*cb != nullptr) {
+            (*cb)(success);
+        }
+    }
+
+    void Adapter::subscribeManySuccessCb(void* ctx, MQTTAsync_successData* resp)
+    {
+        std::unique_ptr<SubscribeManyCtx> c{static_cast<SubscribeManyCtx*>(ctx)};
+
+        // Library reports single granted QoS for single topic, list otherwise
+        size_t refused = 0;
+        if (c->count == 1) {
+            refused = resp->alt.qos == MQTT_BAD_SUBSCRIBE;
+        } else {
+            for (size_t i = 0; i < c->count; i++) {
+                if (resp->alt.qosList[i] == MQTT_BAD_SUBSCRIBE) {
+                    refused++;
+                }
+            }
+        }
+
+        if (refused > 0) {
+            SPSP_LOGW("Subscribe many: %zu of %zu topics refused by broker",
+                      refused, c->count);
+        }
+
+        if (c->cb != nullptr) {
+            c->cb(refused == 0);
+        }
+    }
+
+    void Adapter::subscribeManyFailureCb(void* ctx, MQTTAsync_failureData* resp)
+    {
+        std::unique_ptr<SubscribeManyCtx> c{static_cast<SubscribeManyCtx*>(ctx)};
+
+        SPSP_LOGW("Subscribe many failed: %s", MQTTAsync_strerror(resp->code));
+
+        if (c->cb != nullptr) {
+            c->cb(false);
+        }
+    }
+
     void Adapter::setSubDataCb(AdapterSubDataCb cb)
     {
         m_subDataCb = cb;
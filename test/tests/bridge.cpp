@@ -1,12 +1,17 @@
 #include <catch2/catch_test_macros.hpp>
 
+#include <atomic>
 #include <chrono>
+#include <functional>
+#include <future>
+#include <mutex>
 #include <string>
 #include <thread>
 #include <unordered_set>
 #include <vector>
 
 #include "spsp/bridge.hpp"
+#include "spsp/executor.hpp"
 #include "spsp/layers_dummy.hpp"
 #include "spsp/local_addr.hpp"
 #include "spsp/local_addr_mac.hpp"
@@ -42,6 +47,7 @@ const Nodes::BridgeConfig CONF = {
         .interval = 10ms,
         .subLifetime = 100ms,
     },
+    .dispatch = {},
 };
 const LocalMessageT MSG_SUB1 = {
     .type = LocalMessageType::SUB_REQ,
@@ -122,6 +128,79 @@ TEST_CASE("Subscribe", "[Bridge]") {
     CHECK(fl.getUnsubsLog() == SubsLogT{});
 }
 
+/**
+ * @brief Far layer running hook on unsubscribe, which can fail
+ *
+ */
+class HookedFarLayer : public FarLayers::DummyFarLayer
+{
+public:
+    std::function<void(const std::string&)> m_unsubHook;  //!< Called before unsubscribe
+    std::atomic<size_t> m_unsubFailures = 0;              //!< Number of unsubscribes to fail
+
+    virtual bool unsubscribe(const std::string& topic)
+    {
+        if (m_unsubHook) m_unsubHook(topic);
+
+        if (m_unsubFailures > 0) {
+            m_unsubFailures--;
+            return false;
+        }
+
+        return FarLayers::DummyFarLayer::unsubscribe(topic);
+    }
+};
+
+/**
+ * @brief Far layer completing subscribes only when asked to
+ *
+ */
+class DeferredFarLayer : public FarLayers::DummyFarLayer
+{
+    std::mutex m_pendingMutex;
+    std::vector<std::pair<std::string, FarLayerDoneCb>> m_pending;
+
+public:
+    virtual void subscribeAsync(const std::string& topic, FarLayerDoneCb cb)
+    {
+        const std::scoped_lock lock(m_pendingMutex);
+        m_pending.push_back({ topic, cb });
+    }
+
+    size_t pendingCount()
+    {
+        const std::scoped_lock lock(m_pendingMutex);
+        return m_pending.size();
+    }
+
+    void complete(bool success)
+    {
+        decltype(m_pending) pending;
+        {
+            const std::scoped_lock lock(m_pendingMutex);
+            pending.swap(m_pending);
+        }
+
+        for (auto& [topic, cb] : pending) {
+            cb(success && this->subscribe(topic));
+        }
+    }
+};
+
+/**
+ * @brief Waits until dispatch executor of bridge processes far messages
+ *
+ * @param br Bridge
+ * @param processed Total number of far messages to be processed
+ */
+template <typename TBridge>
+void waitForDispatch(TBridge& br, uint64_t processed)
+{
+    for (int i = 0; i < 1000 && br.getDispatchStats().queue.processed < processed; i++) {
+        std::this_thread::sleep_for(1ms);
+    }
+}
+
 TEST_CASE("Resubscribe", "[Bridge]") {
     LocalLayers::DummyLocalLayer ll{};
     FarLayers::DummyFarLayer fl{};
@@ -209,6 +288,210 @@ TEST_CASE("Unsubscribe", "[Bridge]") {
     }
 }
 
+TEST_CASE("Unsubscribe unused topics", "[Bridge]") {
+    LocalLayers::DummyLocalLayer ll{};
+    HookedFarLayer fl{};
+
+    // No ticks, only explicit unsubscribes call far layer
+    auto conf = CONF;
+    conf.subDB.shards = 1;
+    conf.subDB.interval = 1h;
+    Nodes::Bridge br{&ll, &fl, conf};
+
+    REQUIRE(br.subscribe(TOPIC, nullptr));
+
+    SECTION("Far layer is called outside the lock") {
+        bool subscribedMeanwhile = false;
+
+        // Same shard (only one) must not be locked
+        fl.m_unsubHook = [&br, &subscribedMeanwhile](const std::string& topic) {
+            auto sub = std::async(std::launch::async, [&br] {
+                return br.subscribe(TOPIC_SUFFIX, nullptr);
+            });
+            subscribedMeanwhile = sub.wait_for(1s) == std::future_status::ready
+                                  && sub.get();
+        };
+
+        REQUIRE(br.unsubscribe(TOPIC));
+        fl.m_unsubHook = nullptr;
+
+        CHECK(subscribedMeanwhile);
+        CHECK(fl.getSubs() == SubsSetT{TOPIC_SUFFIX});
+    }
+
+    SECTION("Subscribed again during unsubscribe") {
+        fl.m_unsubHook = [&br](const std::string& topic) {
+            REQUIRE(br.subscribe(TOPIC, nullptr));
+        };
+
+        REQUIRE(br.unsubscribe(TOPIC));
+        fl.m_unsubHook = nullptr;
+
+        // Topic is kept (and subscribed again)
+        CHECK(fl.getSubs() == SubsSetT{TOPIC});
+        CHECK(fl.getUnsubsLog() == SubsLogT{TOPIC});
+
+        REQUIRE(br.unsubscribe(TOPIC));
+        CHECK(fl.getSubs() == SubsSetT{});
+    }
+}
+
+TEST_CASE("Retry failed unsubscribe", "[Bridge]") {
+    LocalLayers::DummyLocalLayer ll{};
+    HookedFarLayer fl{};
+    Nodes::Bridge br{&ll, &fl, CONF};
+
+    REQUIRE(br.subscribe(TOPIC, nullptr));
+
+    fl.m_unsubFailures = 1;
+
+    REQUIRE(br.unsubscribe(TOPIC));
+    CHECK(fl.getSubs() == SubsSetT{TOPIC});
+
+    // Retried in next tick
+    std::this_thread::sleep_for(2*CONF.subDB.interval);
+
+    CHECK(fl.getSubs() == SubsSetT{});
+    CHECK(fl.getUnsubsLog() == SubsLogT{TOPIC});
+}
+
+TEST_CASE("Pending far subscribe", "[Bridge]") {
+    LocalLayers::DummyLocalLayer ll{};
+    DeferredFarLayer fl{};
+
+    // No ticks
+    auto conf = CONF;
+    conf.subDB.interval = 1h;
+    Nodes::Bridge br{&ll, &fl, conf};
+
+    ll.receiveDirect(MSG_SUB1);
+    ll.receiveDirect(MSG_SUB2);
+
+    // SUB_REQs don't wait for far layer, topic is subscribed once
+    CHECK(fl.pendingCount() == 1);
+    CHECK(br.clientStats(ADDR_PEER1).subscriptions == 1);
+    CHECK(br.clientStats(ADDR_PEER2).subscriptions == 1);
+
+    SECTION("Confirmed") {
+        fl.complete(true);
+
+        CHECK(fl.getSubs() == SubsSetT{TOPIC});
+        CHECK(br.clientStats(ADDR_PEER1).subscriptions == 1);
+        CHECK(br.clientStats(ADDR_PEER2).subscriptions == 1);
+    }
+
+    SECTION("Refused") {
+        fl.complete(false);
+
+        // Subscribers are dropped
+        CHECK(fl.getSubs() == SubsSetT{});
+        CHECK(br.clientStats(ADDR_PEER1).subscriptions == 0);
+        CHECK(br.clientStats(ADDR_PEER2).subscriptions == 0);
+
+        // Subscribed again with next SUB_REQ
+        ll.receiveDirect(MSG_SUB1);
+        CHECK(fl.pendingCount() == 1);
+
+        fl.complete(true);
+        CHECK(fl.getSubs() == SubsSetT{TOPIC});
+    }
+
+    SECTION("Unsubscribed meanwhile") {
+        for (auto msg : {MSG_SUB1, MSG_SUB2}) {
+            msg.type = LocalMessageType::UNSUB;
+            ll.receiveDirect(msg);
+        }
+
+        // Unsubscribed after subscribe completes
+        CHECK(fl.getUnsubsLog() == SubsLogT{});
+
+        fl.complete(true);
+
+        CHECK(fl.getSubs() == SubsSetT{});
+        CHECK(fl.getUnsubsLog() == SubsLogT{TOPIC});
+    }
+
+    SECTION("Subscribed locally meanwhile, confirmed") {
+        auto sub = std::async(std::launch::async, [&br] {
+            return br.subscribe(TOPIC, nullptr);
+        });
+
+        // Waits for subscribe in flight, no duplicate request
+        CHECK(sub.wait_for(50ms) == std::future_status::timeout);
+        CHECK(fl.pendingCount() == 1);
+
+        fl.complete(true);
+
+        CHECK(sub.get());
+        CHECK(fl.getSubs() == SubsSetT{TOPIC});
+    }
+
+    SECTION("Subscribed locally meanwhile, refused") {
+        auto sub = std::async(std::launch::async, [&br] {
+            return br.subscribe(TOPIC, nullptr);
+        });
+
+        CHECK(sub.wait_for(50ms) == std::future_status::timeout);
+
+        fl.complete(false);
+
+        // Local subscriber is dropped too, so subscribe fails
+        CHECK(!sub.get());
+        CHECK(fl.getSubs() == SubsSetT{});
+        CHECK(br.clientStats(ADDR_PEER1).subscriptions == 0);
+
+        // Local node isn't subscribed (unsubscribe finds nothing)
+        CHECK(!br.unsubscribe(TOPIC));
+    }
+
+    SECTION("Resubscribed meanwhile") {
+        // No duplicate request
+        br.resubscribeAll();
+        CHECK(fl.pendingCount() == 1);
+
+        fl.complete(true);
+        CHECK(fl.getSubsLog() == SubsLogT{TOPIC});
+    }
+}
+
+TEST_CASE("Resubscribe during unsubscribe", "[Bridge]") {
+    LocalLayers::DummyLocalLayer ll{};
+    HookedFarLayer fl{};
+    Nodes::Bridge br{&ll, &fl, CONF};
+
+    REQUIRE(br.subscribe(TOPIC, nullptr));
+
+    // Topic with unsubscribe in flight isn't resubscribed
+    fl.m_unsubHook = [&br](const std::string&) { br.resubscribeAll(); };
+
+    REQUIRE(br.unsubscribe(TOPIC));
+    CHECK(fl.getSubs() == SubsSetT{});
+    CHECK(fl.getSubsLog() == SubsLogT{TOPIC});
+}
+
+TEST_CASE("Retry failed resubscribe", "[Bridge]") {
+    LocalLayers::DummyLocalLayer ll{};
+    DeferredFarLayer fl{};
+    Nodes::Bridge br{&ll, &fl, CONF};
+
+    ll.receiveDirect(MSG_SUB1);
+    fl.complete(true);
+
+    br.resubscribeAll();
+    REQUIRE(fl.pendingCount() == 1);
+    fl.complete(false);
+
+    // Subscriber is kept, topic is subscribed again in next tick
+    CHECK(br.clientStats(ADDR_PEER1).subscriptions == 1);
+    std::this_thread::sleep_for(2*CONF.subDB.interval);
+
+    REQUIRE(fl.pendingCount() == 1);
+    fl.complete(true);
+
+    CHECK(fl.getSubsLog() == SubsLogT{TOPIC, TOPIC});
+    CHECK(br.clientStats(ADDR_PEER1).subscriptions == 1);
+}
+
 TEST_CASE("Receive from local layer", "[Bridge]") {
     LocalLayers::DummyLocalLayer ll{};
     FarLayers::DummyFarLayer fl{};
@@ -305,6 +588,26 @@ TEST_CASE("Receive from local layer", "[Bridge]") {
         CHECK(fl.getUnsubsLog() == SubsLogT{msg.topic});
     }
 
+    SECTION("SUB_REQ renewed") {
+        msg.type = LocalMessageType::SUB_REQ;
+        ll.receiveDirect(msg);
+
+        std::this_thread::sleep_for(CONF.subDB.subLifetime / 2);
+        ll.receiveDirect(msg);
+        std::this_thread::sleep_for(CONF.subDB.subLifetime / 2
+                                    + 2*CONF.subDB.interval);
+
+        // Still subscribed thanks to renewal
+        CHECK(fl.getSubs() == SubsSetT{msg.topic});
+        CHECK(fl.getUnsubsLog() == SubsLogT{});
+
+        std::this_thread::sleep_for(CONF.subDB.subLifetime / 2);
+
+        CHECK(fl.getSubs() == SubsSetT{});
+        CHECK(fl.getSubsLog() == SubsLogT{msg.topic});
+        CHECK(fl.getUnsubsLog() == SubsLogT{msg.topic});
+    }
+
     SECTION("PUB with empty topic") {
         msg.type = LocalMessageType::PUB;
         msg.topic = "";
@@ -357,6 +660,99 @@ TEST_CASE("Receive from local layer", "[Bridge]") {
     }
 }
 
+TEST_CASE("Clients", "[Bridge]") {
+    LocalLayers::DummyLocalLayer ll{};
+    FarLayers::DummyFarLayer fl{};
+
+    auto conf = CONF;
+    conf.subDB.maxSubsPerClient = 2;
+
+    auto sub = [&ll](const LocalAddr& addr, const std::string& topic) {
+        auto msg = MSG_SUB1;
+        msg.addr = addr;
+        msg.topic = topic;
+        ll.receiveDirect(msg);
+    };
+
+    SECTION("Drop client") {
+        Nodes::Bridge br{&ll, &fl, conf};
+
+        sub(ADDR_PEER1, TOPIC);
+        sub(ADDR_PEER1, TOPIC_SUFFIX);
+        sub(ADDR_PEER2, TOPIC);
+
+        CHECK(br.clientStats(ADDR_PEER1).subscriptions == 2);
+        CHECK(br.clientStats(ADDR_PEER2).subscriptions == 1);
+
+        REQUIRE(br.dropClient(ADDR_PEER1));
+        REQUIRE(!br.dropClient(ADDR_PEER1));
+
+        // Topic of other client is kept
+        CHECK(fl.getSubs() == SubsSetT{TOPIC});
+        CHECK(fl.getUnsubsLog() == SubsLogT{TOPIC_SUFFIX});
+        CHECK(br.clientStats(ADDR_PEER1).subscriptions == 0);
+        CHECK(br.clientStats(ADDR_PEER2).subscriptions == 1);
+    }
+
+    SECTION("Quota") {
+        Nodes::Bridge br{&ll, &fl, conf};
+
+        sub(ADDR_PEER1, TOPIC);
+        sub(ADDR_PEER1, TOPIC_SUFFIX);
+        sub(ADDR_PEER1, TOPIC_SL_WILD);  // Rejected
+        sub(ADDR_PEER1, TOPIC);          // Renewal is allowed
+        sub(ADDR_PEER2, TOPIC_SL_WILD);
+
+        CHECK(fl.getSubs() == SubsSetT{TOPIC, TOPIC_SUFFIX, TOPIC_SL_WILD});
+        CHECK(fl.getSubsLog() == SubsLogT{TOPIC, TOPIC_SUFFIX, TOPIC_SL_WILD});
+        CHECK(br.clientStats(ADDR_PEER1).subscriptions == 2);
+        CHECK(br.clientStats(ADDR_PEER1).rejectedSubs == 1);
+        CHECK(br.clientStats(ADDR_PEER2).rejectedSubs == 0);
+    }
+
+    SECTION("Renew on activity") {
+        conf.subDB.renewOnActivity = true;
+        Nodes::Bridge br{&ll, &fl, conf};
+
+        sub(ADDR_PEER1, TOPIC);
+        sub(ADDR_PEER2, TOPIC_SUFFIX);
+
+        std::this_thread::sleep_for(CONF.subDB.subLifetime / 2);
+
+        auto msg = MSG_SUB1;
+        msg.type = LocalMessageType::PUB;
+        for (size_t i = 0; i < 100; i++) {
+            ll.receiveDirect(msg);
+            sub(ADDR_PEER1, TOPIC);
+        }
+
+        // Renewals don't schedule more expirations
+        CHECK(br.getSubDBStats().expiries == 2);
+
+        std::this_thread::sleep_for(CONF.subDB.subLifetime / 2
+                                    + 2*CONF.subDB.interval);
+
+        // Only active client is left
+        CHECK(fl.getSubs() == SubsSetT{TOPIC});
+        CHECK(br.clientStats(ADDR_PEER1).subscriptions == 1);
+        CHECK(br.clientStats(ADDR_PEER2).subscriptions == 0);
+    }
+
+    SECTION("Drop on probe") {
+        conf.subDB.dropOnProbe = true;
+        Nodes::Bridge br{&ll, &fl, conf};
+
+        sub(ADDR_PEER1, TOPIC);
+
+        auto msg = MSG_SUB1;
+        msg.type = LocalMessageType::PROBE_REQ;
+        ll.receiveDirect(msg);
+
+        CHECK(fl.getSubs() == SubsSetT{});
+        CHECK(br.clientStats(ADDR_PEER1).subscriptions == 0);
+    }
+}
+
 TEST_CASE("Receive from far layer with expiration", "[Bridge]") {
     LocalLayers::DummyLocalLayer ll{};
     FarLayers::DummyFarLayer fl{};
@@ -400,8 +796,8 @@ TEST_CASE("Receive from far layer with expiration", "[Bridge]") {
         // Simulate data from far layer
         fl.receiveDirect(TOPIC, PAYLOAD);
 
-        // Leave some room for propagation from thread
-        std::this_thread::sleep_for(10ms);
+        // Delivered by dispatch executor
+        waitForDispatch(br, 1);
 
         CHECK(localSub1Passed);
         CHECK(!localSub2Passed);
@@ -412,8 +808,8 @@ TEST_CASE("Receive from far layer with expiration", "[Bridge]") {
         // Simulate data from far layer
         fl.receiveDirect(TOPIC_SUFFIX, PAYLOAD);
 
-        // Leave some room for propagation from thread
-        std::this_thread::sleep_for(10ms);
+        // Delivered by dispatch executor
+        waitForDispatch(br, 1);
 
         CHECK(!localSub1Passed);
         CHECK(localSub2Passed);
@@ -444,3 +840,230 @@ TEST_CASE("Receive from far layer with expiration", "[Bridge]") {
     // Only this-node subscriptions should be left
     CHECK(fl.getSubs() == SubsSetT{TOPIC, TOPIC_ML_WILD});
 }
+
+TEST_CASE("Receive from far layer after new topics", "[Bridge]") {
+    LocalLayers::DummyLocalLayer ll{};
+    FarLayers::DummyFarLayer fl{};
+
+    // No ticks
+    auto conf = CONF;
+    conf.subDB.shards = 1;
+    conf.subDB.interval = 1h;
+    Nodes::Bridge br{&ll, &fl, conf};
+
+    constexpr size_t TOPICS = 8;
+
+    std::atomic<size_t> received = 0;
+    auto cb = [&received](const std::string& topic, const std::string& payload) {
+        received++;
+    };
+
+    auto rebuilds = br.getSubDBStats().snapshotRebuilds;
+
+    // Writers rebuild snapshot of new topics before returning
+    for (size_t i = 0; i < TOPICS; i++) {
+        REQUIRE(br.subscribe(TOPIC + "/" + std::to_string(i), cb));
+    }
+    CHECK(br.getSubDBStats().snapshotRebuilds == rebuilds + TOPICS);
+    CHECK(br.getSubDBStats().topics == TOPICS);
+
+    // Renewal doesn't change set of topics
+    REQUIRE(br.subscribe(TOPIC + "/0", cb));
+    CHECK(br.getSubDBStats().snapshotRebuilds == rebuilds + TOPICS);
+
+    // Matching never rebuilds
+    for (size_t i = 0; i < TOPICS; i++) {
+        REQUIRE(br.receiveFar(TOPIC + "/" + std::to_string(i), PAYLOAD));
+    }
+    CHECK(br.getSubDBStats().snapshotRebuilds == rebuilds + TOPICS);
+
+    // Delivered by dispatch executor
+    waitForDispatch(br, TOPICS);
+    CHECK(received == TOPICS);
+}
+
+TEST_CASE("Receive from far layer during subscription changes", "[Bridge]") {
+    LocalLayers::DummyLocalLayer ll{};
+    FarLayers::DummyFarLayer fl{};
+    Nodes::Bridge br{&ll, &fl, CONF};
+
+    constexpr size_t READERS = 4;
+    constexpr size_t MSGS_PER_READER = 200;
+
+    std::atomic<size_t> received = 0;
+    REQUIRE(br.subscribe(TOPIC, [&received](const std::string& topic,
+                                            const std::string& payload) {
+        received++;
+    }));
+
+    std::vector<std::thread> readers;
+    for (size_t i = 0; i < READERS; i++) {
+        readers.emplace_back([&br] {
+            for (size_t j = 0; j < MSGS_PER_READER; j++) {
+                br.receiveFar(TOPIC, PAYLOAD);
+            }
+        });
+    }
+
+    // Meanwhile change other (non-matching) subscriptions
+    for (size_t i = 0; i < 100; i++) {
+        std::string topic = TOPIC_SUFFIX + "/" + std::to_string(i);
+        REQUIRE(br.subscribe(topic, nullptr));
+        if (i % 2) REQUIRE(br.unsubscribe(topic));
+    }
+
+    for (auto& t : readers) t.join();
+
+    // Delivered by dispatch executor
+    waitForDispatch(br, READERS * MSGS_PER_READER);
+    CHECK(received == READERS * MSGS_PER_READER);
+}
+
+TEST_CASE("Dispatch fan-out", "[Bridge]") {
+    constexpr size_t CLIENTS = 200;
+    constexpr size_t MSGS = 10;
+
+    LocalLayers::DummyLocalLayer ll{};
+    FarLayers::DummyFarLayer fl{};
+
+    // Single worker (dummy local layer isn't thread-safe)
+    auto conf = CONF;
+    conf.dispatch.workers = 1;
+    Nodes::Bridge br{&ll, &fl, conf};
+
+    auto msg = MSG_SUB1;
+    for (size_t i = 0; i < CLIENTS; i++) {
+        msg.addr.addr = { 1, 0, static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i) };
+        msg.addr.str = "1" + std::to_string(i);
+        ll.receiveDirect(msg);
+    }
+
+    std::atomic<size_t> received = 0;
+    REQUIRE(br.subscribe(TOPIC, [&received](const std::string& topic,
+                                            const std::string& payload) {
+        received++;
+    }));
+
+    for (size_t i = 0; i < MSGS; i++) {
+        REQUIRE(br.receiveFar(TOPIC, PAYLOAD));
+    }
+
+    waitForDispatch(br, MSGS);
+
+    auto stats = br.getDispatchStats();
+
+    // One task per message
+    CHECK(received == MSGS);
+    CHECK(ll.getSentMsgsCount() == CLIENTS * MSGS);
+    CHECK(stats.queue.processed == MSGS);
+    CHECK(stats.queue.queueDepth == 0);
+    CHECK(stats.queue.queueDepthMax <= conf.dispatch.queueSize);
+    CHECK(stats.deliveries == (CLIENTS + 1) * MSGS);
+    CHECK(stats.latencyMax >= stats.latencyAvg);
+
+    // Not matching topic isn't dispatched
+    REQUIRE(br.receiveFar(TOPIC + "x", PAYLOAD));
+    std::this_thread::sleep_for(10ms);
+    CHECK(br.getDispatchStats().queue.processed == MSGS);
+}
+
+TEST_CASE("Dispatch with injected executor", "[Bridge]") {
+    LocalLayers::DummyLocalLayer ll{};
+    FarLayers::DummyFarLayer fl{};
+
+    InlineExecutor executor;
+    Nodes::Bridge br{&ll, &fl, CONF, &executor};
+
+    ll.receiveDirect(MSG_SUB1);
+
+    size_t received = 0;
+    REQUIRE(br.subscribe(TOPIC, [&received](const std::string& topic,
+                                            const std::string& payload) {
+        received++;
+    }));
+
+    // Delivered before return
+    REQUIRE(br.receiveFar(TOPIC, PAYLOAD));
+    CHECK(received == 1);
+    CHECK(ll.getSentMsgsCount() == 1);
+
+    auto stats = br.getDispatchStats();
+    CHECK(stats.queue.processed == 1);
+    CHECK(stats.deliveries == 2);
+}
+
+TEST_CASE("Receive from far layer with wildcard first level", "[Bridge]") {
+    LocalLayers::DummyLocalLayer ll{};
+    FarLayers::DummyFarLayer fl{};
+
+    for (size_t shards : {1, 16}) {
+        auto conf = CONF;
+        conf.subDB.shards = shards;
+        Nodes::Bridge br{&ll, &fl, conf};
+
+        std::atomic<size_t> received = 0;
+        auto cb = [&received](const std::string& topic,
+                              const std::string& payload) {
+            received++;
+        };
+
+        REQUIRE(br.subscribe("#", cb));
+        REQUIRE(br.subscribe("+/def", cb));
+        REQUIRE(br.subscribe(TOPIC_ML_WILD, cb));
+        REQUIRE(br.subscribe("xyz/def", cb));
+
+        br.receiveFar(TOPIC_SUFFIX, PAYLOAD);
+
+        // Delivered by dispatch executor (single task)
+        waitForDispatch(br, 1);
+        CHECK(received == 3);
+
+        REQUIRE(br.unsubscribe("#"));
+        REQUIRE(br.unsubscribe("+/def"));
+        REQUIRE(br.unsubscribe(TOPIC_ML_WILD));
+        REQUIRE(br.unsubscribe("xyz/def"));
+        CHECK(fl.getSubs() == SubsSetT{});
+    }
+}
+
+TEST_CASE("Subscription changes scaling", "[.][benchmark][Bridge]") {
+    constexpr size_t OPS_PER_THREAD = 20000;
+
+    LocalLayers::DummyLocalLayer ll{};
+    FarLayers::DummyFarLayer fl{};
+
+    for (size_t shards : {1, 16}) {
+        auto conf = CONF;
+        conf.subDB.shards = shards;
+        conf.subDB.interval = 1h;
+
+        for (size_t threadsCount : {1, 2, 4, 8, 16}) {
+            Nodes::Bridge br{&ll, &fl, conf};
+
+            auto start = std::chrono::steady_clock::now();
+
+            // Each thread changes subscriptions of its own topic family
+            std::vector<std::thread> threads;
+            for (size_t t = 0; t < threadsCount; t++) {
+                threads.emplace_back([&ll, t] {
+                    auto msg = MSG_SUB1;
+                    for (size_t i = 0; i < OPS_PER_THREAD; i++) {
+                        msg.type = (i % 2) ? LocalMessageType::UNSUB
+                                           : LocalMessageType::SUB_REQ;
+                        msg.topic = "family" + std::to_string(t) + "/"
+                                    + std::to_string(i / 2 % 64);
+                        ll.receiveDirect(msg);
+                    }
+                });
+            }
+            for (auto& t : threads) t.join();
+
+            double opsPerSec = threadsCount * OPS_PER_THREAD
+                / std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - start).count();
+
+            WARN(shards << " shards, " << threadsCount << " threads: "
+                 << opsPerSec << " ops/s");
+        }
+    }
+}
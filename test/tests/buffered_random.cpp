@@ -0,0 +1,106 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <string>
+#include <sys/random.h>
+#include <thread>
+#include <vector>
+
+#include "spsp/buffered_random.hpp"
+
+using namespace SPSP;
+
+static std::string generate(const IRandom& rand, size_t len)
+{
+    std::string buf(len, '\0');
+    rand.bytes(buf.data(), buf.length());
+    return buf;
+}
+
+TEST_CASE("Generate unique outputs", "[BufferedRandom]") {
+    BufferedRandom rand;
+    std::set<std::string> outputs;
+
+    // Lengths crossing internal chunks and reseeding
+    size_t total = 0;
+    for (size_t i = 0; total < 2 * BufferedRandom::RESEED_INTERVAL; i++) {
+        size_t len = 8 + (i * 37) % 700;
+        auto out = generate(rand, len);
+        CHECK(out != std::string(len, '\0'));
+
+        if (len == 8) {
+            CHECK(outputs.insert(out).second);
+        }
+        total += len;
+    }
+
+    CHECK(generate(rand, 0).empty());
+}
+
+TEST_CASE("Per-thread state", "[BufferedRandom]") {
+    BufferedRandom rand;
+    std::mutex mutex;
+    std::set<std::string> outputs;
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < 8; t++) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 1000; i++) {
+                auto out = generate(rand, 8);
+
+                const std::scoped_lock lock(mutex);
+                CHECK(outputs.insert(out).second);
+            }
+        });
+    }
+
+    for (auto& t : threads) t.join();
+
+    CHECK(outputs.size() == 8000);
+}
+
+TEST_CASE("Nonce generation throughput", "[.][benchmark][BufferedRandom]") {
+    // Direct syscall, as platform generator on Linux does
+    class SyscallRandom : public IRandom
+    {
+    public:
+        void bytes(void* buf, size_t len) const
+        {
+            if (getrandom(buf, len, 0) != static_cast<ssize_t>(len)) {
+                throw RandomGeneratorError("Generation failed");
+            }
+        }
+    };
+
+    constexpr size_t THREADS = 8;
+    constexpr size_t NONCES_PER_THREAD = 100000;
+
+    auto measure = [](const IRandom& rand) {
+        auto start = std::chrono::steady_clock::now();
+
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < THREADS; t++) {
+            threads.emplace_back([&rand] {
+                uint8_t nonce[8];
+                for (size_t i = 0; i < NONCES_PER_THREAD; i++) {
+                    rand.bytes(nonce, sizeof(nonce));
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+
+        auto duration = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double, std::nano>(duration).count()
+               / (THREADS * NONCES_PER_THREAD);
+    };
+
+    double syscallNs = measure(SyscallRandom{});
+    double bufferedNs = measure(BufferedRandom{});
+
+    WARN("getrandom(): " << syscallNs << " ns/nonce, BufferedRandom: "
+         << bufferedNs << " ns/nonce (" << THREADS << " threads)");
+    CHECK(bufferedNs < syscallNs);
+}
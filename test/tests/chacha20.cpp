@@ -0,0 +1,207 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+#include <vector>
+
+#include "spsp/chacha20.hpp"
+#include "spsp/chacha20_simd.hpp"
+
+using namespace SPSP;
+
+const std::vector<ChaCha20::Impl> IMPLS = {
+    ChaCha20::Impl::SCALAR,
+    ChaCha20::Impl::SSE2,
+    ChaCha20::Impl::AVX2,
+    ChaCha20::Impl::NEON,
+};
+
+static std::vector<uint8_t> fromHex(const std::string& hex)
+{
+    std::vector<uint8_t> bytes;
+    for (size_t i = 0; i + 1 < hex.length(); i += 2) {
+        bytes.push_back(std::stoul(hex.substr(i, 2), nullptr, 16));
+    }
+    return bytes;
+}
+
+static uint8_t checksum(const std::vector<uint8_t>& data)
+{
+    uint8_t sum = 0;
+    for (auto b : data) sum += b;
+    return sum;
+}
+
+TEST_CASE("Known answers", "[ChaCha20]") {
+    struct Vector
+    {
+        std::string key;
+        std::string nonce;
+        std::string keystream;
+    };
+
+    // Test vectors for original ChaCha20 (64-bit nonce), 20 rounds
+    const std::vector<Vector> vectors = {
+        {
+            std::string(64, '0'),
+            std::string(16, '0'),
+            "76b8e0ada0f13d90405d6ae55386bd28bdd219b8a08ded1aa836efcc8b770dc7"
+            "da41597c5157488d7724e03fb8d84a376a43b8f41518a11cc387b669b2ee6586"
+            "9f07e7be5551387a98ba977c732d080dcb0f29a048e3656912c6533e32ee7aed"
+            "29b721769ce64e43d57133b074d839d531ed1f28510afb45ace10a1f4b794d6f"
+        },
+        {
+            std::string(62, '0') + "01",
+            std::string(16, '0'),
+            "4540f05a9f1fb296d7736e7b208e3c96eb4fe1834688d2604f450952ed432d41"
+            "bbe2a0b6ea7566d2a5d1e7e20d42af2c53d792b1c43fea817e9ad275ae546963"
+        },
+        {
+            std::string(64, '0'),
+            std::string(14, '0') + "01",
+            "de9cba7bf3d69ef5e786dc63973f653a0b49e015adbff7134fcb7df137821031"
+            "e85a050278a7084527214f73efc7fa5b5277062eb7a0433e445f41e3"
+        },
+    };
+
+    const auto origImpl = ChaCha20::getImpl();
+
+    for (auto impl : IMPLS) {
+        if (!ChaCha20::setImpl(impl)) continue;
+
+        INFO("Implementation: " << ChaCha20::implToStr(impl));
+
+        for (auto& v : vectors) {
+            auto key = fromHex(v.key);
+            auto nonce = fromHex(v.nonce);
+            auto expected = fromHex(v.keystream);
+
+            // Keystream is ciphertext of zeros
+            std::vector<uint8_t> data(expected.size(), 0);
+            ChaCha20::State state{key.data(), nonce.data()};
+            CHECK(ChaCha20::cryptChecksum(state, data.data(), data.size(),
+                                          ChaCha20::Direction::ENCRYPT) == 0);
+            CHECK(data == expected);
+
+            // Decryption gives back zeros
+            CHECK(ChaCha20::cryptChecksum(state, data.data(), data.size(),
+                                          ChaCha20::Direction::DECRYPT) == 0);
+            CHECK(data == std::vector<uint8_t>(expected.size(), 0));
+        }
+    }
+
+    ChaCha20::setImpl(origImpl);
+}
+
+TEST_CASE("Same as reference implementation", "[ChaCha20]") {
+    std::vector<uint8_t> key(ChaCha20::KEY_LEN), nonce(ChaCha20::NONCE_LEN);
+    for (size_t i = 0; i < key.size(); i++) key[i] = i * 7 + 1;
+    for (size_t i = 0; i < nonce.size(); i++) nonce[i] = i * 13 + 5;
+
+    const auto origImpl = ChaCha20::getImpl();
+
+    for (auto impl : IMPLS) {
+        if (!ChaCha20::setImpl(impl)) continue;
+
+        INFO("Implementation: " << ChaCha20::implToStr(impl));
+
+        // Cover all tail lengths and more than one batch of blocks,
+        // including counter crossing 32-bit boundary
+        for (uint64_t counter : {uint64_t{0}, uint64_t{0xfffffffe}}) {
+            for (size_t len = 0; len <= 600; len++) {
+                INFO("Counter: " << counter << ", length: " << len);
+
+                std::vector<uint8_t> plain(len);
+                for (size_t i = 0; i < len; i++) plain[i] = i * 31 + len;
+
+                std::vector<uint8_t> expected = plain;
+                ::Chacha20 ref{key.data(), nonce.data(), counter};
+                ref.crypt(expected.data(), expected.size());
+
+                std::vector<uint8_t> data = plain;
+                ChaCha20::State state{key.data(), nonce.data(), counter};
+                auto sumEnc = ChaCha20::cryptChecksum(state, data.data(),
+                                                      data.size(),
+                                                      ChaCha20::Direction::ENCRYPT);
+                REQUIRE(data == expected);
+                REQUIRE(sumEnc == checksum(plain));
+
+                auto sumDec = ChaCha20::cryptChecksum(state, data.data(),
+                                                      data.size(),
+                                                      ChaCha20::Direction::DECRYPT);
+                REQUIRE(data == plain);
+                REQUIRE(sumDec == checksum(plain));
+            }
+        }
+    }
+
+    ChaCha20::setImpl(origImpl);
+}
+
+TEST_CASE("Implementation selection", "[ChaCha20]") {
+    CHECK(ChaCha20::implAvailable(ChaCha20::Impl::SCALAR));
+    CHECK(ChaCha20::implAvailable(ChaCha20::getImpl()));
+
+    const auto origImpl = ChaCha20::getImpl();
+
+    REQUIRE(ChaCha20::setImpl(ChaCha20::Impl::SCALAR));
+    CHECK(ChaCha20::getImpl() == ChaCha20::Impl::SCALAR);
+
+    for (auto impl : IMPLS) {
+        if (!ChaCha20::implAvailable(impl)) {
+            CHECK(!ChaCha20::setImpl(impl));
+            CHECK(ChaCha20::getImpl() == ChaCha20::Impl::SCALAR);
+        }
+    }
+
+    ChaCha20::setImpl(origImpl);
+}
+
+TEST_CASE("Batch same as single buffers", "[ChaCha20]") {
+    std::vector<uint8_t> key(ChaCha20::KEY_LEN);
+    for (size_t i = 0; i < key.size(); i++) key[i] = i * 3 + 11;
+
+    // Different nonces, lengths and directions, count not multiple of lanes
+    const size_t count = 37;
+    std::vector<std::vector<uint8_t>> nonces, plains;
+    for (size_t i = 0; i < count; i++) {
+        nonces.emplace_back(ChaCha20::NONCE_LEN, static_cast<uint8_t>(i));
+        std::vector<uint8_t> plain((i * 53) % 300);
+        for (size_t j = 0; j < plain.size(); j++) plain[j] = i + j * 7;
+        plains.push_back(plain);
+    }
+
+    const auto origImpl = ChaCha20::getImpl();
+
+    for (auto impl : IMPLS) {
+        if (!ChaCha20::setImpl(impl)) continue;
+
+        INFO("Implementation: " << ChaCha20::implToStr(impl));
+
+        std::vector<std::vector<uint8_t>> data = plains;
+        std::vector<ChaCha20::BatchItem> items;
+        for (size_t i = 0; i < count; i++) {
+            items.push_back(ChaCha20::BatchItem{
+                .state = ChaCha20::State{key.data(), nonces[i].data(), i},
+                .data = data[i].data(),
+                .dataLen = data[i].size(),
+                .dir = i % 2 ? ChaCha20::Direction::DECRYPT
+                             : ChaCha20::Direction::ENCRYPT,
+            });
+        }
+
+        ChaCha20::cryptChecksumBatch(items.data(), items.size());
+
+        for (size_t i = 0; i < count; i++) {
+            INFO("Buffer: " << i);
+
+            std::vector<uint8_t> expected = plains[i];
+            ::Chacha20 ref{key.data(), nonces[i].data(), i};
+            ref.crypt(expected.data(), expected.size());
+
+            CHECK(data[i] == expected);
+            CHECK(items[i].checksum == checksum(i % 2 ? expected : plains[i]));
+        }
+    }
+
+    ChaCha20::setImpl(origImpl);
+}
@@ -1,8 +1,12 @@
 #include <catch2/catch_test_macros.hpp>
 
+#include <atomic>
 #include <chrono>
+#include <future>
+#include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "spsp/espnow.hpp"
 #include "spsp/espnow_adapter.hpp"
@@ -46,7 +50,7 @@ const LocalMessageT MSG_BASE_PROBE_RES2 = {
 
 class AdapterSendSuccess : public LocalLayers::ESPNOW::Adapter
 {
-    void send(const LocalAddrT& dst, const std::string& data)
+    void send(const LocalAddrT& dst, LocalLayers::ESPNOW::TxFrame& frame)
     {
         std::thread t(this->getSendCb(), dst, true);
         t.detach();
@@ -55,9 +59,9 @@ class AdapterSendSuccess : public LocalLayers::ESPNOW::Adapter
 
 class AdapterSendSuccessWait : public LocalLayers::ESPNOW::Adapter
 {
-    void send(const LocalAddrT& dst, const std::string& data)
+    void send(const LocalAddrT& dst, LocalLayers::ESPNOW::TxFrame& frame)
     {
-        std::thread t([this, &dst]() {
+        std::thread t([this, dst]() {
             std::this_thread::sleep_for(10ms);
             this->getSendCb()(dst, true);
         });
@@ -67,13 +71,21 @@ class AdapterSendSuccessWait : public LocalLayers::ESPNOW::Adapter
 
 class AdapterSendFail : public LocalLayers::ESPNOW::Adapter
 {
-    void send(const LocalAddrT& dst, const std::string& data)
+    void send(const LocalAddrT& dst, LocalLayers::ESPNOW::TxFrame& frame)
     {
         std::thread t(this->getSendCb(), dst, false);
         t.detach();
     }
 };
 
+class AdapterSendThrow : public LocalLayers::ESPNOW::Adapter
+{
+    void send(const LocalAddrT& dst, LocalLayers::ESPNOW::TxFrame& frame)
+    {
+        throw LocalLayers::ESPNOW::AdapterError("Sending failed");
+    }
+};
+
 // ESPNOW with support for direct receive of message
 class ESPNOWRcvDir : public LocalLayers::ESPNOW::ESPNOW
 {
@@ -133,12 +145,181 @@ TEST_CASE("Send multiple messages to same address", "[ESPNOW]") {
     t3.join();
 }
 
+TEST_CASE("Send asynchronously", "[ESPNOW]") {
+    WiFi::Dummy wifi{};
+    AdapterSendSuccessWait adapter{};
+    LocalLayers::ESPNOW::ESPNOW espnow{adapter, wifi, CONF};
+
+    constexpr int MSG_COUNT = 6;
+    std::mutex mutex;
+    std::vector<int> completed;
+    std::promise<void> allCompleted;
+
+    // Alternate between two peers
+    for (int i = 0; i < MSG_COUNT; i++) {
+        auto msg = MSG_BASE;
+        msg.addr = i % 2 ? ADDR_PEER2 : ADDR_PEER;
+
+        REQUIRE(espnow.sendAsync(msg, [&, i](bool delivered) {
+            CHECK(delivered);
+
+            const std::scoped_lock lock(mutex);
+            completed.push_back(i);
+            if (completed.size() == MSG_COUNT) allCompleted.set_value();
+        }));
+    }
+
+    REQUIRE(allCompleted.get_future().wait_for(1s) == std::future_status::ready);
+
+    // Messages to the same peer are completed in order
+    std::vector<int> peer1, peer2;
+    for (auto i : completed) {
+        (i % 2 ? peer2 : peer1).push_back(i);
+    }
+
+    CHECK(peer1 == std::vector<int>{0, 2, 4});
+    CHECK(peer2 == std::vector<int>{1, 3, 5});
+}
+
+TEST_CASE("Send to many peers with limited in-flight peers", "[ESPNOW]") {
+    // Confirms delivery later, tracks number of concurrent deliveries
+    class Adapter : public LocalLayers::ESPNOW::Adapter
+    {
+    public:
+        std::atomic<int> inFlight = 0;
+        std::atomic<int> inFlightMax = 0;
+
+        void send(const LocalAddrT& dst, LocalLayers::ESPNOW::TxFrame& frame)
+        {
+            int cur = ++inFlight;
+            int prev = inFlightMax;
+            while (prev < cur && !inFlightMax.compare_exchange_weak(prev, cur)) {}
+
+            std::thread t([this, dst]() {
+                std::this_thread::sleep_for(5ms);
+                inFlight--;
+                this->getSendCb()(dst, true);
+            });
+            t.detach();
+        }
+    };
+
+    constexpr int PEER_COUNT = 8;
+
+    auto conf = CONF;
+    WiFi::Dummy wifi{};
+    Adapter adapter{};
+
+    SECTION("Limited by config") {
+        conf.maxInFlightPeers = 2;
+    }
+
+    SECTION("Limited by adapter") {
+        adapter.setMaxPeerNum(2);
+    }
+
+    LocalLayers::ESPNOW::ESPNOW espnow{adapter, wifi, conf};
+
+    std::atomic<int> completed = 0;
+    std::promise<void> allCompleted;
+
+    for (int i = 0; i < PEER_COUNT; i++) {
+        uint8_t mac[6];
+        ADDR_PEER.toMAC(mac);
+        mac[5] = 0x10 + i;
+
+        auto msg = MSG_BASE;
+        msg.addr = mac;
+
+        REQUIRE(espnow.sendAsync(msg, [&](bool delivered) {
+            CHECK(delivered);
+            if (++completed == PEER_COUNT) allCompleted.set_value();
+        }));
+    }
+
+    REQUIRE(allCompleted.get_future().wait_for(1s) == std::future_status::ready);
+    CHECK(adapter.inFlightMax == 2);
+}
+
+TEST_CASE("Peer cache", "[ESPNOW]") {
+    WiFi::Dummy wifi{};
+    AdapterSendSuccess adapter{};
+    adapter.setMaxPeerNum(2);
+
+    {
+        LocalLayers::ESPNOW::ESPNOW espnow{adapter, wifi, CONF};
+
+        auto msg = MSG_BASE;
+        auto msg2 = MSG_BASE;
+        msg2.addr = ADDR_PEER2;
+        auto msg3 = MSG_BASE;
+        msg3.addr = LocalAddrT::broadcast();
+
+        // Peer stays registered
+        REQUIRE(espnow.send(msg));
+        REQUIRE(espnow.send(msg));
+        CHECK(adapter.getPeerNum() == 1);
+        CHECK(espnow.getPeerCacheStats().hits == 1);
+        CHECK(espnow.getPeerCacheStats().misses == 1);
+
+        // Fill the cache
+        REQUIRE(espnow.send(msg2));
+        CHECK(adapter.getPeerNum() == 2);
+        CHECK(espnow.getPeerCacheStats().evictions == 0);
+
+        // Evict the least recently used peer (`msg`)
+        REQUIRE(espnow.send(msg3));
+        CHECK(adapter.getPeerNum() == 2);
+        CHECK(espnow.getPeerCacheStats().evictions == 1);
+
+        REQUIRE(espnow.send(msg2));
+        CHECK(espnow.getPeerCacheStats().hits == 2);
+        REQUIRE(espnow.send(msg));
+        CHECK(espnow.getPeerCacheStats().misses == 4);
+        CHECK(espnow.getPeerCacheStats().evictions == 2);
+    }
+
+    // Peers are unregistered with destruction
+    CHECK(adapter.getPeerNum() == 0);
+}
+
+TEST_CASE("Send asynchronously invalid messages", "[ESPNOW]") {
+    WiFi::Dummy wifi{};
+    AdapterSendSuccess adapter{};
+    LocalLayers::ESPNOW::ESPNOW espnow{adapter, wifi, CONF};
+
+    auto msg = MSG_BASE;
+    bool called = false;
+
+    SECTION("Too long payload") {
+        msg.payload = std::string(250, '0');
+    }
+
+    SECTION("Empty address without bridge connected") {
+        msg.addr = LocalAddrT{};
+    }
+
+    CHECK(!espnow.sendAsync(msg, [&called](bool delivered) { called = true; }));
+    CHECK(!called);
+}
+
+TEST_CASE("Send adapter throws", "[ESPNOW]") {
+    WiFi::Dummy wifi{};
+    AdapterSendThrow adapter{};
+    LocalLayers::ESPNOW::ESPNOW espnow{adapter, wifi, CONF};
+
+    CHECK(!espnow.send(MSG_BASE));
+
+    // Next message isn't stuck behind the failed one
+    CHECK(!espnow.send(MSG_BASE));
+}
+
 TEST_CASE("Send and receive the same message", "[ESPNOW]") {
     class LocalNode : public Nodes::DummyLocalNode<LocalLayers::ESPNOW::ESPNOW>
     {
         using Nodes::DummyLocalNode<LocalLayers::ESPNOW::ESPNOW>::DummyLocalNode;
 
-        bool processPub(const LocalMessageT& req,
+        bool processPub(const LocalMessageViewT& req,
                         int rssi = NODE_RSSI_UNKNOWN)
         {
             // Check same message was received
@@ -149,14 +330,17 @@ TEST_CASE("Send and receive the same message", "[ESPNOW]") {
 
     class Adapter : public LocalLayers::ESPNOW::Adapter
     {
-        void send(const LocalAddrT& dst, const std::string& data)
+        void send(const LocalAddrT& dst, LocalLayers::ESPNOW::TxFrame& frame)
         {
             // Confirm delivery
             std::thread t1(this->getSendCb(), dst, true);
             t1.detach();
 
             // Receive same data
-            std::thread t2(this->getRecvCb(), dst, data, 0);
+            std::thread t2([this, dst, data = std::string(frame.view())]() mutable {
+                this->getRecvCb()(dst, reinterpret_cast<uint8_t*>(data.data()),
+                                  data.length(), 0);
+            });
             t2.join();
         }
     };
@@ -169,6 +353,111 @@ TEST_CASE("Send and receive the same message", "[ESPNOW]") {
     CHECK(espnow.send(MSG_BASE));
 }
 
+TEST_CASE("Receive in adapter's thread", "[ESPNOW]") {
+    class LocalNode : public Nodes::DummyLocalNode<LocalLayers::ESPNOW::ESPNOW>
+    {
+    public:
+        using Nodes::DummyLocalNode<LocalLayers::ESPNOW::ESPNOW>::DummyLocalNode;
+
+        std::thread::id m_receivedBy;
+
+        bool processPub(const LocalMessageViewT& req,
+                        int rssi = NODE_RSSI_UNKNOWN)
+        {
+            m_receivedBy = std::this_thread::get_id();
+            return true;
+        }
+    };
+
+    class Adapter : public LocalLayers::ESPNOW::Adapter
+    {
+    public:
+        std::string m_sent;
+
+        void send(const LocalAddrT& dst, LocalLayers::ESPNOW::TxFrame& frame)
+        {
+            m_sent = std::string(frame.view());
+            std::thread t(this->getSendCb(), dst, true);
+            t.detach();
+        }
+    };
+
+    WiFi::Dummy wifi{};
+    Adapter adapter{};
+    adapter.setRecvFromDriverContext(false);
+    LocalLayers::ESPNOW::ESPNOW espnow{adapter, wifi, CONF};
+    LocalNode node(&espnow);
+
+    REQUIRE(espnow.send(MSG_BASE));
+
+    // Delivered to node before callback returns, without executor
+    adapter.getRecvCb()(ADDR_PEER, reinterpret_cast<uint8_t*>(adapter.m_sent.data()),
+                        adapter.m_sent.length(), 0);
+    CHECK(node.m_receivedBy == std::this_thread::get_id());
+}
+
+TEST_CASE("Receive batch", "[ESPNOW]") {
+    class LocalNode : public Nodes::DummyLocalNode<LocalLayers::ESPNOW::ESPNOW>
+    {
+    public:
+        using Nodes::DummyLocalNode<LocalLayers::ESPNOW::ESPNOW>::DummyLocalNode;
+
+        std::vector<std::string> m_topics;
+
+        bool processPub(const LocalMessageViewT& req,
+                        int rssi = NODE_RSSI_UNKNOWN)
+        {
+            CHECK(req.addr == ADDR_PEER);
+            m_topics.push_back(std::string(req.topic));
+            return true;
+        }
+    };
+
+    class Adapter : public LocalLayers::ESPNOW::Adapter
+    {
+    public:
+        std::vector<std::string> m_sent;
+
+        void send(const LocalAddrT& dst, LocalLayers::ESPNOW::TxFrame& frame)
+        {
+            m_sent.push_back(std::string(frame.view()));
+            std::thread t(this->getSendCb(), dst, true);
+            t.detach();
+        }
+    };
+
+    WiFi::Dummy wifi{};
+    Adapter adapter{};
+    adapter.setRecvFromDriverContext(false);
+    LocalLayers::ESPNOW::ESPNOW espnow{adapter, wifi, CONF};
+    LocalNode node(&espnow);
+
+    // More packets than decrypted together, every fifth is corrupted
+    const size_t count = 20;
+    for (size_t i = 0; i < count; i++) {
+        auto msg = MSG_BASE;
+        msg.topic = TOPIC + std::to_string(i);
+        REQUIRE(espnow.send(msg));
+    }
+
+    std::vector<LocalLayers::ESPNOW::AdapterRecvItem> items;
+    for (size_t i = 0; i < count; i++) {
+        auto& data = adapter.m_sent[i];
+        if (i % 5 == 4) data.back()++;
+        items.push_back({ADDR_PEER, reinterpret_cast<uint8_t*>(data.data()),
+                         data.length(), 0});
+    }
+
+    REQUIRE(adapter.getRecvBatchCb() != nullptr);
+    adapter.getRecvBatchCb()(items.data(), items.size());
+
+    std::vector<std::string> expected;
+    for (size_t i = 0; i < count; i++) {
+        if (i % 5 != 4) expected.push_back(TOPIC + std::to_string(i));
+    }
+    CHECK(node.m_topics == expected);
+}
+
 TEST_CASE("Connect to bridge fail - no response", "[ESPNOW]") {
     WiFi::Dummy wifi{};
     AdapterSendSuccess adapter{};
@@ -1,6 +1,7 @@
 #include <catch2/catch_test_macros.hpp>
 
 #include "spsp/espnow_ser_des.hpp"
+#include "spsp/espnow_tx_frame.hpp"
 
 using namespace SPSP;
 
@@ -68,3 +69,136 @@ TEST_CASE("Serialize and deserialize", "[ESPNOW]") {
         REQUIRE(!serdes.deserialize(ADDR_PEER, serialized, deserialized));
     }
 }
+
+TEST_CASE("Serialize into TX frame", "[ESPNOW]") {
+    LocalLayers::ESPNOW::SerDes serdes(CONF);
+    LocalLayers::ESPNOW::TxFrame frame;
+
+    SECTION("Fits") {
+        frame.len = serdes.serialize(MSG_BASE, frame.packet(),
+                                     LocalLayers::ESPNOW::MAX_PACKET_LENGTH);
+        REQUIRE(frame.len == serdes.getPacketLength(MSG_BASE));
+
+        std::string serialized{frame.view()};
+        LocalMessageT deserialized;
+        REQUIRE(serdes.deserialize(ADDR_PEER, serialized, deserialized));
+        CHECK(deserialized == MSG_BASE);
+    }
+
+    SECTION("Buffer too small") {
+        CHECK(serdes.serialize(MSG_BASE, frame.packet(),
+                               serdes.getPacketLength(MSG_BASE) - 1) == 0);
+    }
+}
+
+TEST_CASE("Deserialize in-place to view", "[ESPNOW]") {
+    LocalLayers::ESPNOW::SerDes serdes(CONF);
+    LocalLayers::ESPNOW::TxFrame frame;
+
+    frame.len = serdes.serialize(MSG_BASE, frame.packet(),
+                                 LocalLayers::ESPNOW::MAX_PACKET_LENGTH);
+    REQUIRE(frame.len > 0);
+
+    LocalLayers::ESPNOW::LocalMessageViewT view{ADDR_PEER};
+
+    SECTION("Valid packet") {
+        REQUIRE(serdes.deserialize(frame.packet(), frame.len, view));
+        CHECK(view == MSG_BASE);
+        CHECK(view.toMessage() == MSG_BASE);
+
+        // View points into decrypted buffer
+        auto packet = reinterpret_cast<const char*>(frame.packet());
+        CHECK(view.topic.data() >= packet);
+        CHECK(view.payload.data() + view.payload.length() <= packet + frame.len);
+    }
+
+    SECTION("Truncated packet") {
+        REQUIRE(!serdes.deserialize(frame.packet(), frame.len - 1, view));
+    }
+}
+
+TEST_CASE("Deserialize batch", "[ESPNOW]") {
+    LocalLayers::ESPNOW::SerDes serdes(CONF);
+
+    // Every third packet is corrupted
+    const size_t count = 40;
+    std::vector<std::string> packets;
+    std::vector<LocalMessageT> msgs;
+    for (size_t i = 0; i < count; i++) {
+        LocalMessageT msg = MSG_BASE;
+        msg.topic += std::to_string(i);
+        msg.payload = std::string(i * 4, 'a' + i % 26);
+        msgs.push_back(msg);
+
+        std::string serialized;
+        serdes.serialize(msg, serialized);
+        if (i % 3 == 2) serialized.back()++;
+        packets.push_back(serialized);
+    }
+
+    std::vector<LocalLayers::ESPNOW::DeserializeBatchItem> items;
+    for (auto& packet : packets) {
+        items.push_back({
+            .data = reinterpret_cast<uint8_t*>(packet.data()),
+            .dataLen = packet.length(),
+            .msg = LocalLayers::ESPNOW::LocalMessageViewT{ADDR_PEER},
+        });
+    }
+    items.push_back({
+        .data = reinterpret_cast<uint8_t*>(packets[0].data()),
+        .dataLen = 3,
+        .msg = LocalLayers::ESPNOW::LocalMessageViewT{ADDR_PEER},
+    });
+
+    CHECK(serdes.deserializeBatch(items.data(), items.size()) == count - count / 3);
+
+    for (size_t i = 0; i < count; i++) {
+        INFO("Packet: " << i);
+
+        if (i % 3 == 2) {
+            CHECK(!items[i].valid);
+        } else {
+            REQUIRE(items[i].valid);
+            CHECK(items[i].msg == msgs[i]);
+        }
+    }
+    CHECK(!items.back().valid);
+}
+
+TEST_CASE("Multiple keys", "[ESPNOW]") {
+    auto confOther = CONF;
+    confOther.ssid = 0x0a0b0c0d;
+    confOther.password = std::string(32, 0x21);
+
+    LocalLayers::ESPNOW::SerDes serdes(CONF);
+    LocalLayers::ESPNOW::SerDes serdesOther(confOther);
+
+    std::string serialized;
+    serdesOther.serialize(MSG_BASE, serialized);
+
+    LocalMessageT deserialized;
+    REQUIRE(!serdes.deserialize(ADDR_PEER, serialized, deserialized));
+
+    SECTION("Correct key") {
+        REQUIRE(serdes.setKey(confOther.ssid, confOther.password));
+        REQUIRE(serdes.deserialize(ADDR_PEER, serialized, deserialized));
+        CHECK(deserialized == MSG_BASE);
+
+        // Own packets still use key from config
+        std::string own;
+        serdes.serialize(MSG_BASE, own);
+        CHECK(!serdesOther.deserialize(ADDR_PEER, own, deserialized));
+    }
+
+    SECTION("Wrong key") {
+        REQUIRE(serdes.setKey(confOther.ssid, CONF.password));
+        CHECK(!serdes.deserialize(ADDR_PEER, serialized, deserialized));
+    }
+
+    SECTION("Table full") {
+        size_t added = 0;
+        while (serdes.setKey(0x100 + added, CONF.password)) added++;
+        CHECK(added > 0);
+        CHECK(added < 100);
+    }
+}
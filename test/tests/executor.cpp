@@ -0,0 +1,152 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include "spsp/executor.hpp"
+
+using namespace SPSP;
+using namespace std::chrono_literals;
+
+TEST_CASE("Thread pool executor", "[Executor]") {
+    std::atomic<int> sum = 0;
+
+    {
+        ThreadPoolExecutor executor{{.workers = 4, .queueSize = 16}};
+        TaskGroup tasks;
+
+        for (int i = 1; i <= 100; i++) {
+            REQUIRE(tasks.execute(executor, [&sum, i] { sum += i; }));
+        }
+
+        tasks.wait();
+        CHECK(sum == 5050);
+
+        auto stats = executor.getStats();
+        CHECK(stats.executed == 100);
+        CHECK(stats.queue.queueDepth == 0);
+        CHECK(stats.latencyMax >= stats.latencyAvg);
+    }
+}
+
+TEST_CASE("Thread pool executor pinned to CPU", "[Executor]") {
+    ThreadPoolExecutor executor{{.workers = 2, .cpus = {0}}};
+    TaskGroup tasks;
+    std::atomic<int> count = 0;
+
+    for (int i = 0; i < 10; i++) {
+        tasks.execute(executor, [&count] { count++; });
+    }
+
+    tasks.wait();
+    CHECK(count == 10);
+}
+
+TEST_CASE("Thread pool executor nested tasks", "[Executor]") {
+    // Single worker with tiny queue, tasks submitting more tasks
+    ThreadPoolExecutor executor{{.workers = 1, .queueSize = 1}};
+    TaskGroup tasks;
+    std::atomic<int> count = 0;
+
+    for (int i = 0; i < 4; i++) {
+        tasks.execute(executor, [&] {
+            for (int j = 0; j < 4; j++) {
+                tasks.execute(executor, [&count] { count++; });
+            }
+            count++;
+        });
+    }
+
+    // Doesn't deadlock (worker runs task itself when its queue is full)
+    tasks.wait();
+    CHECK(count == 20);
+    CHECK(executor.getStats().executed == 20);
+}
+
+TEST_CASE("Thread pool executor dropping tasks", "[Executor]") {
+    ThreadPoolExecutor executor{{.workers = 1, .queueSize = 1,
+                                 .overflow = OverflowPolicy::DROP_NEWEST}};
+    TaskGroup tasks;
+
+    std::promise<void> started;
+    std::promise<void> releasePromise;
+    auto release = releasePromise.get_future().share();
+
+    REQUIRE(tasks.execute(executor, [&started, release] {
+        started.set_value();
+        release.wait();
+    }));
+    started.get_future().wait();
+
+    CHECK(tasks.execute(executor, [] {}));
+    CHECK(!tasks.execute(executor, [] {}));
+
+    releasePromise.set_value();
+
+    // Dropped task counts as finished
+    tasks.wait();
+    CHECK(executor.getStats().queue.droppedNewest == 1);
+    CHECK(executor.getStats().executed == 2);
+}
+
+TEST_CASE("Thread pool executor rejecting tasks without blocking", "[Executor]") {
+    // Blocking policy, but caller mustn't wait
+    ThreadPoolExecutor executor{{.workers = 1, .queueSize = 1}};
+    TaskGroup tasks;
+
+    std::promise<void> started;
+    std::promise<void> releasePromise;
+    auto release = releasePromise.get_future().share();
+
+    REQUIRE(tasks.tryExecute(executor, [&started, release] {
+        started.set_value();
+        release.wait();
+    }));
+    started.get_future().wait();
+
+    CHECK(tasks.tryExecute(executor, [] {}));
+    CHECK(!tasks.tryExecute(executor, [] {}));
+
+    releasePromise.set_value();
+
+    // Rejected task counts as finished
+    tasks.wait();
+    CHECK(executor.getStats().executed == 2);
+}
+
+TEST_CASE("Inline executor", "[Executor]") {
+    InlineExecutor executor;
+    TaskGroup tasks;
+    std::vector<int> order;
+
+    for (int i = 0; i < 3; i++) {
+        REQUIRE(tasks.execute(executor, [&order, i] { order.push_back(i); }));
+
+        // Already done
+        CHECK(order.size() == static_cast<size_t>(i + 1));
+    }
+
+    tasks.wait();
+    CHECK(order == std::vector<int>{0, 1, 2});
+    CHECK(executor.getStats().executed == 3);
+}
+
+TEST_CASE("Task group waits in destructor", "[Executor]") {
+    ThreadPoolExecutor executor{{.workers = 2}};
+    std::atomic<int> count = 0;
+
+    {
+        TaskGroup tasks;
+        for (int i = 0; i < 4; i++) {
+            tasks.execute(executor, [&count] {
+                std::this_thread::sleep_for(5ms);
+                count++;
+            });
+        }
+    }
+
+    CHECK(count == 4);
+}
@@ -0,0 +1,196 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "spsp/flat_wildcard_trie.hpp"
+#include "spsp/frozen_wildcard_trie.hpp"
+#include "spsp/wildcard_trie.hpp"
+
+using namespace SPSP;
+
+using FindReturnT = SPSP::FrozenWildcardTrie<int>::FindReturnT;
+using ItemsT = SPSP::FrozenWildcardTrie<int>::ItemsT;
+
+TEST_CASE("Empty frozen wildcard trie", "[FrozenWildcardTrie]") {
+    FrozenWildcardTrie<int> trie;
+
+    REQUIRE(trie.empty());
+    REQUIRE(trie.size() == 0);
+    REQUIRE(trie.find("abc/def").empty());
+    REQUIRE(trie.find("").empty());
+    REQUIRE(!trie.matchesAny("abc"));
+}
+
+TEST_CASE("Find in frozen wildcard trie", "[FrozenWildcardTrie]") {
+    FrozenWildcardTrie<int> trie{ItemsT{
+        {"abc/#", 2},
+        {"abc/def", 3},
+        {"abc/def/g", 4},
+        {"abc/def/+/h", 5},
+        {"other/#", 6},
+        {"if/+/else", 7},
+        {"+", 8},
+        {"abc/def", 9},
+        {"abc/d+f", 10},
+    }};
+
+    REQUIRE(!trie.empty());
+    REQUIRE(trie.size() == 8);
+
+    SECTION("Find non-existing") {
+        REQUIRE(trie.find("abc") == FindReturnT{{"+", 8}});
+        REQUIRE(trie.find("something/123").empty());
+        REQUIRE(trie.find("if/abc/else/aaa").empty());
+    }
+
+    SECTION("Find simple (last value of duplicate key)") {
+        REQUIRE(trie.find("abc/def") == FindReturnT{{"abc/#", 2}, {"abc/def", 9}});
+        REQUIRE(trie.find("abc/def/g").size() == 2);
+        REQUIRE(trie.find("abc/d+f") == FindReturnT{{"abc/#", 2}, {"abc/d+f", 10}});
+    }
+
+    SECTION("Find wildcards") {
+        REQUIRE(trie.find("if/elseif/else") == FindReturnT{{"if/+/else", 7}});
+        REQUIRE(trie.find("other/123") == FindReturnT{{"other/#", 6}});
+        REQUIRE(trie.find("abc/def/xyz/h").size() == 2);
+        REQUIRE(trie.find("") == FindReturnT{{"+", 8}});
+    }
+
+    SECTION("Any and count") {
+        REQUIRE(trie.matchesAny("other/1/2/3"));
+        REQUIRE(!trie.matchesAny("if/1"));
+        REQUIRE(trie.countMatches("abc/def/g") == 2);
+    }
+}
+
+TEST_CASE("Frozen wildcard trie same as wildcard trie", "[FrozenWildcardTrie]") {
+    const std::vector<std::string> levels = {
+        "a", "b", "c", "d", "e", "f", "g", "h", "+", "#", "",
+    };
+
+    std::mt19937 gen(4321);
+    auto randomKey = [&levels, &gen]() {
+        std::string key;
+        size_t depth = 1 + gen() % 4;
+        for (size_t i = 0; i < depth; i++) {
+            if (i > 0) key += "/";
+            key += levels[gen() % levels.size()];
+        }
+        return key;
+    };
+
+    WildcardTrie<int> ref;
+    ItemsT items;
+
+    for (int round = 0; round < 20; round++) {
+        for (int i = 0; i < 50; i++) {
+            auto key = randomKey();
+            ref.insert(key, round * 100 + i);
+            items.push_back({ key, round * 100 + i });
+        }
+
+        // Rebuilt after each change
+        FrozenWildcardTrie<int> trie{items};
+
+        for (int i = 0; i < 200; i++) {
+            auto topic = randomKey();
+            INFO("Round: " << round << ", topic: '" << topic << "'");
+
+            REQUIRE(trie.find(topic) == ref.find(topic));
+            REQUIRE(trie.matchesAny(topic) == ref.matchesAny(topic));
+        }
+    }
+}
+
+TEST_CASE("Matching throughput", "[.][benchmark][FrozenWildcardTrie]") {
+    constexpr size_t TOPICS = 100000;
+
+    std::mt19937 gen(1);
+
+    auto mac = [&gen]() {
+        char buf[13];
+        snprintf(buf, sizeof(buf), "%012llx",
+                 static_cast<unsigned long long>(gen()) * 7919 % 0xffffffffffffULL);
+        return std::string(buf);
+    };
+
+    const std::vector<std::string> sensors = {
+        "temp", "hum", "press", "co2", "light", "batt", "rssi", "state",
+    };
+
+    for (size_t filtersCount : {1000, 10000, 100000}) {
+        // Mostly exact filters of distinct clients, some with wildcards
+        std::vector<std::string> macs;
+        ItemsT items;
+        for (size_t i = 0; i < filtersCount; i++) {
+            if (i % 4 == 0) macs.push_back(mac());
+            auto& m = macs.back();
+            auto& sensor = sensors[gen() % sensors.size()];
+
+            switch (gen() % 10) {
+            case 0:
+                items.push_back({ "spsp/" + m + "/+", i });
+                break;
+            case 1:
+                items.push_back({ "spsp/+/" + sensor, i });
+                break;
+            case 2:
+                items.push_back({ "spsp/" + m + "/#", i });
+                break;
+            default:
+                items.push_back({ "spsp/" + m + "/" + sensor, i });
+                break;
+            }
+        }
+
+        WildcardTrie<int> trie;
+        FlatWildcardTrie<int> flat;
+        for (auto& [key, value] : items) {
+            trie.insert(key, value);
+            flat.insert(key, value);
+        }
+        FrozenWildcardTrie<int> frozen{items};
+
+        std::vector<std::string> topics;
+        for (size_t i = 0; i < TOPICS; i++) {
+            topics.push_back("spsp/" + macs[gen() % macs.size()] + "/"
+                             + sensors[gen() % sensors.size()]);
+        }
+
+        auto measure = [&topics](auto& t) {
+            size_t matches = 0;
+            auto start = std::chrono::steady_clock::now();
+
+            for (auto& topic : topics) {
+                t.findEach(topic, [&matches](const auto&) { matches++; });
+            }
+
+            auto duration = std::chrono::steady_clock::now() - start;
+            return std::make_pair(
+                std::chrono::duration<double, std::nano>(duration).count() / topics.size(),
+                matches);
+        };
+
+        auto [trieNs, trieMatches] = measure(trie);
+        auto [flatNs, flatMatches] = measure(flat);
+        auto [frozenNs, frozenMatches] = measure(frozen);
+
+        auto buildStart = std::chrono::steady_clock::now();
+        FrozenWildcardTrie<int> rebuilt{items};
+        double buildMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - buildStart).count();
+
+        WARN(filtersCount << " filters: WildcardTrie " << trieNs
+             << " ns/topic, FlatWildcardTrie " << flatNs
+             << " ns/topic, FrozenWildcardTrie " << frozenNs
+             << " ns/topic (build " << buildMs << " ms)");
+        CHECK(trieMatches == frozenMatches);
+        CHECK(flatMatches == frozenMatches);
+        CHECK(rebuilt.size() == frozen.size());
+    }
+}
@@ -1,9 +1,12 @@
 #include <catch2/catch_test_macros.hpp>
 
 #include <chrono>
+#include <optional>
 #include <string>
 #include <thread>
+#include <vector>
 
+#include "spsp/executor.hpp"
 #include "spsp/mqtt.hpp"
 #include "spsp/mqtt_adapter.hpp"
 
@@ -15,8 +18,13 @@ const std::string TOPIC = "abc";
 const std::string PAYLOAD = "123";
 const FarLayers::MQTT::Config CONF = {
     .connection = {
+        .uri = "",
+        .verifyCrt = "",
         .timeout = 100ms,
     },
+    .auth = {},
+    .lastWill = {},
+    .batch = {},
 };
 const std::string TOPIC_PUBLISH = CONF.pubTopicPrefix + "/" + SRC + "/" + TOPIC;
 
@@ -108,6 +116,122 @@ TEST_CASE("Check methods on failing adapter", "[MQTT]") {
     }
 }
 
+TEST_CASE("Batched subscribe and unsubscribe", "[MQTT]") {
+    class Adapter : public FarLayers::MQTT::Adapter
+    {
+    public:
+        std::vector<std::vector<std::string>> requests;
+        std::vector<FarLayers::MQTT::AdapterDoneCb> pending;
+
+        void subscribeManyAsync(const std::vector<std::string>& topics,
+                                FarLayers::MQTT::AdapterDoneCb cb)
+        {
+            requests.push_back(topics);
+            pending.push_back(cb);
+        }
+
+        void unsubscribeManyAsync(const std::vector<std::string>& topics,
+                                  FarLayers::MQTT::AdapterDoneCb cb)
+        {
+            requests.push_back(topics);
+            pending.push_back(cb);
+        }
+
+        // Completes oldest request
+        void complete(bool success)
+        {
+            auto cb = pending.front();
+            pending.erase(pending.begin());
+            cb(success);
+        }
+    };
+
+    auto conf = CONF;
+    conf.batch.topics = 2;
+    conf.batch.inFlight = 2;
+
+    // Completions run right away
+    InlineExecutor executor;
+    Adapter adapter{};
+    FarLayers::MQTT::MQTT mqtt{adapter, conf, &executor};
+
+    const std::vector<std::string> topics = {"a", "b", "c", "d", "e"};
+    std::optional<bool> result;
+
+    SECTION("Subscribe") {
+        mqtt.subscribeManyAsync(topics, [&result](bool success) { result = success; });
+
+        // Pipeline is full
+        CHECK(adapter.requests.size() == 2);
+        CHECK(adapter.pending.size() == 2);
+
+        adapter.complete(true);
+        CHECK(adapter.requests.size() == 3);
+        CHECK(adapter.pending.size() == 2);
+
+        adapter.complete(true);
+        adapter.complete(true);
+        CHECK(adapter.pending.empty());
+
+        REQUIRE(result.has_value());
+        CHECK(*result);
+        CHECK(adapter.requests == std::vector<std::vector<std::string>>{
+            {"a", "b"}, {"c", "d"}, {"e"}});
+    }
+
+    SECTION("Unsubscribe with failed request") {
+        mqtt.unsubscribeManyAsync(topics, [&result](bool success) { result = success; });
+
+        adapter.complete(false);
+        adapter.complete(true);
+        CHECK(!result.has_value());
+
+        // All requests are sent anyway
+        adapter.complete(true);
+        CHECK(adapter.requests.size() == 3);
+
+        REQUIRE(result.has_value());
+        CHECK(!*result);
+    }
+
+    SECTION("No topics") {
+        mqtt.subscribeManyAsync({}, [&result](bool success) { result = success; });
+
+        CHECK(adapter.requests.empty());
+        REQUIRE(result.has_value());
+        CHECK(*result);
+    }
+}
+
+TEST_CASE("Batched subscribe on adapter without batching", "[MQTT]") {
+    // Default adapter methods fall back to single-topic ones
+    class Adapter : public FarLayers::MQTT::Adapter
+    {
+    public:
+        std::vector<std::string> subscribed;
+
+        bool subscribe(const std::string& topic)
+        {
+            subscribed.push_back(topic);
+            return topic != "c";
+        }
+    };
+
+    auto conf = CONF;
+    conf.batch.topics = 2;
+
+    InlineExecutor executor;
+    Adapter adapter{};
+    FarLayers::MQTT::MQTT mqtt{adapter, conf, &executor};
+
+    std::optional<bool> result;
+    mqtt.subscribeManyAsync({"a", "b", "c", "d"}, [&result](bool success) { result = success; });
+
+    CHECK(adapter.subscribed == std::vector<std::string>{"a", "b", "c", "d"});
+    REQUIRE(result.has_value());
+    CHECK(!*result);
+}
+
 TEST_CASE("Simulate connection failure", "[MQTT]") {
     class Adapter : public FarLayers::MQTT::Adapter
     {
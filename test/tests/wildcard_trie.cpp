@@ -1,16 +1,22 @@
+#include <catch2/catch_template_test_macros.hpp>
 #include <catch2/catch_test_macros.hpp>
 
+#include <random>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "spsp/flat_wildcard_trie.hpp"
 #include "spsp/wildcard_trie.hpp"
 
 using namespace SPSP;
 
 using FindReturnT = SPSP::WildcardTrie<int>::FindReturnT;
 
-TEST_CASE("Simple insert, remove, find in wildcard trie", "[WildcardTrie]") {
-    WildcardTrie<int> trie("/", "+", "#");
+#define TRIE_TYPES WildcardTrie<int>, FlatWildcardTrie<int>
+
+TEMPLATE_TEST_CASE("Simple insert, remove, find in wildcard trie", "[WildcardTrie]", TRIE_TYPES) {
+    TestType trie("/", "+", "#");
 
     REQUIRE(trie.empty());
 
@@ -32,8 +38,8 @@ TEST_CASE("Simple insert, remove, find in wildcard trie", "[WildcardTrie]") {
     }
 }
 
-TEST_CASE("Insert and find in wildcard trie", "[WildcardTrie]") {
-    WildcardTrie<int> trie("/", "+", "#");
+TEMPLATE_TEST_CASE("Insert and find in wildcard trie", "[WildcardTrie]", TRIE_TYPES) {
+    TestType trie("/", "+", "#");
 
     REQUIRE(trie.empty());
 
@@ -100,8 +106,8 @@ TEST_CASE("Insert and find in wildcard trie", "[WildcardTrie]") {
     }
 }
 
-TEST_CASE("Insert, remove and find in wildcard trie", "[WildcardTrie]") {
-    WildcardTrie<int> trie("/", "+", "#");
+TEMPLATE_TEST_CASE("Insert, remove and find in wildcard trie", "[WildcardTrie]", TRIE_TYPES) {
+    TestType trie("/", "+", "#");
 
     REQUIRE(trie.empty());
 
@@ -204,8 +210,8 @@ TEST_CASE("Insert, remove and find in wildcard trie", "[WildcardTrie]") {
     REQUIRE(trie.empty());
 }
 
-TEST_CASE("Find in wildcard trie", "[WildcardTrie]") {
-    WildcardTrie<int> trie("/", "+", "#");
+TEMPLATE_TEST_CASE("Find in wildcard trie", "[WildcardTrie]", TRIE_TYPES) {
+    TestType trie("/", "+", "#");
 
     trie.insert("abc/#", 2);
     trie.insert("abc/def", 3);
@@ -246,8 +252,8 @@ TEST_CASE("Find in wildcard trie", "[WildcardTrie]") {
     }
 }
 
-TEST_CASE("For each and [] in wildcard trie", "[WildcardTrie]") {
-    WildcardTrie<int> trie("/", "+", "#");
+TEMPLATE_TEST_CASE("For each and [] in wildcard trie", "[WildcardTrie]", TRIE_TYPES) {
+    TestType trie("/", "+", "#");
 
     trie.insert("abc/#", 2);
     trie.insert("abc/def", 3);
@@ -280,3 +286,157 @@ TEST_CASE("For each and [] in wildcard trie", "[WildcardTrie]") {
     // Check value was modified
     REQUIRE(trie.find("if/1/else") == FindReturnT{{"if/+/else", 8}});
 }
+
+TEST_CASE("Flat wildcard trie same as wildcard trie", "[WildcardTrie]") {
+    WildcardTrie<int> ref("/", "+", "#");
+    FlatWildcardTrie<int> trie("/", "+", "#");
+
+    // Many children on some levels, so that both child storages are used
+    const std::vector<std::string> levels = {
+        "a", "b", "c", "d", "e", "f", "g", "h", "+", "#", "",
+    };
+
+    std::mt19937 gen(1234);
+    auto randomKey = [&levels, &gen]() {
+        std::string key;
+        size_t depth = 1 + gen() % 4;
+        for (size_t i = 0; i < depth; i++) {
+            if (i > 0) key += "/";
+            key += levels[gen() % levels.size()];
+        }
+        return key;
+    };
+
+    std::vector<std::string> keys;
+
+    for (int i = 0; i < 5000; i++) {
+        auto key = randomKey();
+        INFO("Iteration: " << i << ", key: '" << key << "'");
+
+        switch (gen() % 3) {
+        case 0:
+            ref.insert(key, i);
+            trie.insert(key, i);
+            keys.push_back(key);
+            break;
+        case 1:
+            if (!keys.empty()) key = keys[gen() % keys.size()];
+            REQUIRE(ref.remove(key) == trie.remove(key));
+            break;
+        default:
+            REQUIRE(ref.find(key) == trie.find(key));
+            break;
+        }
+
+        REQUIRE(ref.empty() == trie.empty());
+    }
+
+    std::unordered_map<std::string, int> refValues, values;
+    ref.forEach([&refValues](const std::string& key, const int& value) {
+        refValues[key] = value;
+    });
+    trie.forEach([&values](const std::string& key, const int& value) {
+        values[key] = value;
+    });
+    REQUIRE(values == refValues);
+
+    // Remove everything
+    for (auto& key : keys) {
+        REQUIRE(ref.remove(key) == trie.remove(key));
+    }
+    REQUIRE(trie.empty());
+}
+
+TEST_CASE("Flat wildcard trie reuses removed keys", "[WildcardTrie]") {
+    FlatWildcardTrie<int> trie("/", "+", "#");
+
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < 100; i++) {
+            trie.insert("node/" + std::to_string(i) + "/value", i);
+        }
+
+        // Unknown levels match wildcard only
+        REQUIRE(trie.find("node/unknown/value").empty());
+        trie.insert("node/+/value", -1);
+        REQUIRE(trie.find("node/unknown/value") == FindReturnT{{"node/+/value", -1}});
+        REQUIRE(trie.find("node/42/value").size() == 2);
+
+        // Value of removed key doesn't survive
+        REQUIRE(trie.remove("node/+/value"));
+        REQUIRE(trie["node/+/value"] == 0);
+        REQUIRE(trie.remove("node/+/value"));
+
+        for (int i = 0; i < 100; i++) {
+            REQUIRE(trie.remove("node/" + std::to_string(i) + "/value"));
+        }
+        REQUIRE(trie.empty());
+    }
+}
+
+TEMPLATE_TEST_CASE("Visit matches in wildcard trie", "[WildcardTrie]", TRIE_TYPES) {
+    TestType trie("/", "+", "#");
+
+    trie.insert("abc/#", 2);
+    trie.insert("abc/def", 3);
+    trie.insert("abc/+/g", 4);
+    trie.insert("/lead", 5);
+
+    using MatchT = typename TestType::Match;
+
+    SECTION("Visit all matches") {
+        std::unordered_map<std::string, int> values;
+        REQUIRE(trie.findEach("abc/def", [&values](const MatchT& match) {
+            values[match.key()] = match.value;
+        }));
+        REQUIRE(values == std::unordered_map<std::string, int>{
+            {"abc/#", 2},
+            {"abc/def", 3},
+        });
+    }
+
+    SECTION("Stop visiting") {
+        size_t visited = 0;
+        REQUIRE(!trie.findEach("abc/def/g", [&visited](const MatchT&) {
+            visited++;
+            return false;
+        }));
+        REQUIRE(visited == 1);
+    }
+
+    SECTION("Leading separator is kept in key") {
+        REQUIRE(trie.find("/lead") == FindReturnT{{"/lead", 5}});
+    }
+
+    SECTION("Any and count") {
+        REQUIRE(trie.matchesAny("abc/xyz"));
+        REQUIRE(!trie.matchesAny("xyz/abc"));
+        REQUIRE(!trie.matchesAny(""));
+
+        REQUIRE(trie.countMatches("abc/def") == 2);
+        REQUIRE(trie.countMatches("abc/def/g") == 2);
+        REQUIRE(trie.countMatches("abc") == 0);
+    }
+
+    SECTION("Wildcard characters inside level") {
+        trie.insert("abc/d+f", 8);
+        trie.insert("abc/d#f/+", 9);
+
+        REQUIRE(trie.find("abc/d+f") == FindReturnT{{"abc/#", 2}, {"abc/d+f", 8}});
+        REQUIRE(trie.find("abc/dxf").size() == 1);
+        REQUIRE(trie.countMatches("abc/d#f/x") == 2);
+        REQUIRE(trie.remove("abc/d+f"));
+        REQUIRE(!trie.remove("abc/d+f"));
+        REQUIRE(trie.remove("abc/d#f/+"));
+    }
+
+    SECTION("Deep keys") {
+        std::string key = "deep";
+        for (int i = 0; i < 40; i++) key += "/" + std::to_string(i);
+
+        trie.insert(key, 6);
+        trie.insert("deep/#", 7);
+
+        REQUIRE(trie.countMatches(key) == 2);
+        REQUIRE(trie.find(key).at(key) == 6);
+    }
+}
@@ -0,0 +1,159 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "spsp/worker_pool.hpp"
+
+using namespace SPSP;
+using namespace std::chrono_literals;
+
+/**
+ * @brief Helper blocking the only worker on the first item
+ *
+ * First item signals `started` and waits for `release`.
+ */
+struct BlockingHandler
+{
+    std::mutex mutex;
+    std::vector<int> processed;
+    std::promise<void> started;
+    std::shared_future<void> release;
+
+    BlockingHandler(std::shared_future<void> rel) : release{rel} {}
+
+    void operator()(int& item)
+    {
+        if (item == 0) {
+            started.set_value();
+            release.wait();
+        }
+
+        const std::scoped_lock lock(mutex);
+        processed.push_back(item);
+    }
+};
+
+TEST_CASE("Process all items", "[WorkerPool]") {
+    std::atomic<int> sum = 0;
+    std::atomic<int> count = 0;
+
+    {
+        WorkerPool<int> pool{4, 16, OverflowPolicy::BLOCK, [&](int& item) {
+            sum += item;
+            count++;
+        }};
+
+        for (int i = 1; i <= 100; i++) {
+            REQUIRE(pool.push(int{i}));
+        }
+
+        while (count < 100) {
+            std::this_thread::sleep_for(1ms);
+        }
+
+        auto stats = pool.getStats();
+        CHECK(stats.queueDepth == 0);
+        CHECK(stats.processed == 100);
+        CHECK(stats.droppedOldest == 0);
+        CHECK(stats.droppedNewest == 0);
+    }
+
+    CHECK(sum == 5050);
+}
+
+TEST_CASE("Overflow policies", "[WorkerPool]") {
+    std::promise<void> releasePromise;
+    BlockingHandler handler{releasePromise.get_future().share()};
+
+    SECTION("Drop oldest") {
+        WorkerPool<int> pool{1, 2, OverflowPolicy::DROP_OLDEST,
+                             [&handler](int& item) { handler(item); }};
+
+        REQUIRE(pool.push(0));
+        handler.started.get_future().wait();
+
+        CHECK(pool.push(1));
+        CHECK(pool.push(2));
+        CHECK(pool.push(3));
+        CHECK(pool.getStats().queueDepth == 2);
+        CHECK(pool.getStats().droppedOldest == 1);
+
+        releasePromise.set_value();
+        std::this_thread::sleep_for(10ms);
+
+        CHECK(handler.processed == std::vector<int>{0, 2, 3});
+    }
+
+    SECTION("Drop newest") {
+        WorkerPool<int> pool{1, 2, OverflowPolicy::DROP_NEWEST,
+                             [&handler](int& item) { handler(item); }};
+
+        REQUIRE(pool.push(0));
+        handler.started.get_future().wait();
+
+        CHECK(pool.push(1));
+        CHECK(pool.push(2));
+        CHECK(!pool.push(3));
+        CHECK(pool.getStats().queueDepth == 2);
+        CHECK(pool.getStats().droppedNewest == 1);
+
+        releasePromise.set_value();
+        std::this_thread::sleep_for(10ms);
+
+        CHECK(handler.processed == std::vector<int>{0, 1, 2});
+    }
+
+    SECTION("Block") {
+        WorkerPool<int> pool{1, 2, OverflowPolicy::BLOCK,
+                             [&handler](int& item) { handler(item); }};
+
+        REQUIRE(pool.push(0));
+        handler.started.get_future().wait();
+
+        CHECK(pool.push(1));
+        CHECK(pool.push(2));
+
+        std::atomic<bool> pushed = false;
+        std::thread t([&pool, &pushed] {
+            CHECK(pool.push(3));
+            pushed = true;
+        });
+
+        std::this_thread::sleep_for(10ms);
+        CHECK(!pushed);
+
+        releasePromise.set_value();
+        t.join();
+        std::this_thread::sleep_for(10ms);
+
+        CHECK(pushed);
+        CHECK(handler.processed == std::vector<int>{0, 1, 2, 3});
+        CHECK(pool.getStats().queueDepthMax == 2);
+    }
+
+    SECTION("Block with timeout") {
+        WorkerPool<int> pool{1, 1, OverflowPolicy::BLOCK,
+                             [&handler](int& item) { handler(item); }};
+
+        REQUIRE(pool.push(0));
+        handler.started.get_future().wait();
+
+        CHECK(pool.push(1));
+
+        int item = 2;
+        CHECK(!pool.pushFor(std::move(item), 5ms));
+        CHECK(pool.getStats().queueDepth == 1);
+
+        releasePromise.set_value();
+        CHECK(pool.pushFor(std::move(item), 1s));
+        std::this_thread::sleep_for(10ms);
+
+        CHECK(handler.processed == std::vector<int>{0, 1, 2});
+        CHECK(pool.getStats().droppedNewest == 0);
+    }
+}